@@ -205,6 +205,26 @@ typedef enum
 	EVENT_BUSY_TENTATIVE_FB,
 } cal_event_availability_type_t;
 
+/**
+ * Busy time of calendar_svc_get_freebusy().
+ * type is EVENT_BUSY_FB, EVENT_BUSY_UNAVAILABLE_FB or EVENT_BUSY_TENTATIVE_FB.
+ */
+struct cals_freebusy {
+	long long int start;
+	long long int end;
+	int type;
+};
+
+/**
+ * Stored instance overlapping the candidate of calendar_svc_event_find_conflicts().
+ * start and end are utime for normal events and YYYYMMDD for all-day events.
+ */
+struct cals_conflict {
+	int event_id;
+	long long int start;
+	long long int end;
+};
+
 
 /**
  * This enumeration defines event attendee's role .
@@ -733,6 +753,42 @@ int calendar_svc_begin_trans(void);
  */
 int calendar_svc_end_trans(bool is_success);
 
+/**
+ * @fn int calendar_svc_set_lock_wait(int min_usec, int max_usec, int deadline_msec);
+ * This function sets how long the calendar service waits for the database lock
+ * held by another process. The wait sleeps min_usec first, doubles up to max_usec,
+ * and fails with CAL_ERR_DB_LOCK after deadline_msec in total.
+ *
+ * @ingroup service_management
+ * @param[in] min_usec first sleep in microseconds (default 50)
+ * @param[in] max_usec longest sleep in microseconds (default 20000)
+ * @param[in] deadline_msec total wait in milliseconds, 0 fails at once (default 1000)
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception CAL_ERR_ARG_INVALID
+ * @remarks The policy is shared by all connections of the process.
+ * @pre none
+ * @post none
+ * @see calendar_svc_get_lock_stats().
+ */
+int calendar_svc_set_lock_wait(int min_usec, int max_usec, int deadline_msec);
+
+/**
+ * @fn int calendar_svc_get_lock_stats(int *waits, int *timeouts);
+ * This function gets how many times the process waited for the database lock,
+ * and how many of the waits ran out of the deadline.
+ *
+ * @ingroup service_management
+ * @param[out] waits the number of lock waits
+ * @param[out] timeouts the number of lock waits which failed
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception CAL_ERR_ARG_NULL
+ * @remarks None.
+ * @pre none
+ * @post none
+ * @see calendar_svc_set_lock_wait().
+ */
+int calendar_svc_get_lock_stats(int *waits, int *timeouts);
+
 
 /**
  * @fn int calendar_svc_subscribe_db_change (const char *data_type,void(*cb)(void *), void *user_data);
@@ -874,6 +930,23 @@ int calendar_svc_unsubscribe_change (void(*cb)(void *));
  */
 int calendar_svc_insert(cal_struct *record);
 
+/**
+ * @fn int calendar_svc_insert_batch(GList *structs, int *ids_out);
+ * This function inserts many events or todos at once.
+ * All records are inserted in one transaction, and db change is notified once.
+ *
+ * @ingroup event_management
+ * @param[in] structs list of cal_struct, CAL_STRUCT_SCHEDULE or CAL_STRUCT_TODO
+ * @param[out] ids_out array of g_list_length(structs), gets the index of each record
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception CAL_ERR_ARG_NULL, CAL_ERR_ARG_INVALID
+ * @remarks If it fails, none of the records are inserted.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_insert().
+ */
+int calendar_svc_insert_batch(GList *structs, int *ids_out);
+
 
 
 /**
@@ -918,6 +991,22 @@ int calendar_svc_insert(cal_struct *record);
  */
 int calendar_svc_update(cal_struct *record);
 
+/**
+ * @fn int calendar_svc_update_batch(GList *structs);
+ * This function updates many events or todos at once.
+ * All records are updated in one transaction, and db change is notified once.
+ *
+ * @ingroup event_management
+ * @param[in] structs list of cal_struct, CAL_STRUCT_SCHEDULE or CAL_STRUCT_TODO
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception CAL_ERR_ARG_NULL, CAL_ERR_ARG_INVALID
+ * @remarks If it fails, none of the records are updated.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_update().
+ */
+int calendar_svc_update_batch(GList *structs);
+
 /**
  * @fn int calendar_svc_delete(const char *data_type,int index);
  * This function delete records from database,it is convenient for user to delete some record.
@@ -954,6 +1043,24 @@ int calendar_svc_update(cal_struct *record);
  */
 int calendar_svc_delete(const char *data_type,int index);
 
+/**
+ * @fn int calendar_svc_delete_batch(const char *data_type, int *ids, int n);
+ * This function deletes many events or todos at once.
+ * All records are deleted in one transaction, and db change is notified once.
+ *
+ * @ingroup event_management
+ * @param[in] data_type CAL_STRUCT_SCHEDULE or CAL_STRUCT_TODO
+ * @param[in] ids array of event db index
+ * @param[in] n the number of ids
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception CAL_ERR_ARG_NULL, CAL_ERR_ARG_INVALID, CAL_ERR_NO_DATA
+ * @remarks If one of ids does not exist or is not of data_type, none of the records are deleted.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_delete().
+ */
+int calendar_svc_delete_batch(const char *data_type, int *ids, int n);
+
 /**
  * @fn int calendar_svc_delete_all(int account_id,const char *data_type);
  * This function delete all records from database,it is convenient for user to delete all of records.
@@ -1165,6 +1272,29 @@ int calendar_svc_todo_get_count(int calendar_id);
  */
 int calendar_svc_get_all(int account_id,int calendar_id,const char *data_type, cal_iter **iter);
 
+/**
+ * @fn int calendar_svc_get_all_page(int account_id, int calendar_id, const char *data_type, const char *token, int limit, cal_iter **iter);
+ * This function gets a page of the records of calendar_svc_get_all() in the order of the index.
+ * The page starts after the row of the token, which is sought by the index,
+ * so the cost of a page does not grow with the number of pages before it.
+ *
+ * @ingroup event_management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] account_id account db index
+ * @param[in] calendar_id calendar id. will be avaiable for mutiple calendar.
+ * @param[in] data_type #CAL_STRUCT_SCHEDULE or #CAL_STRUCT_TODO
+ * @param[in] token token of calendar_svc_iter_get_page_token(), or NULL for the first page
+ * @param[in] limit the max number of records of the page
+ * @param[out] iter interation struct for list travel
+ * @exception None.
+ * @remarks The token of the next page is got by calendar_svc_iter_get_page_token() after the page is traveled.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_iter_get_page_token
+ */
+int calendar_svc_get_all_page(int account_id, int calendar_id, const char *data_type,
+		const char *token, int limit, cal_iter **iter);
+
 /**
  * @fn int calendar_svc_event_get_changes(int calendar_id, int version, cal_iter **iter);
  * This function provides the iterator to get all changes later than the version.
@@ -1298,6 +1428,65 @@ int calendar_svc_convert_id_to_uid(const char *data_type,int index,char **uid);
  */
 int calendar_svc_iter_get_info(cal_iter *iter, cal_struct **row_record);
 
+/**
+ * @fn int calendar_svc_iter_set_row_reuse(cal_iter *iter, bool reuse);
+ * This function sets the iterator of schedules or todos to reuse the row record.
+ * calendar_svc_iter_get_info() always empties a row record given again and copies
+ * the row into it, so this is kept for compatibility and changes nothing else.
+ * The memory of the strings is kept for the next row,
+ * so scanning many rows with one row record allocates near-constant memory.
+ *
+ * @ingroup event_management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] iter interation struct for list travel
+ * @param[in] reuse true to reuse the row record
+ * @exception None.
+ * @remarks Values got from the row record are valid until the next calendar_svc_iter_get_info().
+ * @pre database connected
+ * @post none
+ * @code
+   #include <calendar-svc-provider.h>
+   void sample_code()
+   {
+   	  cal_iter *iter = NULL;
+   	  cal_struct *event = NULL;
+
+   	  calendar_svc_connect();
+   	  calendar_svc_get_all(0, 0, CAL_STRUCT_SCHEDULE, &iter);
+   	  calendar_svc_iter_set_row_reuse(iter, true);
+
+   	  while (calendar_svc_iter_next(iter) == CAL_SUCCESS) {
+   	     if (calendar_svc_iter_get_info(iter, &event) != CAL_SUCCESS)
+   	        break;
+   	     printf("%s\n", calendar_svc_struct_get_str(event, CAL_VALUE_TXT_SUMMARY));
+   	  }
+
+   	  calendar_svc_struct_free(&event);
+   	  calendar_svc_iter_remove(&iter);
+   	  calendar_svc_close();
+   }
+ * @endcode
+ * @see calendar_svc_iter_get_info()
+ */
+int calendar_svc_iter_set_row_reuse(cal_iter *iter, bool reuse);
+
+/**
+ * @fn int calendar_svc_iter_get_page_token(cal_iter *iter, char **token);
+ * This function gets the token of the next page of a paged list.
+ * The token is of the last row traveled, so it should be got after the page is traveled.
+ *
+ * @ingroup event_management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] iter interation struct of calendar_svc_get_all_page() or calendar_svc_event_get_normal_list_by_period_page()
+ * @param[out] token token of the next page, should be freed by free(). NULL if the page was the last.
+ * @exception None.
+ * @remarks The token stays valid when records are changed between the pages.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_get_all_page
+ */
+int calendar_svc_iter_get_page_token(cal_iter *iter, char **token);
+
 
 /**
  * @fn int calendar_svc_iter_next(cal_iter *iter);
@@ -2116,7 +2305,9 @@ int calendar_svc_find_event_list(int account_id,const char *search_type,const vo
  * @param[out] iter interation struct for list travel
  * @return This function returns CAL_SUCCESS or error code on failure.
  * @exception None.
- * @remarks None.
+ * @remarks A keyword of ASCII characters is searched by the words of the full text index,
+ * and the last word of it may be a prefix. A keyword having other characters (e.g. CJK, Hangul)
+ * is searched as a substring of the fields, unranked and without the index.
  * @pre database connected
  * @post none
  * @code
@@ -2183,13 +2374,32 @@ int calendar_svc_event_search(int field, const char *keyword, cal_iter **iter);
  * @param[out] iter interation struct for list travel
  * @return This function returns CAL_SUCCESS or error code on failure.
  * @exception None.
- * @remarks None.
+ * @remarks The summary is searched like calendar_svc_event_search().
  * @pre database connected
  * @post none
  * @see detail_management module
  */
 int calendar_svc_smartsearch_excl(const char *keyword, int offset, int limit, cal_iter **iter);
 
+/**
+ * @fn int calendar_svc_search_get_snippet(int index, const char *keyword, char **snippet)
+ * Get the text around the keyword in a searched event, the keyword is wrapped by <b> and </b>.
+ *
+ * @ingroup event_management
+ * @return CAL_SUCCESS or negative error code on failure.
+ * @param[in] index index of the event found by calendar_svc_event_search() or calendar_svc_smartsearch_excl()
+ * @param[in] keyword keyword used for the search
+ * @param[out] snippet text of at most 10 words, or of the bytes around a keyword
+ * having non ASCII characters, should be freed by free()
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception None.
+ * @remarks CAL_ERR_NO_DATA is returned if the event does not have the keyword.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_event_search
+ */
+int calendar_svc_search_get_snippet(int index, const char *keyword, char **snippet);
+
 /**
  * @fn int calendar_svc_todo_search(int field, const char *keyword, cal_iter **iter);
  * #calendar_svc_event_search searches TO-DOs including the keyword in given fields.
@@ -2377,6 +2587,47 @@ int calendar_svc_read_schedules(const char *stream, GList **schedules);
  */
 int calendar_svc_calendar_import(const char *path, int calendar_id);
 
+/**
+ * Called after each chunk of the import is committed.
+ * @param[in] imported the number of schedules imported so far
+ * @param[in] user_data user data passed to calendar_svc_calendar_import_with_progress()
+ */
+typedef void (*calendar_svc_import_cb)(int imported, void *user_data);
+
+/**
+ * @fn int calendar_svc_calendar_import_with_progress(const char *path, int calendar_id, int chunk, calendar_svc_import_cb cb, void *user_data);
+ * This function imports vcalendar(ver 1.0), icalendar(ver 2.0) to calendar DB,
+ * committing every chunk schedules in one transaction.
+ *
+ * @ingroup event management
+ * @param[in] path file path
+ * @param[in] calendar_id calendar id
+ * @param[in] chunk the number of schedules in a transaction, 0 for the default(100)
+ * @param[in] cb called after each chunk is committed, can be NULL
+ * @param[in] user_data passed to cb
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @remarks If it fails, the chunks already committed are kept.
+ * @pre none
+ * @post none
+ * @see calendar_svc_calendar_import().
+ */
+int calendar_svc_calendar_import_with_progress(const char *path, int calendar_id,
+		int chunk, calendar_svc_import_cb cb, void *user_data);
+
+/**
+ * @fn int calendar_svc_set_import_workers(int workers);
+ * This function sets the number of threads parsing the file of the import.
+ * Schedules are still inserted in the order of the file by the calling thread.
+ *
+ * @ingroup event management
+ * @param[in] workers the number of threads, 1 by default, 0 for the number of online cpus
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @exception CAL_ERR_ARG_INVALID
+ * @remarks It is applied to the import of the process.
+ * @see calendar_svc_calendar_import_with_progress().
+ */
+int calendar_svc_set_import_workers(int workers);
+
 /**
  * @fn int calendar_svc_write_schedules(GList *schedules, char **stream);
  * This function writes schedules to stream.
@@ -2429,6 +2680,26 @@ int calendar_svc_calendar_import(const char *path, int calendar_id);
  */
 int calendar_svc_write_schedules(GList *schedules, char **stream);
 
+/**
+ * @fn int calendar_svc_write_freebusy(const struct cals_freebusy *freebusy, int count, long long int stime, long long int etime, char **stream);
+ * This function writes the busy time of calendar_svc_get_freebusy() to a VFREEBUSY of the vcalendar stream.
+ *
+ * @ingroup event management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] freebusy busy time intervals
+ * @param[in] count the number of freebusy
+ * @param[in] stime start of the period in utime
+ * @param[in] etime end of the period in utime
+ * @param[out] stream vcalendar stream, should be freed by free()
+ * @exception None.
+ * @remarks None.
+ * @pre none
+ * @post none
+ * @see calendar_svc_get_freebusy
+ */
+int calendar_svc_write_freebusy(const struct cals_freebusy *freebusy, int count,
+		long long int stime, long long int etime, char **stream);
+
 /**
  * @fn int calendar_svc_calendar_export(int calendar_id, const char *path);
  * This function export calendar DB to file.
@@ -2668,14 +2939,199 @@ enum cals_range {
 int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_code,
 		long long int start, long long int end, cal_iter **iter);
 
+/*
+ * A page of calendar_svc_event_get_normal_list_by_period() in the order of dtstart_utime and event id,
+ * the token is got by calendar_svc_iter_get_page_token() or NULL for the first page.
+ * CALS_LIST_PERIOD_NORMAL_ALARM is not paged.
+ */
+int calendar_svc_event_get_normal_list_by_period_page(int calendar_id, int op_code,
+		long long int start, long long int end, const char *token, int limit, cal_iter **iter);
+
 int calendar_svc_event_get_allday_list_by_period(int calendar_id, int op_code,
 		int dtstart_year, int dtstart_mon, int dtstart_day,
 		int dtend_year, int dtend_mon, int dtend_day, cal_iter **iter);
 
+/**
+ * @fn int calendar_svc_get_freebusy(const int *calendar_ids, int calendar_cnt, long long int stime, long long int etime, int granularity, struct cals_freebusy **freebusy, int *count);
+ * This function gets the busy time of events between stime and etime.
+ * Normal and all-day instances are merged into intervals which do not overlap, in the order of the start.
+ * Events of which busy status is 0 or availability is EVENT_FREE_FB are not counted,
+ * and a merged interval has the strongest type of the events in it.
+ *
+ * @ingroup event_management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] calendar_ids ids of the calendars, NULL for all visible calendars
+ * @param[in] calendar_cnt the number of calendar_ids
+ * @param[in] stime start of the period in utime
+ * @param[in] etime end of the period in utime
+ * @param[in] granularity seconds of a slot from stime, busy time is rounded out to slots. 0 is not rounded.
+ * @param[out] freebusy busy time intervals, should be freed by free()
+ * @param[out] count the number of freebusy
+ * @exception None.
+ * @remarks All-day instances are busy for the days in the timezone of the event.
+ * @pre database connected
+ * @post none
+ * @see calendar_svc_write_freebusy
+ */
+int calendar_svc_get_freebusy(const int *calendar_ids, int calendar_cnt,
+		long long int stime, long long int etime, int granularity,
+		struct cals_freebusy **freebusy, int *count);
+
+/**
+ * @fn int calendar_svc_event_find_conflicts(cal_struct *candidate, long long int stime, long long int etime, struct cals_conflict **conflicts, int *count);
+ * This function finds the stored instances overlapping the instances of the candidate event between stime and etime.
+ * The instances of the candidate are expanded from its rrule in memory, nothing is written.
+ * Normal events are compared with normal instances, and all-day events with all-day instances.
+ *
+ * @ingroup event_management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] candidate event to be inserted or updated
+ * @param[in] stime start of the period in utime
+ * @param[in] etime end of the period in utime
+ * @param[out] conflicts overlapping instances in the order of the start, should be freed by free()
+ * @param[out] count the number of conflicts
+ * @exception None.
+ * @remarks Instances of the candidate itself and the events of which busy status is 0 are not counted.
+ * @pre database connected
+ * @post none
+ */
+int calendar_svc_event_find_conflicts(cal_struct *candidate,
+		long long int stime, long long int etime,
+		struct cals_conflict **conflicts, int *count);
+
+/**
+ * @fn int calendar_svc_event_get_day_counts(int calendar_id, int year, int month, const char *tzid, int counts[31]);
+ * This function counts the event instances on each day of the month, for month views.
+ * An instance spanning several days is counted on each of them.
+ *
+ * @ingroup event_management
+ * @return This function returns CAL_SUCCESS or error code on failure.
+ * @param[in] calendar_id calendar id, 0 or less for all visible calendars
+ * @param[in] year year of the month
+ * @param[in] month month, 1 ~ 12
+ * @param[in] tzid timezone of the days of normal instances, NULL for the system timezone
+ * @param[out] counts counts[mday - 1] is the number of instances on mday, days after the month are 0
+ * @exception None.
+ * @remarks All-day instances are counted on their dates.
+ * @pre database connected
+ * @post none
+ */
+int calendar_svc_event_get_day_counts(int calendar_id, int year, int month,
+		const char *tzid, int counts[31]);
+
 int calendar_svc_struct_set_lli(cal_struct *record, const char *field, long long int llival);
 
 long long int calendar_svc_struct_get_lli(cal_struct *record, const char *field);
 
+/**
+ * Field ids of the schedule and todo struct.
+ * Each id is the field of the CAL_VALUE_* or CALS_VALUE_* name with the same suffix.
+ * Accessors by id do not compare the field name,
+ * so the id can be got once by calendar_svc_struct_get_field_id() and reused.
+ */
+enum cals_field {
+	CALS_FIELD_INT_INDEX = 0,
+	CALS_FIELD_INT_ACCOUNT_ID,
+	CALS_FIELD_INT_TYPE,
+	CALS_FIELD_INT_FILE_ID,
+	CALS_FIELD_INT_CONTACT_ID,
+	CALS_FIELD_INT_BUSY_STATUS,
+	CALS_FIELD_INT_SENSITIVITY,
+	CALS_FIELD_INT_CALENDAR_TYPE,
+	CALS_FIELD_INT_MEETING_STATUS,
+	CALS_FIELD_INT_LOCATION_TYPE,
+	CALS_FIELD_INT_CALENDAR_ID,
+	CALS_FIELD_INT_DST,
+	CALS_FIELD_INT_ORIGINAL_EVENT_ID,
+	CALS_FIELD_INT_SYNC_STATUS,
+	CALS_FIELD_INT_PRIORITY,
+	CALS_FIELD_INT_TASK_STATUS,
+	CALS_FIELD_INT_TIMEZONE,
+	CALS_FIELD_INT_EMAIL_ID,
+	CALS_FIELD_INT_AVAILABILITY,
+	CALS_FIELD_INT_PROGRESS,
+	CALS_FIELD_INT_DTSTART_TYPE,
+	CALS_FIELD_INT_DTSTART_YEAR,
+	CALS_FIELD_INT_DTSTART_MONTH,
+	CALS_FIELD_INT_DTSTART_MDAY,
+	CALS_FIELD_INT_DTEND_TYPE,
+	CALS_FIELD_INT_DTEND_YEAR,
+	CALS_FIELD_INT_DTEND_MONTH,
+	CALS_FIELD_INT_DTEND_MDAY,
+	CALS_FIELD_INT_RRULE_FREQ,
+	CALS_FIELD_INT_RRULE_ID,
+	CALS_FIELD_INT_RRULE_RANGE_TYPE,
+	CALS_FIELD_INT_RRULE_UNTIL_TYPE,
+	CALS_FIELD_INT_RRULE_UNTIL_YEAR,
+	CALS_FIELD_INT_RRULE_UNTIL_MONTH,
+	CALS_FIELD_INT_RRULE_UNTIL_MDAY,
+	CALS_FIELD_INT_RRULE_COUNT,
+	CALS_FIELD_INT_RRULE_INTERVAL,
+	CALS_FIELD_INT_RRULE_WKST,
+	CALS_FIELD_TXT_SUMMARY,
+	CALS_FIELD_TXT_DESCRIPTION,
+	CALS_FIELD_TXT_LOCATION,
+	CALS_FIELD_TXT_CATEGORIES,
+	CALS_FIELD_TXT_EXDATE,
+	CALS_FIELD_TXT_UID,
+	CALS_FIELD_TXT_ORGANIZER_NAME,
+	CALS_FIELD_TXT_ORGANIZER_EMAIL,
+	CALS_FIELD_TXT_GCAL_ID,
+	CALS_FIELD_TXT_UPDATED,
+	CALS_FIELD_TXT_LOCATION_SUMMARY,
+	CALS_FIELD_TXT_ETAG,
+	CALS_FIELD_TXT_EDIT_URL,
+	CALS_FIELD_TXT_GEDERID,
+	CALS_FIELD_TXT_DTSTART_TZID,
+	CALS_FIELD_TXT_DTEND_TZID,
+	CALS_FIELD_TXT_RRULE_BYSECOND,
+	CALS_FIELD_TXT_RRULE_BYMINUTE,
+	CALS_FIELD_TXT_RRULE_BYHOUR,
+	CALS_FIELD_TXT_RRULE_BYDAY,
+	CALS_FIELD_TXT_RRULE_BYMONTHDAY,
+	CALS_FIELD_TXT_RRULE_BYYEARDAY,
+	CALS_FIELD_TXT_RRULE_BYWEEKNO,
+	CALS_FIELD_TXT_RRULE_BYMONTH,
+	CALS_FIELD_TXT_RRULE_BYSETPOS,
+	CALS_FIELD_LLI_DTSTART_UTIME,
+	CALS_FIELD_LLI_DTEND_UTIME,
+	CALS_FIELD_LLI_LASTMOD,
+	CALS_FIELD_LLI_RRULE_UNTIL_UTIME,
+	CALS_FIELD_LLI_CREATED_TIME,
+	CALS_FIELD_LLI_COMPLETED_TIME,
+	CALS_FIELD_MAX,
+};
+
+/**
+ * @fn int calendar_svc_struct_get_field_id(const char *field);
+ * This function gets the field id of the field name.
+ *
+ * @ingroup common
+ * @return The field id(#cals_field) on success, Negative value(#cal_error) on error
+ * @param[in] field The field name(CAL_VALUE_* or CALS_VALUE_*) of the schedule or todo struct
+ * @exception None.
+ * @see calendar_svc_struct_get_int_by_id().
+ */
+int calendar_svc_struct_get_field_id(const char *field);
+
+/**
+ * @fn int calendar_svc_struct_get_int_by_id(cal_struct *record, int id);
+ * This function gets the integer value of the schedule or todo struct by the field id.
+ *
+ * @ingroup common
+ * @return The integer value on success, 0 on error
+ * @param[in] record The schedule or todo struct
+ * @param[in] id The field id(CALS_FIELD_INT_*)
+ * @exception None.
+ * @see calendar_svc_struct_get_field_id(), calendar_svc_struct_get_int().
+ */
+int calendar_svc_struct_get_int_by_id(cal_struct *record, int id);
+int calendar_svc_struct_set_int_by_id(cal_struct *record, int id, int intval);
+char *calendar_svc_struct_get_str_by_id(cal_struct *record, int id);
+int calendar_svc_struct_set_str_by_id(cal_struct *record, int id, const char *strval);
+long long int calendar_svc_struct_get_lli_by_id(cal_struct *record, int id);
+int calendar_svc_struct_set_lli_by_id(cal_struct *record, int id, long long int llival);
+
 int calendar_svc_todo_get_list_by_period(int calendar_id,
 		long long int due_from, long long int dueto, int priority, int status, cal_iter **iter);
 int calendar_svc_todo_get_count_by_period(int calendar_id,
@@ -19,8 +19,22 @@
 #ifndef __CALENDAR_SVC_DB_INFO_H__
 #define __CALENDAR_SVC_DB_INFO_H__
 
+/* test builds point the library at a scratch DB, each path may be given */
+#ifndef CALS_DB_PATH
 #define CALS_DB_PATH "/opt/dbspace/.calendar-svc.db"
+#endif
+#ifndef CALS_DB_JOURNAL_PATH
 #define CALS_DB_JOURNAL_PATH "/opt/dbspace/.calendar-svc.db-journal"
+#endif
+#ifndef CALS_DB_WAL_PATH
+#define CALS_DB_WAL_PATH "/opt/dbspace/.calendar-svc.db-wal"
+#endif
+#ifndef CALS_DB_SHM_PATH
+#define CALS_DB_SHM_PATH "/opt/dbspace/.calendar-svc.db-shm"
+#endif
+
+/* PRAGMA user_version of schema.sql, upgraded by initdb */
+#define CALS_DB_VERSION 3
 
 // For Security
 #define CALS_SECURITY_FILE_GROUP 6003
@@ -37,6 +51,11 @@
 #define CALS_TABLE_RRULE "rrule_table"
 #define CALS_TABLE_NORMAL_INSTANCE "normal_instance_table"
 #define CALS_TABLE_ALLDAY_INSTANCE "allday_instance_table"
+#define CALS_TABLE_INSTANCE_RANGE "instance_range_table"
+#define CALS_TABLE_SEARCH "schedule_search"
+
+/* temporary table of the connection, ids of batch operations */
+#define CALS_TABLE_TMP_IDS "temp.tmp_id_table"
 
 #endif /* __CALENDAR_SVC_DB_INFO_H__ */
 
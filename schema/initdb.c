@@ -20,18 +20,35 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <string.h>
+#include <limits.h>
 #include <sqlite3.h>
 #include <db-util.h>
 
 #include "schema.h"
 #include "cals-db-info.h"
+#include "cals-sqlite.h"
 #include "cals-internal.h"
 #include "calendar-svc-errors.h"
 
 
+/* creates the file if missing, with the group and permission of the DB */
+static inline int set_db_file_permission(const char *path)
+{
+	int fd;
+
+	fd = open(path, O_CREAT | O_RDWR, 0660);
+	retvm_if(-1 == fd, CAL_ERR_FAIL, "open(%s) Failed", path);
+
+	fchown(fd, getuid(), CALS_SECURITY_FILE_GROUP);
+	fchmod(fd, CALS_SECURITY_DEFAULT_PERMISSION);
+	close(fd);
+
+	return CAL_SUCCESS;
+}
+
 static inline int remake_db_file()
 {
-	int ret, fd;
+	int ret;
 	char *errmsg;
 	sqlite3 *db;
 
@@ -46,21 +63,10 @@ static inline int remake_db_file()
 
 	db_util_close(db);
 
-	fd = open(CALS_DB_PATH, O_CREAT | O_RDWR, 0660);
-	retvm_if(-1 == fd, CAL_ERR_FAIL, "open Failed");
-
-	fchown(fd, getuid(), CALS_SECURITY_FILE_GROUP);
-	fchmod(fd, CALS_SECURITY_DEFAULT_PERMISSION);
-	close(fd);
-
-	fd = open(CALS_DB_JOURNAL_PATH, O_CREAT | O_RDWR, 0660);
-	retvm_if(-1 == fd, CAL_ERR_FAIL, "open Failed");
-
-	fchown(fd, getuid(), CALS_SECURITY_FILE_GROUP);
-	fchmod(fd, CALS_SECURITY_DEFAULT_PERMISSION);
-	close(fd);
+	ret = set_db_file_permission(CALS_DB_PATH);
+	retv_if(CAL_SUCCESS != ret, ret);
 
-	return CAL_SUCCESS;
+	return set_db_file_permission(CALS_DB_JOURNAL_PATH);
 }
 
 static inline int check_db_file(void)
@@ -73,10 +79,230 @@ static inline int check_db_file(void)
 	return CAL_SUCCESS;
 }
 
+static int get_db_version(sqlite3 *db)
+{
+	int ret, version;
+	sqlite3_stmt *stmt;
+
+	ret = sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, NULL);
+	retvm_if(SQLITE_OK != ret, -1, "sqlite3_prepare_v2() Failed(%s)", sqlite3_errmsg(db));
+
+	version = 0;
+	if (SQLITE_ROW == sqlite3_step(stmt))
+		version = sqlite3_column_int(stmt, 0);
+	sqlite3_finalize(stmt);
+
+	return version;
+}
+
+static int upgrade_to_v1(sqlite3 *db)
+{
+	int ret;
+	char *errmsg;
+	char *query;
+
+	/* instances of existing events were expanded at once, so mark them as covered */
+	query = sqlite3_mprintf(
+			"CREATE TABLE IF NOT EXISTS "CALS_TABLE_INSTANCE_RANGE" "
+			"(event_id INTEGER PRIMARY KEY, range_start INTEGER, range_end INTEGER, inst_cnt INTEGER);"
+			"DROP TRIGGER IF EXISTS trg_sch_del;"
+			"CREATE TRIGGER trg_sch_del AFTER DELETE ON "CALS_TABLE_SCHEDULE" "
+			"BEGIN "
+			"DELETE FROM "CALS_TABLE_ALARM" WHERE event_id = old.id;"
+			"DELETE FROM "CALS_TABLE_INSTANCE_RANGE" WHERE event_id = old.id;"
+			"DELETE FROM "CALS_TABLE_NORMAL_INSTANCE" WHERE event_id = "
+			"(SELECT rowid FROM "CALS_TABLE_SCHEDULE" WHERE original_event_id = old.id);"
+			"DELETE FROM "CALS_TABLE_ALLDAY_INSTANCE" WHERE event_id = "
+			"(SELECT rowid FROM "CALS_TABLE_SCHEDULE" WHERE original_event_id = old.id);"
+			"DELETE FROM "CALS_TABLE_SCHEDULE" WHERE original_event_id = old.id;"
+			"END;"
+			"INSERT OR REPLACE INTO "CALS_TABLE_INSTANCE_RANGE" "
+			"SELECT id, %lld, %lld, 0 FROM "CALS_TABLE_SCHEDULE" WHERE rrule_id > 0;"
+			"PRAGMA user_version = 1;",
+			LLONG_MIN, LLONG_MAX);
+	retvm_if(NULL == query, CAL_ERR_OUT_OF_MEMORY, "sqlite3_mprintf() Failed");
+
+	ret = sqlite3_exec(db, query, NULL, 0, &errmsg);
+	sqlite3_free(query);
+	if (SQLITE_OK != ret) {
+		ERR("upgrade to version 1 is Failed : %s", errmsg);
+		sqlite3_free(errmsg);
+		return CAL_ERR_DB_FAILED;
+	}
+
+	return CAL_SUCCESS;
+}
+
+static int upgrade_to_v2(sqlite3 *db)
+{
+	int ret;
+	char *errmsg;
+
+	ret = sqlite3_exec(db,
+			"CREATE INDEX IF NOT EXISTS normal_inst_idx1 ON "CALS_TABLE_NORMAL_INSTANCE"(event_id);"
+			"CREATE INDEX IF NOT EXISTS normal_inst_idx2 ON "CALS_TABLE_NORMAL_INSTANCE
+			"(dtstart_utime, dtend_utime, event_id);"
+			"CREATE INDEX IF NOT EXISTS allday_inst_idx1 ON "CALS_TABLE_ALLDAY_INSTANCE"(event_id);"
+			"CREATE INDEX IF NOT EXISTS allday_inst_idx2 ON "CALS_TABLE_ALLDAY_INSTANCE
+			"(dtstart_datetime, dtend_datetime, event_id);"
+			"PRAGMA user_version = 2;",
+			NULL, 0, &errmsg);
+	if (SQLITE_OK != ret) {
+		ERR("upgrade to version 2 is Failed : %s", errmsg);
+		sqlite3_free(errmsg);
+		return CAL_ERR_DB_FAILED;
+	}
+
+	return CAL_SUCCESS;
+}
+
+#define CALS_SEARCH_ATTENDEE(id) \
+	"(SELECT group_concat(attendee_name, ' ') FROM "CALS_TABLE_PARTICIPANT" WHERE event_id = "id")"
+
+static int upgrade_to_v3(sqlite3 *db)
+{
+	int ret;
+	char *errmsg;
+
+	ret = sqlite3_exec(db,
+			"CREATE VIRTUAL TABLE IF NOT EXISTS "CALS_TABLE_SEARCH" "
+			"USING fts4(summary, description, location, attendee, prefix='2,3');"
+			"DROP TRIGGER IF EXISTS trg_search_ins;"
+			"CREATE TRIGGER trg_search_ins AFTER INSERT ON "CALS_TABLE_SCHEDULE" "
+			"BEGIN "
+			"INSERT INTO "CALS_TABLE_SEARCH"(docid, summary, description, location, attendee) "
+			"VALUES(new.id, new.summary, new.description, new.location, "CALS_SEARCH_ATTENDEE("new.id")");"
+			"END;"
+			"DROP TRIGGER IF EXISTS trg_search_mod;"
+			"CREATE TRIGGER trg_search_mod AFTER UPDATE OF summary, description, location ON "CALS_TABLE_SCHEDULE" "
+			"BEGIN "
+			"UPDATE "CALS_TABLE_SEARCH" SET summary = new.summary, description = new.description, "
+			"location = new.location WHERE docid = new.id;"
+			"END;"
+			"DROP TRIGGER IF EXISTS trg_search_del;"
+			"CREATE TRIGGER trg_search_del AFTER DELETE ON "CALS_TABLE_SCHEDULE" "
+			"BEGIN "
+			"DELETE FROM "CALS_TABLE_SEARCH" WHERE docid = old.id;"
+			"END;"
+			"DROP TRIGGER IF EXISTS trg_search_attendee_ins;"
+			"CREATE TRIGGER trg_search_attendee_ins AFTER INSERT ON "CALS_TABLE_PARTICIPANT" "
+			"BEGIN "
+			"UPDATE "CALS_TABLE_SEARCH" SET attendee = "CALS_SEARCH_ATTENDEE("new.event_id")" "
+			"WHERE docid = new.event_id;"
+			"END;"
+			"DROP TRIGGER IF EXISTS trg_search_attendee_mod;"
+			"CREATE TRIGGER trg_search_attendee_mod AFTER UPDATE OF attendee_name ON "CALS_TABLE_PARTICIPANT" "
+			"BEGIN "
+			"UPDATE "CALS_TABLE_SEARCH" SET attendee = "CALS_SEARCH_ATTENDEE("new.event_id")" "
+			"WHERE docid = new.event_id;"
+			"END;"
+			"DROP TRIGGER IF EXISTS trg_search_attendee_del;"
+			"CREATE TRIGGER trg_search_attendee_del AFTER DELETE ON "CALS_TABLE_PARTICIPANT" "
+			"BEGIN "
+			"UPDATE "CALS_TABLE_SEARCH" SET attendee = "CALS_SEARCH_ATTENDEE("old.event_id")" "
+			"WHERE docid = old.event_id;"
+			"END;"
+			"DELETE FROM "CALS_TABLE_SEARCH";"
+			"INSERT INTO "CALS_TABLE_SEARCH"(docid, summary, description, location, attendee) "
+			"SELECT id, summary, description, location, "CALS_SEARCH_ATTENDEE(CALS_TABLE_SCHEDULE".id")" "
+			"FROM "CALS_TABLE_SCHEDULE";"
+			"PRAGMA user_version = 3;",
+			NULL, 0, &errmsg);
+	if (SQLITE_OK != ret) {
+		ERR("upgrade to version 3 is Failed : %s", errmsg);
+		sqlite3_free(errmsg);
+		return CAL_ERR_DB_FAILED;
+	}
+
+	return CAL_SUCCESS;
+}
+
+static int (*upgrade_db[])(sqlite3 *db) = {
+	[0] = upgrade_to_v1,
+	[1] = upgrade_to_v2,
+	[2] = upgrade_to_v3,
+};
+
+static inline int upgrade_db_file(void)
+{
+	int ret, version;
+	char *errmsg;
+	sqlite3 *db;
+
+	ret = db_util_open(CALS_DB_PATH, &db, 0);
+	retvm_if(SQLITE_OK != ret, CAL_ERR_DB_NOT_OPENED, "db_util_open() Failed(%d)", ret);
+
+	version = get_db_version(db);
+	if (version < 0 || CALS_DB_VERSION <= version) {
+		db_util_close(db);
+		return CAL_SUCCESS;
+	}
+
+	ret = sqlite3_exec(db, "BEGIN IMMEDIATE TRANSACTION", NULL, 0, &errmsg);
+	if (SQLITE_OK != ret) {
+		ERR("sqlite3_exec() Failed : %s", errmsg);
+		sqlite3_free(errmsg);
+		db_util_close(db);
+		return CAL_ERR_DB_LOCK;
+	}
+
+	for (ret = CAL_SUCCESS; CAL_SUCCESS == ret && version < CALS_DB_VERSION; version++)
+		ret = upgrade_db[version](db);
+
+	sqlite3_exec(db, CAL_SUCCESS == ret ? "COMMIT TRANSACTION" : "ROLLBACK TRANSACTION",
+			NULL, 0, NULL);
+	db_util_close(db);
+
+	return ret;
+}
+
+/*
+ * The journal mode is stored in the DB file, so it is switched here
+ * outside of any transaction. A hot rollback journal is recovered on open,
+ * and a WAL is checkpointed into the DB file when leaving WAL.
+ * The WAL and shm files of WAL mode are made here with the permission of
+ * the DB, and the library keeps them on close (SQLITE_FCNTL_PERSIST_WAL).
+ */
+static inline int set_db_journal_mode(void)
+{
+	int ret;
+	char *errmsg;
+	sqlite3 *db;
+
+	ret = db_util_open(CALS_DB_PATH, &db, 0);
+	retvm_if(SQLITE_OK != ret, CAL_ERR_DB_NOT_OPENED, "db_util_open() Failed(%d)", ret);
+
+#ifdef CALS_DB_WAL
+	ret = sqlite3_exec(db, "PRAGMA journal_mode = WAL", NULL, 0, &errmsg);
+#else
+	ret = sqlite3_exec(db, "PRAGMA journal_mode = DELETE", NULL, 0, &errmsg);
+#endif
+	if (SQLITE_OK != ret) {
+		ERR("sqlite3_exec(journal_mode) Failed : %s", errmsg);
+		sqlite3_free(errmsg);
+		db_util_close(db);
+		return CAL_ERR_DB_LOCK;
+	}
+	db_util_close(db);
+
+#ifdef CALS_DB_WAL
+	ret = set_db_file_permission(CALS_DB_WAL_PATH);
+	retv_if(CAL_SUCCESS != ret, ret);
+	ret = set_db_file_permission(CALS_DB_SHM_PATH);
+	retv_if(CAL_SUCCESS != ret, ret);
+#endif
+
+	return CAL_SUCCESS;
+}
+
 static inline int check_schema(void)
 {
 	if (check_db_file())
 		remake_db_file();
+	else
+		upgrade_db_file();
+
+	set_db_journal_mode();
 
 	return CAL_SUCCESS;
 }
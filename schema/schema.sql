@@ -75,6 +75,7 @@ CREATE INDEX sch_idx1 ON schedule_table(type);
 CREATE TRIGGER trg_sch_del AFTER DELETE ON schedule_table
  BEGIN
    DELETE FROM alarm_table WHERE event_id = old.id;
+   DELETE FROM instance_range_table WHERE event_id = old.id;
    DELETE FROM normal_instance_table WHERE event_id = (SELECT rowid FROM schedule_table WHERE original_event_id = old.id);
    DELETE FROM allday_instance_table WHERE event_id = (SELECT rowid FROM schedule_table WHERE original_event_id = old.id);
    DELETE FROM schedule_table WHERE original_event_id = old.id;
@@ -116,6 +117,8 @@ event_id INTEGER,
 dtstart_utime INTEGER,
 dtend_utime INTEGER
 );
+CREATE INDEX normal_inst_idx1 ON normal_instance_table(event_id);
+CREATE INDEX normal_inst_idx2 ON normal_instance_table(dtstart_utime, dtend_utime, event_id);
 
 CREATE TABLE allday_instance_table
 (
@@ -123,6 +126,16 @@ event_id INTEGER,
 dtstart_datetime TEXT,
 dtend_datetime TEXT
 );
+CREATE INDEX allday_inst_idx1 ON allday_instance_table(event_id);
+CREATE INDEX allday_inst_idx2 ON allday_instance_table(dtstart_datetime, dtend_datetime, event_id);
+
+CREATE TABLE instance_range_table
+(
+event_id INTEGER PRIMARY KEY,
+range_start INTEGER,
+range_end INTEGER,
+inst_cnt INTEGER
+);
 
 CREATE TABLE cal_participant_table
 (
@@ -141,6 +154,42 @@ attendee_delegate_uri TEXT,
 attendee_uid TEXT
 );
 
+-- full text index of schedules, docid is schedule_table.id
+CREATE VIRTUAL TABLE schedule_search USING fts4(summary, description, location, attendee, prefix='2,3');
+CREATE TRIGGER trg_search_ins AFTER INSERT ON schedule_table
+ BEGIN
+   INSERT INTO schedule_search(docid, summary, description, location, attendee)
+   VALUES(new.id, new.summary, new.description, new.location,
+   (SELECT group_concat(attendee_name, ' ') FROM cal_participant_table WHERE event_id = new.id));
+ END;
+CREATE TRIGGER trg_search_mod AFTER UPDATE OF summary, description, location ON schedule_table
+ BEGIN
+   UPDATE schedule_search SET summary = new.summary, description = new.description, location = new.location
+   WHERE docid = new.id;
+ END;
+CREATE TRIGGER trg_search_del AFTER DELETE ON schedule_table
+ BEGIN
+   DELETE FROM schedule_search WHERE docid = old.id;
+ END;
+CREATE TRIGGER trg_search_attendee_ins AFTER INSERT ON cal_participant_table
+ BEGIN
+   UPDATE schedule_search SET attendee =
+   (SELECT group_concat(attendee_name, ' ') FROM cal_participant_table WHERE event_id = new.event_id)
+   WHERE docid = new.event_id;
+ END;
+CREATE TRIGGER trg_search_attendee_mod AFTER UPDATE OF attendee_name ON cal_participant_table
+ BEGIN
+   UPDATE schedule_search SET attendee =
+   (SELECT group_concat(attendee_name, ' ') FROM cal_participant_table WHERE event_id = new.event_id)
+   WHERE docid = new.event_id;
+ END;
+CREATE TRIGGER trg_search_attendee_del AFTER DELETE ON cal_participant_table
+ BEGIN
+   UPDATE schedule_search SET attendee =
+   (SELECT group_concat(attendee_name, ' ') FROM cal_participant_table WHERE event_id = old.event_id)
+   WHERE docid = old.event_id;
+ END;
+
 CREATE TABLE calendar_table
 (
 calendar_id TEXT,
@@ -232,3 +281,5 @@ INSERT INTO version_table VALUES(0);
 
 INSERT INTO calendar_table VALUES(0,0,0,0,'Default event calendar',0,0,'224.167.79.255',0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,-1,0,1);
 INSERT INTO calendar_table VALUES(0,0,0,0,'Default todo calendar',0,0,'41.177.227.255',0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,-1,0,2);
+
+PRAGMA user_version = 3;
@@ -56,6 +56,11 @@ int cals_alarm_remove(int type, int related_id)
 	case CALS_ALARM_REMOVE_ALL:
 		sprintf(query, "SELECT alarm_id FROM %s WHERE alarm_id <> 0", CALS_TABLE_ALARM);
 		break;
+	case CALS_ALARM_REMOVE_BY_TMP_IDS:
+		sprintf(query, "SELECT alarm_id FROM %s "
+			"WHERE event_id IN (SELECT id FROM %s) AND alarm_id <> 0",
+			CALS_TABLE_ALARM, CALS_TABLE_TMP_IDS);
+		break;
 	}
 
 	stmt = cals_query_prepare(query);
@@ -92,6 +97,10 @@ int cals_alarm_remove(int type, int related_id)
 	case CALS_ALARM_REMOVE_ALL:
 		sprintf(query, "DELETE FROM %s", CALS_TABLE_ALARM);
 		break;
+	case CALS_ALARM_REMOVE_BY_TMP_IDS:
+		sprintf(query, "DELETE FROM %s WHERE event_id IN (SELECT id FROM %s)",
+			CALS_TABLE_ALARM, CALS_TABLE_TMP_IDS);
+		break;
 	}
 
 	stmt = cals_query_prepare(query);
@@ -113,33 +122,33 @@ int _cals_alarm_add_to_db(const int event_id, cal_alarm_info_t *alarm_info)
 	CALS_FN_CALL;
 	int r;
 	sqlite3_stmt *stmt = NULL;
-	char query[CALS_SQL_MAX_LEN] = {0};
 
-	sprintf(query, "INSERT INTO %s ("
+	stmt = cals_query_prepare_cached("INSERT INTO "CALS_TABLE_ALARM" ("
 			"event_id, "
 			"alarm_time, remind_tick, remind_tick_unit, alarm_tone, "
 			"alarm_description, alarm_type, alarm_id "
 			") VALUES ( "
-			"%d, "
-			"%lld, %d, %d, ?, "
-			"?, %d, %d )",
-			CALS_TABLE_ALARM,
-			event_id,
-			alarm_info->alarm_time, alarm_info->remind_tick, alarm_info->remind_tick_unit,
-			alarm_info->alarm_type, alarm_info->alarm_id);
-
-	DBG("query(%s)\n", query);
-	stmt = cals_query_prepare(query);
-	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+			"?, "
+			"?, ?, ?, ?, "
+			"?, ?, ? )");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+	sqlite3_bind_int64(stmt, 2, alarm_info->alarm_time);
+	sqlite3_bind_int(stmt, 3, alarm_info->remind_tick);
+	sqlite3_bind_int(stmt, 4, alarm_info->remind_tick_unit);
 
 	if (alarm_info->alarm_tone)
-		cals_stmt_bind_text(stmt, 1, alarm_info->alarm_tone);
+		cals_stmt_bind_text(stmt, 5, alarm_info->alarm_tone);
 
 	if (alarm_info->alarm_description)
-		cals_stmt_bind_text(stmt, 2, alarm_info->alarm_description);
+		cals_stmt_bind_text(stmt, 6, alarm_info->alarm_description);
+
+	sqlite3_bind_int(stmt, 7, alarm_info->alarm_type);
+	sqlite3_bind_int(stmt, 8, alarm_info->alarm_id);
 
 	r = cals_stmt_step(stmt);
-	sqlite3_finalize(stmt);
+	cals_stmt_release(stmt);
 
 	if (CAL_SUCCESS != r) {
 		ERR("cals_stmt_step() Failed(%d)", r);
@@ -304,68 +313,128 @@ static void _cals_alarm_value_free(gpointer data, gpointer user_data)
 }
 
 
+static cal_value *_cals_alarm_get_value(sqlite3_stmt *stmt)
+{
+	cal_value *cvalue;
+	cal_alarm_info_t *alarm_info;
+
+	cvalue = calloc(1, sizeof(cal_value));
+	retvm_if(NULL == cvalue, NULL, "calloc() Failed(%d)", errno);
+
+	cvalue->v_type = CAL_EVENT_ALARM;
+	cvalue->user_data = alarm_info = calloc(1, sizeof(cal_alarm_info_t));
+	if (NULL == alarm_info) {
+		free(cvalue);
+		ERR("calloc() Failed(%d)", errno);
+		return NULL;
+	}
+
+	alarm_info->event_id = sqlite3_column_int(stmt, 0);
+
+	alarm_info->alarm_time = sqlite3_column_int64(stmt, 1);
+	alarm_info->remind_tick = sqlite3_column_int(stmt, 2);
+	alarm_info->remind_tick_unit = sqlite3_column_int(stmt, 3);
+	alarm_info->alarm_tone = SAFE_STRDUP(sqlite3_column_text(stmt, 4));
+	alarm_info->alarm_description = SAFE_STRDUP(sqlite3_column_text(stmt, 5));
+	alarm_info->alarm_type = sqlite3_column_int(stmt, 6);
+	alarm_info->alarm_id = sqlite3_column_int(stmt, 7);
+
+	return cvalue;
+}
+
 int cals_get_alarm_info(const int event_id, GList **alarm_list)
 {
 	int ret = -1;
 	GList *result = NULL;
 	sqlite3_stmt *stmt = NULL;
 	cal_value * cvalue = NULL;
-	char query[CALS_SQL_MAX_LEN] = {0};
-	cal_alarm_info_t* alarm_info = NULL;
 
 	retv_if(NULL == alarm_list, CAL_ERR_ARG_NULL);
 
-	sprintf(query, "SELECT * FROM %s WHERE event_id=%d", CALS_TABLE_ALARM, event_id);
+	stmt = cals_query_prepare_cached("SELECT * FROM "CALS_TABLE_ALARM" WHERE event_id=?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
 
-	stmt = cals_query_prepare(query);
-	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+	sqlite3_bind_int(stmt, 1, event_id);
 
 	ret = cals_stmt_step(stmt);
 	if (ret < CAL_SUCCESS) {
-		sqlite3_finalize(stmt);
+		cals_stmt_release(stmt);
 		ERR("cals_stmt_step() Failed(%d)", ret);
 		return ret;
 	}
 
 	while (CAL_TRUE == ret)
 	{
-		cvalue = calloc(1, sizeof(cal_value));
+		cvalue = _cals_alarm_get_value(stmt);
 		if (NULL == cvalue) {
-			sqlite3_finalize(stmt);
+			cals_stmt_release(stmt);
 			g_list_foreach(result, _cals_alarm_value_free, NULL);
 			g_list_free(result);
-			ERR("calloc() Failed(%d)", errno);
 			return CAL_ERR_OUT_OF_MEMORY;
 		}
 
-		cvalue->v_type = CAL_EVENT_ALARM;
-		cvalue->user_data = alarm_info = calloc(1, sizeof(cal_alarm_info_t));
-		if (NULL == alarm_info) {
-			sqlite3_finalize(stmt);
-			g_list_foreach(result, _cals_alarm_value_free, NULL);
-			g_list_free(result);
-			free(cvalue);
-			ERR("calloc() Failed(%d)", errno);
-			return CAL_ERR_OUT_OF_MEMORY;
-		}
+		result = g_list_prepend(result, cvalue);
 
-		alarm_info->event_id = sqlite3_column_int(stmt, 0);
+		ret = cals_stmt_step(stmt);
+	}
+	cals_stmt_release(stmt);
 
-		alarm_info->alarm_time = sqlite3_column_int64(stmt, 1);
-		alarm_info->remind_tick = sqlite3_column_int(stmt, 2);
-		alarm_info->remind_tick_unit = sqlite3_column_int(stmt, 3);
-		alarm_info->alarm_tone = SAFE_STRDUP(sqlite3_column_text(stmt, 4));
-		alarm_info->alarm_description = SAFE_STRDUP(sqlite3_column_text(stmt, 5));
-		alarm_info->alarm_type = sqlite3_column_int(stmt, 6);
-		alarm_info->alarm_id = sqlite3_column_int(stmt, 7);
+	*alarm_list = g_list_reverse(result);
 
-		result = g_list_append(result, cvalue);
+	return CAL_SUCCESS;
+}
 
-		ret = cals_stmt_step(stmt);
+/* alarm_lists[i] gets the alarms of ids[i] */
+int cals_get_alarm_info_by_ids(const int *ids, int cnt, GList **alarm_lists)
+{
+	int i;
+	int ret;
+	sqlite3_stmt *stmt;
+	cal_value *cvalue;
+
+	retv_if(NULL == ids, CAL_ERR_ARG_NULL);
+	retv_if(NULL == alarm_lists, CAL_ERR_ARG_NULL);
+	retv_if(cnt < 0 || CALS_SQL_IN_MAX < cnt, CAL_ERR_ARG_INVALID);
+
+	memset(alarm_lists, 0, cnt * sizeof(GList *));
+	if (0 == cnt)
+		return CAL_SUCCESS;
+
+	stmt = cals_query_prepare_cached("SELECT * FROM "CALS_TABLE_ALARM" "
+			"WHERE event_id IN "CALS_SQL_IN" ORDER BY rowid");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	cals_stmt_bind_ids(stmt, ids, cnt);
+
+	while (CAL_TRUE == (ret = cals_stmt_step(stmt))) {
+		for (i = 0; i < cnt; i++) {
+			if (ids[i] == sqlite3_column_int(stmt, 0))
+				break;
+		}
+		if (cnt == i)
+			continue;
+
+		cvalue = _cals_alarm_get_value(stmt);
+		if (NULL == cvalue) {
+			ret = CAL_ERR_OUT_OF_MEMORY;
+			break;
+		}
+		alarm_lists[i] = g_list_prepend(alarm_lists[i], cvalue);
+	}
+	cals_stmt_release(stmt);
+
+	if (ret < CAL_SUCCESS) {
+		ERR("Failed to get alarms(%d)", ret);
+		for (i = 0; i < cnt; i++) {
+			g_list_foreach(alarm_lists[i], _cals_alarm_value_free, NULL);
+			g_list_free(alarm_lists[i]);
+			alarm_lists[i] = NULL;
+		}
+		return ret;
 	}
-	sqlite3_finalize(stmt);
 
-	*alarm_list = result;
+	for (i = 0; i < cnt; i++)
+		alarm_lists[i] = g_list_reverse(alarm_lists[i]);
 
 	return CAL_SUCCESS;
 }
@@ -26,11 +26,13 @@ enum {
 	CALS_ALARM_REMOVE_BY_CALENDAR_ID,
 	CALS_ALARM_REMOVE_BY_ACC_ID,
 	CALS_ALARM_REMOVE_ALL,
+	CALS_ALARM_REMOVE_BY_TMP_IDS, /* events in CALS_TABLE_TMP_IDS, related_id is not used */
 };
 int cals_alarm_remove(int type, int related_id);
 int cals_alarm_add(int event_id, cal_alarm_info_t *alarm_info, struct cals_time *start_time);
 int cals_alarm_get_event_id(int alarm_id);
 int cals_get_alarm_info(const int event_id, GList **alarm_list);
+int cals_get_alarm_info_by_ids(const int *ids, int cnt, GList **alarm_lists);
 
 
 #endif /* __CALENDAR_SVC_ALARM_H__ */
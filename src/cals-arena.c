@@ -0,0 +1,147 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <string.h>
+#include "cals-arena.h"
+#include "cals-internal.h"
+
+#define CALS_ARENA_SIZE 1024 /* enough for the strings of most records */
+#define CALS_ARENA_ALIGN sizeof(void *)
+
+struct cals_arena_block {
+	struct cals_arena_block *next;
+	size_t size;
+	char data[];
+};
+
+struct cals_arena {
+	struct cals_arena_block *blocks; /* added when data is full */
+	char *cur; /* free space of the last block */
+	size_t left;
+	char data[CALS_ARENA_SIZE];
+};
+
+struct cals_arena *cals_arena_new(void)
+{
+	struct cals_arena *arena;
+
+	arena = malloc(sizeof(struct cals_arena));
+	retvm_if(NULL == arena, NULL, "malloc failed");
+
+	arena->blocks = NULL;
+	arena->cur = arena->data;
+	arena->left = sizeof(arena->data);
+	return arena;
+}
+
+void cals_arena_destroy(struct cals_arena *arena)
+{
+	cals_arena_reset(arena);
+	free(arena);
+}
+
+/* all memory is given back, the first block is kept for the next record */
+void cals_arena_reset(struct cals_arena *arena)
+{
+	struct cals_arena_block *b;
+
+	if (NULL == arena)
+		return;
+
+	while (arena->blocks) {
+		b = arena->blocks->next;
+		free(arena->blocks);
+		arena->blocks = b;
+	}
+	arena->cur = arena->data;
+	arena->left = sizeof(arena->data);
+}
+
+static struct cals_arena_block *_arena_add_block(struct cals_arena *arena, size_t size)
+{
+	struct cals_arena_block *b;
+
+	b = malloc(sizeof(struct cals_arena_block) + size);
+	retvm_if(NULL == b, NULL, "malloc failed");
+
+	b->size = size;
+	b->next = arena->blocks;
+	arena->blocks = b;
+	return b;
+}
+
+void *cals_arena_alloc(struct cals_arena *arena, size_t size)
+{
+	void *p;
+	struct cals_arena_block *b;
+
+	retv_if(NULL == arena, NULL);
+
+	size = (size + CALS_ARENA_ALIGN - 1) & ~(CALS_ARENA_ALIGN - 1);
+
+	if (arena->left < size) {
+		/* large one gets its own block, the free space is kept */
+		if (CALS_ARENA_SIZE / 4 < size) {
+			b = _arena_add_block(arena, size);
+			retv_if(NULL == b, NULL);
+			return b->data;
+		}
+
+		b = _arena_add_block(arena, CALS_ARENA_SIZE);
+		retv_if(NULL == b, NULL);
+		arena->cur = b->data;
+		arena->left = CALS_ARENA_SIZE;
+	}
+
+	p = arena->cur;
+	arena->cur += size;
+	arena->left -= size;
+	return p;
+}
+
+char *cals_arena_strndup(struct cals_arena *arena, const char *src, size_t len)
+{
+	char *dest;
+
+	retv_if(NULL == src, NULL);
+
+	dest = cals_arena_alloc(arena, len + 1);
+	retv_if(NULL == dest, NULL);
+
+	memcpy(dest, src, len);
+	dest[len] = '\0';
+	return dest;
+}
+
+bool cals_arena_owns(struct cals_arena *arena, const void *ptr)
+{
+	const char *p = ptr;
+	struct cals_arena_block *b;
+
+	if (NULL == arena || NULL == ptr)
+		return false;
+
+	if (arena->data <= p && p < arena->data + sizeof(arena->data))
+		return true;
+
+	for (b = arena->blocks; b; b = b->next) {
+		if (b->data <= p && p < b->data + b->size)
+			return true;
+	}
+	return false;
+}
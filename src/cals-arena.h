@@ -0,0 +1,47 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __CALENDAR_SVC_ARENA_H__
+#define __CALENDAR_SVC_ARENA_H__
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/*
+ * Bump allocator for the strings of one record.
+ * Memory is carved from a few blocks and released at once by cals_arena_destroy(),
+ * a pointer of the arena should not be freed by free().
+ */
+struct cals_arena;
+
+struct cals_arena *cals_arena_new(void);
+void cals_arena_destroy(struct cals_arena *arena);
+void cals_arena_reset(struct cals_arena *arena);
+void *cals_arena_alloc(struct cals_arena *arena, size_t size);
+char *cals_arena_strndup(struct cals_arena *arena, const char *src, size_t len);
+bool cals_arena_owns(struct cals_arena *arena, const void *ptr);
+
+/* frees ptr unless it is carved from the arena */
+#define CALS_ARENA_FREE(arena, ptr) \
+	do { \
+		if (!cals_arena_owns(arena, ptr)) \
+			free(ptr); \
+		ptr = NULL; \
+	} while (0)
+
+#endif /* __CALENDAR_SVC_ARENA_H__ */
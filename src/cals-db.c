@@ -34,6 +34,7 @@
 #include "cals-sqlite.h"
 #include "cals-schedule.h"
 #include "cals-db.h"
+#include "cals-arena.h"
 
 #ifdef CALS_IPC_SERVER
 extern __thread sqlite3 *calendar_db_handle;
@@ -116,24 +117,13 @@ int cals_db_free_alarm(cal_sch_full_t *record)
 	return 0;
 }
 
-int cals_db_free_attendee(cal_sch_full_t *record)
+static void _cals_db_free_attendee_list(GList *list)
 {
-	CALS_FN_CALL;
 	GList *l;
 	cal_value *cv;
 	cal_participant_info_t *pi;
 
-	if (record == NULL) {
-		ERR("Invalid argument: record is NULL");
-		return -1;
-	}
-
-	if (record->attendee_list == NULL) {
-		DBG("No attendee list to free");
-		return 0;
-	}
-
-	l = record->attendee_list;
+	l = list;
 	while (l) {
 		cv = (cal_value *)l->data;
 		if (cv == NULL) {
@@ -150,44 +140,89 @@ int cals_db_free_attendee(cal_sch_full_t *record)
 		CAL_FREE(pi->attendee_email);
 		CAL_FREE(pi->attendee_number);
 		CAL_FREE(pi->attendee_name);
+		CAL_FREE(pi->attendee_uid);
+		CAL_FREE(pi->attendee_group);
+		CAL_FREE(pi->attendee_delegate_uri);
+		CAL_FREE(pi->attendee_delegator_uri);
 		CAL_FREE(pi);
 
 		CAL_FREE(cv);
 
 		l = g_list_next(l);
 	}
-	g_list_free(record->attendee_list);
+	g_list_free(list);
+}
+
+int cals_db_free_attendee(cal_sch_full_t *record)
+{
+	CALS_FN_CALL;
+
+	if (record == NULL) {
+		ERR("Invalid argument: record is NULL");
+		return -1;
+	}
+
+	if (record->attendee_list == NULL) {
+		DBG("No attendee list to free");
+		return 0;
+	}
+
+	_cals_db_free_attendee_list(record->attendee_list);
 	record->attendee_list = NULL;
 
 	return 0;
 }
 
-int cal_db_service_free_full_record(cal_sch_full_t *record)
+/* frees the strings and lists of the record, the arena is reset to be reused */
+int cal_db_service_clear_full_record(cal_sch_full_t *record)
 {
 	if (record == NULL) {
 		ERR("Invalid argument: record is NULL");
 		return -1;
 	}
 
-	CAL_FREE(record->dtstart_tzid);
-	CAL_FREE(record->dtend_tzid);
-	CAL_FREE(record->summary);
-	CAL_FREE(record->description);
-	CAL_FREE(record->location);
-	CAL_FREE(record->categories);
-	CAL_FREE(record->uid);
-	CAL_FREE(record->organizer_name);
-	CAL_FREE(record->organizer_email);
-	CAL_FREE(record->gcal_id);
-	CAL_FREE(record->updated);
-	CAL_FREE(record->location_summary);
-	CAL_FREE(record->etag);
-	CAL_FREE(record->edit_uri);
-	CAL_FREE(record->gevent_id);
+	CALS_ARENA_FREE(record->arena, record->dtstart_tzid);
+	CALS_ARENA_FREE(record->arena, record->dtend_tzid);
+	CALS_ARENA_FREE(record->arena, record->summary);
+	CALS_ARENA_FREE(record->arena, record->description);
+	CALS_ARENA_FREE(record->arena, record->location);
+	CALS_ARENA_FREE(record->arena, record->categories);
+	CALS_ARENA_FREE(record->arena, record->uid);
+	CALS_ARENA_FREE(record->arena, record->organizer_name);
+	CALS_ARENA_FREE(record->arena, record->organizer_email);
+	CALS_ARENA_FREE(record->arena, record->gcal_id);
+	CALS_ARENA_FREE(record->arena, record->updated);
+	CALS_ARENA_FREE(record->arena, record->location_summary);
+	CALS_ARENA_FREE(record->arena, record->etag);
+	CALS_ARENA_FREE(record->arena, record->edit_uri);
+	CALS_ARENA_FREE(record->arena, record->gevent_id);
+	CALS_ARENA_FREE(record->arena, record->exdate);
+	CALS_ARENA_FREE(record->arena, record->bysecond);
+	CALS_ARENA_FREE(record->arena, record->byminute);
+	CALS_ARENA_FREE(record->arena, record->byhour);
+	CALS_ARENA_FREE(record->arena, record->byday);
+	CALS_ARENA_FREE(record->arena, record->bymonthday);
+	CALS_ARENA_FREE(record->arena, record->byyearday);
+	CALS_ARENA_FREE(record->arena, record->byweekno);
+	CALS_ARENA_FREE(record->arena, record->bymonth);
+	CALS_ARENA_FREE(record->arena, record->bysetpos);
 
 	cals_db_free_alarm(record);
 	cals_db_free_attendee(record);
 
+	cals_arena_reset(record->arena);
+
+	return 0;
+}
+
+int cal_db_service_free_full_record(cal_sch_full_t *record)
+{
+	retvm_if(NULL == record, -1, "Invalid argument: record is NULL");
+
+	cal_db_service_clear_full_record(record);
+	cals_arena_destroy(record->arena);
+	record->arena = NULL;
+
 	return 0;
 }
 
@@ -200,52 +235,45 @@ int cal_service_add_participant_info(const int event_id, const cal_participant_i
 {
 	int ret = -1;
 	sqlite3_stmt *stmt = NULL;
-	char sql_value[CALS_SQL_MAX_LEN];
 
-	//check if db opened
-
-	sprintf(sql_value,"INSERT INTO %s(event_id,attendee_name,attendee_email,attendee_number,attendee_status,attendee_type,attendee_ct_index,"
+	stmt = cals_query_prepare_cached("INSERT INTO "CALS_TABLE_PARTICIPANT"(event_id,attendee_name,attendee_email,"
+			"attendee_number,attendee_status,attendee_type,attendee_ct_index,"
 			"attendee_role,attendee_rsvp,attendee_group,attendee_delegator_uri,attendee_delegate_uri,attendee_uid) "
-			"VALUES(%d, ?, ?, ?, %d, %d, %d,%d,%d,?,?,?,?)", CALS_TABLE_PARTICIPANT,
-			event_id,
-			current_record->attendee_status,
-			current_record->attendee_type,
-			current_record->attendee_ct_index,
-			current_record->attendee_role,
-			current_record->attendee_rsvp);
-
-	stmt = cals_query_prepare(sql_value);
-	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+			"VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
 
 	if (current_record->attendee_name)
-		cals_stmt_bind_text(stmt, 1, current_record->attendee_name);
+		cals_stmt_bind_text(stmt, 2, current_record->attendee_name);
 
 	if (current_record->attendee_email)
-		cals_stmt_bind_text(stmt, 2, current_record->attendee_email);
+		cals_stmt_bind_text(stmt, 3, current_record->attendee_email);
 
 	if (current_record->attendee_number)
-		cals_stmt_bind_text(stmt, 3, current_record->attendee_number);
+		cals_stmt_bind_text(stmt, 4, current_record->attendee_number);
+
+	sqlite3_bind_int(stmt, 5, current_record->attendee_status);
+	sqlite3_bind_int(stmt, 6, current_record->attendee_type);
+	sqlite3_bind_int(stmt, 7, current_record->attendee_ct_index);
+	sqlite3_bind_int(stmt, 8, current_record->attendee_role);
+	sqlite3_bind_int(stmt, 9, current_record->attendee_rsvp);
 
 	if (current_record->attendee_group)
-		cals_stmt_bind_text(stmt, 4, current_record->attendee_group);
+		cals_stmt_bind_text(stmt, 10, current_record->attendee_group);
 
 	if (current_record->attendee_delegator_uri)
-		cals_stmt_bind_text(stmt, 5, current_record->attendee_delegator_uri);
+		cals_stmt_bind_text(stmt, 11, current_record->attendee_delegator_uri);
 
 	if (current_record->attendee_delegate_uri)
-		cals_stmt_bind_text(stmt, 6, current_record->attendee_delegate_uri);
+		cals_stmt_bind_text(stmt, 12, current_record->attendee_delegate_uri);
 
 	if (current_record->attendee_uid)
-		cals_stmt_bind_text(stmt, 7, current_record->attendee_uid);
-
+		cals_stmt_bind_text(stmt, 13, current_record->attendee_uid);
 
 	ret = cals_stmt_step(stmt);
-	if (CAL_SUCCESS != ret) {
-		sqlite3_finalize(stmt);
-		ERR("cals_stmt_step() Failed(%d)", ret);
-		return ret;
-	}
-	sqlite3_finalize(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_stmt_step() Failed(%d)", ret);
 
 	return CAL_SUCCESS;
 }
@@ -256,13 +284,101 @@ int cal_service_add_participant_info(const int event_id, const cal_participant_i
  *                                                                                               *
  ************************************************************************************************/
 
+static cal_value *_cal_db_get_participant_value(sqlite3_stmt *stmt)
+{
+	cal_value *cvalue;
+	cal_participant_info_t *participant_info;
+
+	cvalue = calloc(1, sizeof(cal_value));
+	retvm_if(NULL == cvalue, NULL, "calloc() Failed(%d)", errno);
+
+	cvalue->v_type = CAL_EVENT_PATICIPANT;
+	cvalue->user_data = participant_info = calloc(1, sizeof(cal_participant_info_t));
+	if (NULL == participant_info) {
+		free(cvalue);
+		ERR("calloc() Failed(%d)", errno);
+		return NULL;
+	}
+
+	participant_info->event_id = sqlite3_column_int(stmt, 0);
+
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_name),1);
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_email),2);
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_number),3);
+	participant_info->attendee_status = sqlite3_column_int(stmt, 4);
+	participant_info->attendee_type = sqlite3_column_int(stmt, 5);
+	participant_info->attendee_ct_index = sqlite3_column_int(stmt, 6);
+	participant_info->attendee_role = sqlite3_column_int(stmt, 7);
+	participant_info->attendee_rsvp = sqlite3_column_int(stmt, 8);
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_group),9);
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_delegator_uri),10);
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_delegate_uri),11);
+	cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_uid),12);
+
+	return cvalue;
+}
+
+/* record_lists[i] gets the participants of ids[i] */
+int cal_db_service_get_participant_info_by_ids(const int *ids, int cnt, GList **record_lists)
+{
+	int i;
+	int ret;
+	sqlite3_stmt *stmt;
+	cal_value *cvalue;
+
+	retv_if(NULL == ids, CAL_ERR_ARG_NULL);
+	retv_if(NULL == record_lists, CAL_ERR_ARG_NULL);
+	retv_if(cnt < 0 || CALS_SQL_IN_MAX < cnt, CAL_ERR_ARG_INVALID);
+
+	memset(record_lists, 0, cnt * sizeof(GList *));
+	if (0 == cnt)
+		return CAL_SUCCESS;
+
+	stmt = cals_query_prepare_cached("SELECT * FROM "CALS_TABLE_PARTICIPANT" "
+			"WHERE event_id IN "CALS_SQL_IN" ORDER BY rowid");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	cals_stmt_bind_ids(stmt, ids, cnt);
+
+	while (CAL_TRUE == (ret = cals_stmt_step(stmt))) {
+		for (i = 0; i < cnt; i++) {
+			if (ids[i] == sqlite3_column_int(stmt, 0))
+				break;
+		}
+		if (cnt == i)
+			continue;
+
+		cvalue = _cal_db_get_participant_value(stmt);
+		if (NULL == cvalue) {
+			ret = CAL_ERR_OUT_OF_MEMORY;
+			break;
+		}
+		record_lists[i] = g_list_prepend(record_lists[i], cvalue);
+	}
+	cals_stmt_release(stmt);
+
+	if (ret < CAL_SUCCESS) {
+		ERR("Failed to get participants(%d)", ret);
+		for (i = 0; i < cnt; i++) {
+			_cals_db_free_attendee_list(record_lists[i]);
+			record_lists[i] = NULL;
+		}
+		return ret;
+	}
+
+	for (i = 0; i < cnt; i++)
+		record_lists[i] = g_list_reverse(record_lists[i]);
+
+	return CAL_SUCCESS;
+}
+
 bool cal_db_service_get_participant_info_by_index(const int panticipant_index, GList** record_list, int *error_code)
 {
 	int	rc = -1;
-	char sql_value[CALS_SQL_MAX_LEN] = {0};
 	cal_participant_info_t* participant_info = NULL;
 	sqlite3_stmt *stmt = NULL;
 	cal_value *cvalue = NULL;
+	GList *list = NULL;
 
 	retex_if(error_code == NULL, ,"cal_db_service_get_record_by_index: The error_code is NULL.\n");
 
@@ -272,10 +388,10 @@ bool cal_db_service_get_participant_info_by_index(const int panticipant_index, G
 	//check if db opened
 	retex_if(NULL == calendar_db_handle, *error_code = CAL_ERR_DB_NOT_OPENED, "The calendar database hasn't been opened.");
 
-	sprintf(sql_value, "select * from cal_participant_table where event_id = %d;", panticipant_index);
+	stmt = cals_query_prepare_cached("select * from "CALS_TABLE_PARTICIPANT" where event_id = ?");
+	retex_if(NULL == stmt, *error_code = CAL_ERR_DB_FAILED, "Failed to get stmt!!");
 
-	rc = sqlite3_prepare_v2(calendar_db_handle, sql_value, strlen(sql_value), &stmt, NULL);
-	retex_if(rc != SQLITE_OK, *error_code = CAL_ERR_DB_FAILED, "Failed to get stmt!!");
+	sqlite3_bind_int(stmt, 1, panticipant_index);
 
 	rc = sqlite3_step(stmt);
 	retex_if(rc!= SQLITE_ROW && rc!= SQLITE_OK && rc!= SQLITE_DONE, *error_code = CAL_ERR_DB_FAILED, "[ERROR]cal_db_service_get_participant_info_by_index:Query error !!");
@@ -306,7 +422,7 @@ bool cal_db_service_get_participant_info_by_index(const int panticipant_index, G
 		cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_delegate_uri),11);
 		cal_db_get_text_from_stmt(stmt,&(participant_info->attendee_uid),12);
 
-		*record_list = g_list_append(*record_list, (gpointer)cvalue);
+		list = g_list_prepend(list, (gpointer)cvalue);
 
 		cvalue = NULL;
 
@@ -323,13 +439,16 @@ bool cal_db_service_get_participant_info_by_index(const int panticipant_index, G
 	//DBG("Get that\n");
 	if (stmt)
 	{
-		sqlite3_finalize(stmt);
+		cals_stmt_release(stmt);
 		stmt = NULL;
 	}
+	*record_list = g_list_concat(*record_list, g_list_reverse(list));
 
 	return true;
 
 CATCH:
+	if (list)
+		*record_list = g_list_concat(*record_list, g_list_reverse(list));
 	if (cvalue)
 	{
 		if (cvalue->user_data)
@@ -344,7 +463,7 @@ CATCH:
 
 	if (stmt)
 	{
-		sqlite3_finalize(stmt);
+		cals_stmt_release(stmt);
 		stmt = NULL;
 	}
 
@@ -38,6 +38,7 @@
  * @exception	CAL_ERR_ARG_INVALID.
  */
 int cal_db_service_free_full_record(cal_sch_full_t *sch_full_record);
+int cal_db_service_clear_full_record(cal_sch_full_t *sch_full_record);
 
 
 /**
@@ -51,6 +52,17 @@ int cal_db_service_free_full_record(cal_sch_full_t *sch_full_record);
  */
 bool cal_db_service_get_participant_info_by_index(const int panticipant_index, GList** record_list, int *error_code);
 
+/**
+ *  This function gets the participant info of several events at once.
+ *
+ * @return		This function returns CAL_SUCCESS or error code on failure.
+ * @param[in]		ids		event ids, up to CALS_SQL_IN_MAX.
+ * @param[in]		cnt		the number of ids.
+ * @param[out]	record_lists	record_lists[i] gets the participants of ids[i].
+ * @exception	CAL_ERR_ARG_NULL, CAL_ERR_ARG_INVALID, CAL_ERR_DB_FAILED, CAL_ERR_OUT_OF_MEMORY
+ */
+int cal_db_service_get_participant_info_by_ids(const int *ids, int cnt, GList **record_lists);
+
 /**
  *  This function get record by index base on table type.
  *
@@ -17,6 +17,7 @@
  *
  */
 #include <errno.h>
+#include <limits.h>
 
 #include "cals-internal.h"
 #include "cals-typedef.h"
@@ -27,6 +28,8 @@
 #include "cals-utils.h"
 #include "cals-schedule.h"
 #include "cals-time.h"
+#include "cals-recur.h"
+#include "cals-instance.h"
 
 static inline void cals_event_make_condition(int calendar_id,
 		time_t start_time, time_t end_time, int all_day, char *dest, int dest_size)
@@ -207,22 +210,27 @@ API int calendar_svc_event_get_changes(int calendar_id, int version, cal_iter **
 	return CAL_SUCCESS;
 }
 
-API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_code,
-		long long int stime, long long int etime, cal_iter **iter)
+static int _cals_event_get_normal_list(int calendar_id, int op_code,
+		long long int stime, long long int etime, const char *page, const char *order, cal_iter **iter)
 {
 	/* calendar_id: -1 means searching all calendar */
 	retv_if(iter == NULL, CAL_ERR_ARG_NULL);
 
+	int r;
 	char query[CALS_SQL_MIN_LEN] = {0};
-	char buf[64] = {0};
+	char buf[256] = {0};
 	sqlite3_stmt *stmt = NULL;
 
 	if (calendar_id > 0) {
-		snprintf(buf, sizeof(buf), "AND B.calendar_id = %d", calendar_id);
+		snprintf(buf, sizeof(buf), "AND B.calendar_id = %d %s", calendar_id, page);
 	} else {
-		memset(buf, 0x0, sizeof(buf));
+		snprintf(buf, sizeof(buf), "%s", page);
 	}
 
+	/* recurring instances are materialized on demand */
+	r = cals_instance_expand(calendar_id, CALS_TIME_UTIME, stime, etime);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_expand() Failed(%d)", r);
+
 	*iter = calloc(1, sizeof(cal_iter));
 	retvm_if(NULL == *iter, CAL_ERR_OUT_OF_MEMORY, "Failed to calloc(%d)", errno);
 	(*iter)->is_patched = 0;
@@ -239,11 +247,11 @@ API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_cod
 				"WHERE ((A.dtstart_utime < %lld AND A.dtend_utime > %lld) "
 				"OR A.dtstart_utime = %lld) "
 				"AND B.type = %d AND B.is_deleted = 0 AND C.visibility = 1 %s "
-				"ORDER BY A.dtstart_utime ",
+				"ORDER BY A.dtstart_utime%s",
 				CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
 				etime, stime,
 				stime,
-				CALS_SCH_TYPE_EVENT, buf);
+				CALS_SCH_TYPE_EVENT, buf, order);
 		break;
 
 	case CALS_LIST_PERIOD_NORMAL_BASIC:
@@ -258,11 +266,11 @@ API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_cod
 				"WHERE ((A.dtstart_utime < %lld AND A.dtend_utime > %lld) "
 				"OR A.dtstart_utime = %lld) "
 				"AND B.type = %d AND B.is_deleted = 0 AND C.visibility = 1 %s "
-				"ORDER BY A.dtstart_utime ",
+				"ORDER BY A.dtstart_utime%s",
 				CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
 				etime, stime,
 				stime,
-				CALS_SCH_TYPE_EVENT, buf);
+				CALS_SCH_TYPE_EVENT, buf, order);
 		break;
 
 	case CALS_LIST_PERIOD_NORMAL_OSP:
@@ -278,11 +286,11 @@ API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_cod
 				"WHERE ((A.dtstart_utime < %lld AND A.dtend_utime > %lld) "
 				"OR A.dtstart_utime = %lld) "
 				"AND B.type = %d AND B.is_deleted = 0 AND C.visibility = 1 %s "
-				"ORDER BY A.dtstart_utime ",
+				"ORDER BY A.dtstart_utime%s",
 				CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
 				etime, stime,
 				stime,
-				CALS_SCH_TYPE_EVENT, buf);
+				CALS_SCH_TYPE_EVENT, buf, order);
 		break;
 
 	case CALS_LIST_PERIOD_NORMAL_LOCATION:
@@ -299,11 +307,11 @@ API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_cod
 				"WHERE ((A.dtstart_utime < %lld AND A.dtend_utime > %lld) "
 				"OR A.dtstart_utime = %lld) "
 				"AND B.type = %d AND B.is_deleted = 0 AND C.visibility = 1 %s "
-				"ORDER BY A.dtstart_utime ",
+				"ORDER BY A.dtstart_utime%s",
 				CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
 				etime, stime,
 				stime,
-				CALS_SCH_TYPE_EVENT, buf);
+				CALS_SCH_TYPE_EVENT, buf, order);
 		break;
 
 	case CALS_LIST_PERIOD_NORMAL_ALARM:
@@ -330,12 +338,75 @@ API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_cod
 	}
 	DBG("query(%s)", query);
 	stmt = cals_query_prepare(query);
-	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "Failed to query prepare");
+	if (NULL == stmt) {
+		ERR("Failed to query prepare");
+		free(*iter);
+		*iter = NULL;
+		return CAL_ERR_DB_FAILED;
+	}
 
 	(*iter)->stmt = stmt;
 	return CAL_SUCCESS;
 }
 
+API int calendar_svc_event_get_normal_list_by_period(int calendar_id, int op_code,
+		long long int stime, long long int etime, cal_iter **iter)
+{
+	return _cals_event_get_normal_list(calendar_id, op_code, stime, etime, "", " ", iter);
+}
+
+API int calendar_svc_event_get_normal_list_by_period_page(int calendar_id, int op_code,
+		long long int stime, long long int etime, const char *token, int limit, cal_iter **iter)
+{
+	int r;
+	int id;
+	int col;
+	long long int key;
+	char page[128];
+	char order[64];
+
+	retvm_if(limit <= 0, CAL_ERR_ARG_INVALID, "Invalid limit(%d)", limit);
+
+	switch (op_code) {
+	case CALS_LIST_PERIOD_NORMAL_ONOFF:
+	case CALS_LIST_PERIOD_NORMAL_BASIC:
+		col = 2;
+		break;
+	case CALS_LIST_PERIOD_NORMAL_OSP:
+	case CALS_LIST_PERIOD_NORMAL_LOCATION:
+		col = 3;
+		break;
+	default:
+		ERR("op_code(%d) is not paged", op_code);
+		return CAL_ERR_ARG_INVALID;
+	}
+
+	key = LLONG_MIN;
+	id = 0;
+	if (token) {
+		r = cals_page_token_parse(token, &key, &id);
+		retvm_if(CAL_SUCCESS != r, r, "Invalid token(%s)", token);
+	}
+
+	/*
+	 * the page starts at the row after (key, id) and ends before etime,
+	 * dtstart_utime is bounded on both sides to seek on normal_inst_idx2
+	 */
+	snprintf(page, sizeof(page),
+			"AND A.dtstart_utime BETWEEN %lld AND %lld "
+			"AND (A.dtstart_utime > %lld OR A.event_id > %d)",
+			key, (stime < etime) ? etime : stime, key, id);
+	snprintf(order, sizeof(order), ", A.event_id LIMIT %d", limit);
+
+	r = _cals_event_get_normal_list(calendar_id, op_code, stime, etime, page, order, iter);
+	retv_if(CAL_SUCCESS != r, r);
+
+	(*iter)->page_limit = limit;
+	(*iter)->page_col = col;
+
+	return CAL_SUCCESS;
+}
+
 API int calendar_svc_event_get_allday_list_by_period(int calendar_id, int op_code,
 		int dtstart_year, int dtstart_month, int dtstart_mday,
 		int dtend_year, int dtend_month, int dtend_mday, cal_iter **iter)
@@ -343,6 +414,7 @@ API int calendar_svc_event_get_allday_list_by_period(int calendar_id, int op_cod
 	/* calendar_id -1 means searching all calendar */
 	retv_if(iter == NULL, CAL_ERR_ARG_NULL);
 
+	int r;
 	sqlite3_stmt *stmt = NULL;
 	char query[CALS_SQL_MIN_LEN] = {0};
 	char buf[64] = {0};
@@ -367,6 +439,12 @@ API int calendar_svc_event_get_allday_list_by_period(int calendar_id, int op_cod
 	snprintf(sdate, sizeof(sdate), "%4d%02d%02d", dtstart_year, dtstart_month, dtstart_mday);
 	snprintf(edate, sizeof(edate), "%4d%02d%02d", dtend_year, dtend_month, dtend_mday);
 
+	/* recurring instances are materialized on demand */
+	r = cals_instance_expand(calendar_id, CALS_TIME_LOCALTIME,
+			dtstart_year * 10000 + dtstart_month * 100 + dtstart_mday,
+			dtend_year * 10000 + dtend_month * 100 + dtend_mday);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_expand() Failed(%d)", r);
+
 	*iter = calloc(1, sizeof(cal_iter));
 	retvm_if(NULL == *iter, CAL_ERR_OUT_OF_MEMORY, "Failed to calloc(%d)", errno);
 	(*iter)->is_patched = 0;
@@ -467,6 +545,524 @@ API int calendar_svc_event_get_allday_list_by_period(int calendar_id, int op_cod
 	return CAL_SUCCESS;
 }
 
+struct cals_freebusy_list {
+	int cnt;
+	int size;
+	struct cals_freebusy *fb;
+};
+
+/* a merged interval has the strongest type of the busy times in it */
+static inline int _cals_freebusy_weight(int type)
+{
+	switch (type) {
+	case EVENT_BUSY_TENTATIVE_FB:
+		return 1;
+	case EVENT_BUSY_UNAVAILABLE_FB:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+static int _cals_freebusy_push(struct cals_freebusy_list *l, long long int start,
+		long long int end, int type)
+{
+	struct cals_freebusy *t;
+
+	if (EVENT_BUSY_TENTATIVE_FB != type && EVENT_BUSY_UNAVAILABLE_FB != type)
+		type = EVENT_BUSY_FB;
+
+	/* the intervals come in the order of the start */
+	if (l->cnt && start <= l->fb[l->cnt - 1].end) {
+		t = &l->fb[l->cnt - 1];
+		if (t->end < end)
+			t->end = end;
+		if (_cals_freebusy_weight(t->type) < _cals_freebusy_weight(type))
+			t->type = type;
+		return CAL_SUCCESS;
+	}
+
+	if (l->cnt == l->size) {
+		l->size = l->size ? l->size * 2 : 16;
+		t = realloc(l->fb, l->size * sizeof(struct cals_freebusy));
+		retvm_if(NULL == t, CAL_ERR_OUT_OF_MEMORY, "realloc() Failed");
+		l->fb = t;
+	}
+	l->fb[l->cnt].start = start;
+	l->fb[l->cnt].end = end;
+	l->fb[l->cnt].type = type;
+	l->cnt++;
+
+	return CAL_SUCCESS;
+}
+
+static int _cals_freebusy_cmp(const void *a, const void *b)
+{
+	const struct cals_freebusy *fa = a;
+	const struct cals_freebusy *fb = b;
+
+	if (fa->start == fb->start)
+		return 0;
+	return (fa->start < fb->start) ? -1 : 1;
+}
+
+/* all-day instances cover whole days of the tzid of the event */
+static int _cals_freebusy_get_allday(const char *cond, long long int stime, long long int etime,
+		int sdate, int edate, struct cals_freebusy_list *l)
+{
+	int r;
+	int y, m, d;
+	char query[CALS_SQL_MAX_LEN];
+	const char *tzid;
+	const char *datetime;
+	struct cals_freebusy *fb;
+	sqlite3_stmt *stmt;
+
+	snprintf(query, sizeof(query),
+			"SELECT A.dtstart_datetime, A.dtend_datetime, B.availability, B.dtstart_tzid "
+			"FROM %s as A, %s as B, %s as C "
+			"ON A.event_id = B.id AND B.calendar_id = C.rowid "
+			"WHERE A.dtstart_datetime <= %d AND A.dtend_datetime >= %d "
+			"AND B.type = %d AND B.is_deleted = 0 AND B.busy_status != 0 AND B.availability != %d %s",
+			CALS_TABLE_ALLDAY_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
+			edate, sdate, CALS_SCH_TYPE_EVENT, EVENT_FREE_FB, cond);
+
+	stmt = cals_query_prepare(query);
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+
+	while (CAL_TRUE == (r = cals_stmt_step(stmt))) {
+		if (l->cnt == l->size) {
+			l->size = l->size ? l->size * 2 : 16;
+			fb = realloc(l->fb, l->size * sizeof(struct cals_freebusy));
+			if (NULL == fb) {
+				ERR("realloc() Failed");
+				sqlite3_finalize(stmt);
+				return CAL_ERR_OUT_OF_MEMORY;
+			}
+			l->fb = fb;
+		}
+		fb = &l->fb[l->cnt];
+		tzid = (const char *)sqlite3_column_text(stmt, 3);
+
+		datetime = (const char *)sqlite3_column_text(stmt, 0);
+		if (NULL == datetime || 3 != sscanf(datetime, "%4d%2d%2d", &y, &m, &d))
+			continue;
+		fb->start = cals_time_date_to_utime(tzid, y, m, d, 0, 0, 0);
+
+		/* dtend_datetime is the last day */
+		datetime = (const char *)sqlite3_column_text(stmt, 1);
+		if (NULL == datetime || 3 != sscanf(datetime, "%4d%2d%2d", &y, &m, &d))
+			continue;
+		cals_recur_civil_from_days(cals_recur_days_from_civil(y, m, d) + 1, &y, &m, &d);
+		fb->end = cals_time_date_to_utime(tzid, y, m, d, 0, 0, 0);
+
+		fb->type = sqlite3_column_int(stmt, 2);
+		if (fb->start < etime && stime < fb->end)
+			l->cnt++;
+	}
+	sqlite3_finalize(stmt);
+	retvm_if(r < CAL_SUCCESS, r, "cals_stmt_step() Failed(%d)", r);
+
+	qsort(l->fb, l->cnt, sizeof(struct cals_freebusy), _cals_freebusy_cmp);
+
+	return CAL_SUCCESS;
+}
+
+/* a day of any timezone is in the dates a day before and after the utime */
+static inline int _cals_freebusy_get_date(long long int t, int days)
+{
+	int y, m, d;
+
+	cals_recur_civil_from_days(t / (24 * 60 * 60) + days, &y, &m, &d);
+	return y * 10000 + m * 100 + d;
+}
+
+static inline int _cals_freebusy_expand(int calendar_id, long long int stime, long long int etime,
+		int sdate, int edate)
+{
+	int r;
+
+	r = cals_instance_expand(calendar_id, CALS_TIME_UTIME, stime, etime);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_expand() Failed(%d)", r);
+	r = cals_instance_expand(calendar_id, CALS_TIME_LOCALTIME, sdate, edate);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_expand() Failed(%d)", r);
+
+	return CAL_SUCCESS;
+}
+
+static inline int _cals_freebusy_add(struct cals_freebusy_list *l, long long int start,
+		long long int end, int type, long long int stime, long long int etime, int granularity)
+{
+	/* instants do not take time */
+	if (end <= start)
+		return CAL_SUCCESS;
+
+	if (start < stime)
+		start = stime;
+	if (etime < end)
+		end = etime;
+
+	if (granularity) {
+		start = stime + (start - stime) / granularity * granularity;
+		end = stime + (end - stime + granularity - 1) / granularity * granularity;
+		if (etime < end)
+			end = etime;
+	}
+
+	return _cals_freebusy_push(l, start, end, type);
+}
+
+API int calendar_svc_get_freebusy(const int *calendar_ids, int calendar_cnt,
+		long long int stime, long long int etime, int granularity,
+		struct cals_freebusy **freebusy, int *count)
+{
+	int i, j;
+	int r;
+	int ret;
+	int len;
+	int sdate;
+	int edate;
+	char cond[CALS_SQL_MIN_LEN];
+	char query[CALS_SQL_MAX_LEN];
+	sqlite3_stmt *stmt;
+	struct cals_freebusy_list allday = {0};
+	struct cals_freebusy_list l = {0};
+	long long int start;
+
+	retv_if(NULL == freebusy, CAL_ERR_ARG_NULL);
+	retv_if(NULL == count, CAL_ERR_ARG_NULL);
+	retv_if(0 < calendar_cnt && NULL == calendar_ids, CAL_ERR_ARG_NULL);
+	retvm_if(etime <= stime, CAL_ERR_ARG_INVALID, "Invalid period(%lld ~ %lld)", stime, etime);
+	retvm_if(granularity < 0, CAL_ERR_ARG_INVALID, "Invalid granularity(%d)", granularity);
+
+	sdate = _cals_freebusy_get_date(stime, -1);
+	edate = _cals_freebusy_get_date(etime, 1);
+
+	/* all visible calendars, if no calendar is given */
+	if (calendar_cnt <= 0) {
+		snprintf(cond, sizeof(cond), "AND C.visibility = 1");
+		r = _cals_freebusy_expand(-1, stime, etime, sdate, edate);
+		retv_if(CAL_SUCCESS != r, r);
+	} else {
+		len = snprintf(cond, sizeof(cond), "AND B.calendar_id IN (");
+		for (i = 0; i < calendar_cnt && len < sizeof(cond); i++) {
+			len += snprintf(cond + len, sizeof(cond) - len, "%s%d", i ? "," : "", calendar_ids[i]);
+			r = _cals_freebusy_expand(calendar_ids[i], stime, etime, sdate, edate);
+			retv_if(CAL_SUCCESS != r, r);
+		}
+		retvm_if(sizeof(cond) - 1 <= len, CAL_ERR_ARG_INVALID, "Too many calendars(%d)", calendar_cnt);
+		snprintf(cond + len, sizeof(cond) - len, ")");
+	}
+
+	r = _cals_freebusy_get_allday(cond, stime, etime, sdate, edate, &allday);
+	retvm_if(CAL_SUCCESS != r, r, "_cals_freebusy_get_allday() Failed(%d)", r);
+
+	snprintf(query, sizeof(query),
+			"SELECT A.dtstart_utime, A.dtend_utime, B.availability "
+			"FROM %s as A, %s as B, %s as C "
+			"ON A.event_id = B.id AND B.calendar_id = C.rowid "
+			"WHERE A.dtstart_utime < %lld AND A.dtend_utime > %lld "
+			"AND B.type = %d AND B.is_deleted = 0 AND B.busy_status != 0 AND B.availability != %d %s "
+			"ORDER BY A.dtstart_utime",
+			CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
+			etime, stime, CALS_SCH_TYPE_EVENT, EVENT_FREE_FB, cond);
+
+	stmt = cals_query_prepare(query);
+	if (NULL == stmt) {
+		ERR("cals_query_prepare() Failed");
+		free(allday.fb);
+		return CAL_ERR_DB_FAILED;
+	}
+
+	/* both are in the order of the start, so they are merged in one pass */
+	j = 0;
+	ret = CAL_SUCCESS;
+	while (CAL_TRUE == (r = cals_stmt_step(stmt))) {
+		start = sqlite3_column_int64(stmt, 0);
+		for (; CAL_SUCCESS == ret && j < allday.cnt && allday.fb[j].start < start; j++)
+			ret = _cals_freebusy_add(&l, allday.fb[j].start, allday.fb[j].end, allday.fb[j].type,
+					stime, etime, granularity);
+		if (CAL_SUCCESS != ret)
+			break;
+
+		ret = _cals_freebusy_add(&l, start, sqlite3_column_int64(stmt, 1), sqlite3_column_int(stmt, 2),
+				stime, etime, granularity);
+		if (CAL_SUCCESS != ret)
+			break;
+	}
+	for (; CAL_SUCCESS == ret && j < allday.cnt; j++)
+		ret = _cals_freebusy_add(&l, allday.fb[j].start, allday.fb[j].end, allday.fb[j].type,
+				stime, etime, granularity);
+	sqlite3_finalize(stmt);
+	free(allday.fb);
+
+	if (CAL_SUCCESS != ret || r < CAL_SUCCESS) {
+		ERR("Failed to merge the busy time(%d, %d)", ret, r);
+		free(l.fb);
+		return (CAL_SUCCESS != ret) ? ret : r;
+	}
+
+	*freebusy = l.fb;
+	*count = l.cnt;
+
+	return CAL_SUCCESS;
+}
+
+static int _cals_conflict_push(struct cals_conflict **conflicts, int *cnt, int *size,
+		int event_id, long long int start, long long int end)
+{
+	struct cals_conflict *t;
+
+	if (*cnt == *size) {
+		*size = *size ? *size * 2 : 16;
+		t = realloc(*conflicts, *size * sizeof(struct cals_conflict));
+		retvm_if(NULL == t, CAL_ERR_OUT_OF_MEMORY, "realloc() Failed");
+		*conflicts = t;
+	}
+	(*conflicts)[*cnt].event_id = event_id;
+	(*conflicts)[*cnt].start = start;
+	(*conflicts)[*cnt].end = end;
+	(*cnt)++;
+
+	return CAL_SUCCESS;
+}
+
+/*
+ * Instances of the candidate are made in memory and swept with the stored ones.
+ * Both are in the order of the start, and the candidate instances have the same
+ * duration, so the ones ending before a stored instance are never looked at again.
+ */
+API int calendar_svc_event_find_conflicts(cal_struct *candidate,
+		long long int stime, long long int etime,
+		struct cals_conflict **conflicts, int *count)
+{
+	int i;
+	int r;
+	int ret;
+	int type;
+	int size;
+	int inst_cnt;
+	int event_id;
+	long long int qs;
+	long long int qe;
+	long long int start;
+	long long int end;
+	char query[CALS_SQL_MAX_LEN];
+	sqlite3_stmt *stmt;
+	cal_sch_full_t *sch;
+	struct inst_row *inst;
+	struct cals_conflict *l;
+
+	retv_if(NULL == candidate, CAL_ERR_ARG_NULL);
+	retv_if(NULL == conflicts, CAL_ERR_ARG_NULL);
+	retv_if(NULL == count, CAL_ERR_ARG_NULL);
+	retvm_if(CAL_STRUCT_TYPE_SCHEDULE != candidate->event_type, CAL_ERR_ARG_INVALID,
+			"Invalid struct type(%d)", candidate->event_type);
+	retvm_if(etime <= stime, CAL_ERR_ARG_INVALID, "Invalid period(%lld ~ %lld)", stime, etime);
+
+	sch = candidate->user_data;
+	retv_if(NULL == sch, CAL_ERR_ARG_INVALID);
+
+	type = sch->dtstart_type;
+	if (CALS_TIME_UTIME == type) {
+		qs = stime;
+		qe = etime;
+	} else {
+		qs = _cals_freebusy_get_date(stime, 0);
+		qe = _cals_freebusy_get_date(etime, 0);
+	}
+
+	ret = cals_instance_get(sch, qs, qe, &inst, &inst_cnt);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_instance_get() Failed(%d)", ret);
+
+	*conflicts = NULL;
+	*count = 0;
+	if (0 == inst_cnt) {
+		free(inst);
+		return CAL_SUCCESS;
+	}
+
+	/* stored instances are compared only in the span of the candidate ones */
+	qs = inst[0].start;
+	qe = inst[inst_cnt - 1].end;
+	r = cals_instance_expand(-1, type, qs, qe);
+	if (CAL_SUCCESS != r) {
+		ERR("cals_instance_expand() Failed(%d)", r);
+		free(inst);
+		return r;
+	}
+
+	if (CALS_TIME_UTIME == type)
+		snprintf(query, sizeof(query),
+				"SELECT A.event_id, A.dtstart_utime, A.dtend_utime "
+				"FROM %s as A, %s as B, %s as C "
+				"ON A.event_id = B.id AND B.calendar_id = C.rowid "
+				"WHERE A.dtstart_utime < %lld AND A.dtend_utime > %lld "
+				"AND B.type = %d AND B.is_deleted = 0 AND B.busy_status != 0 "
+				"AND C.visibility = 1 AND A.event_id != %d "
+				"ORDER BY A.dtstart_utime",
+				CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
+				qe, qs, CALS_SCH_TYPE_EVENT, sch->index);
+	else
+		snprintf(query, sizeof(query),
+				"SELECT A.event_id, A.dtstart_datetime, A.dtend_datetime "
+				"FROM %s as A, %s as B, %s as C "
+				"ON A.event_id = B.id AND B.calendar_id = C.rowid "
+				"WHERE A.dtstart_datetime <= %lld AND A.dtend_datetime >= %lld "
+				"AND B.type = %d AND B.is_deleted = 0 AND B.busy_status != 0 "
+				"AND C.visibility = 1 AND A.event_id != %d "
+				"ORDER BY A.dtstart_datetime",
+				CALS_TABLE_ALLDAY_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
+				qe, qs, CALS_SCH_TYPE_EVENT, sch->index);
+
+	stmt = cals_query_prepare(query);
+	if (NULL == stmt) {
+		ERR("cals_query_prepare() Failed");
+		free(inst);
+		return CAL_ERR_DB_FAILED;
+	}
+
+	l = NULL;
+	size = 0;
+	i = 0;
+	while (CAL_TRUE == (r = cals_stmt_step(stmt))) {
+		event_id = sqlite3_column_int(stmt, 0);
+		start = sqlite3_column_int64(stmt, 1);
+		end = sqlite3_column_int64(stmt, 2);
+
+		/* the first candidate not ending before it has the earliest start of the rest */
+		if (CALS_TIME_UTIME == type) {
+			while (i < inst_cnt && inst[i].end <= start)
+				i++;
+			if (inst_cnt <= i || end <= inst[i].start)
+				continue;
+		} else {
+			/* dates of all-day instances are inclusive */
+			while (i < inst_cnt && inst[i].end < start)
+				i++;
+			if (inst_cnt <= i || end < inst[i].start)
+				continue;
+		}
+
+		ret = _cals_conflict_push(&l, count, &size, event_id, start, end);
+		if (CAL_SUCCESS != ret)
+			break;
+	}
+	sqlite3_finalize(stmt);
+	free(inst);
+
+	if (CAL_SUCCESS != ret || r < CAL_SUCCESS) {
+		ERR("Failed to find conflicts(%d, %d)", ret, r);
+		free(l);
+		*count = 0;
+		return (CAL_SUCCESS != ret) ? ret : r;
+	}
+
+	*conflicts = l;
+
+	return CAL_SUCCESS;
+}
+
+/* counts are bucketed by the days of the tzid, bound[i] is the start of the (i + 1)th day */
+API int calendar_svc_event_get_day_counts(int calendar_id, int year, int month,
+		const char *tzid, int counts[31])
+{
+	int i;
+	int r;
+	int y, m, d;
+	int days;
+	int sdate;
+	int edate;
+	long long int first;
+	long long int start;
+	long long int end;
+	long long int bound[32];
+	char cond[64];
+	char query[CALS_SQL_MAX_LEN];
+	sqlite3_stmt *stmt;
+
+	retv_if(NULL == counts, CAL_ERR_ARG_NULL);
+	retvm_if(month < 1 || 12 < month, CAL_ERR_ARG_INVALID, "Invalid month(%d)", month);
+	retvm_if(year < CALS_RECUR_MIN_YEAR, CAL_ERR_ARG_INVALID, "Invalid year(%d)", year);
+
+	first = cals_recur_days_from_civil(year, month, 1);
+	days = (12 == month) ? cals_recur_days_from_civil(year + 1, 1, 1) - first
+		: cals_recur_days_from_civil(year, month + 1, 1) - first;
+
+	for (i = 0; i <= days; i++) {
+		cals_recur_civil_from_days(first + i, &y, &m, &d);
+		bound[i] = cals_time_date_to_utime(tzid, y, m, d, 0, 0, 0);
+	}
+	sdate = year * 10000 + month * 100 + 1;
+	edate = year * 10000 + month * 100 + days;
+
+	memset(counts, 0, 31 * sizeof(int));
+
+	if (calendar_id > 0)
+		snprintf(cond, sizeof(cond), "AND B.calendar_id = %d", calendar_id);
+	else
+		cond[0] = '\0';
+
+	r = cals_instance_expand(calendar_id, CALS_TIME_UTIME, bound[0], bound[days]);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_expand() Failed(%d)", r);
+	r = cals_instance_expand(calendar_id, CALS_TIME_LOCALTIME, sdate, edate);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_expand() Failed(%d)", r);
+
+	snprintf(query, sizeof(query),
+			"SELECT A.dtstart_utime, A.dtend_utime "
+			"FROM %s as A, %s as B, %s as C "
+			"ON A.event_id = B.id AND B.calendar_id = C.rowid "
+			"WHERE A.dtstart_utime < %lld AND A.dtend_utime >= %lld "
+			"AND B.type = %d AND B.is_deleted = 0 AND C.visibility = 1 %s",
+			CALS_TABLE_NORMAL_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
+			bound[days], bound[0], CALS_SCH_TYPE_EVENT, cond);
+
+	stmt = cals_query_prepare(query);
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+
+	while (CAL_TRUE == (r = cals_stmt_step(stmt))) {
+		start = sqlite3_column_int64(stmt, 0);
+		end = sqlite3_column_int64(stmt, 1);
+
+		/* an instant is on the day of its start */
+		if (end <= start)
+			end = start + 1;
+
+		for (i = 0; i < days && bound[i + 1] <= start; i++);
+		for (; i < days && bound[i] < end; i++)
+			counts[i]++;
+	}
+	sqlite3_finalize(stmt);
+	retvm_if(r < CAL_SUCCESS, r, "cals_stmt_step() Failed(%d)", r);
+
+	snprintf(query, sizeof(query),
+			"SELECT A.dtstart_datetime, A.dtend_datetime "
+			"FROM %s as A, %s as B, %s as C "
+			"ON A.event_id = B.id AND B.calendar_id = C.rowid "
+			"WHERE A.dtstart_datetime <= %d AND A.dtend_datetime >= %d "
+			"AND B.type = %d AND B.is_deleted = 0 AND C.visibility = 1 %s",
+			CALS_TABLE_ALLDAY_INSTANCE, CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR,
+			edate, sdate, CALS_SCH_TYPE_EVENT, cond);
+
+	stmt = cals_query_prepare(query);
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+
+	/* YYYYMMDD of the month is sdate + day - 1, and the dates are inclusive */
+	while (CAL_TRUE == (r = cals_stmt_step(stmt))) {
+		start = sqlite3_column_int64(stmt, 0);
+		end = sqlite3_column_int64(stmt, 1);
+		if (end < start)
+			end = start;
+
+		for (i = (sdate < start) ? start - sdate : 0; i < days && sdate + i <= end; i++)
+			counts[i]++;
+	}
+	sqlite3_finalize(stmt);
+	retvm_if(r < CAL_SUCCESS, r, "cals_stmt_step() Failed(%d)", r);
+
+	return CAL_SUCCESS;
+}
+
 /* delete instance from instance_table and update exdate from schedule_table */
 API int calendar_svc_event_delete_normal_instance(int event_id, long long int dtstart_utime)
 {
@@ -26,6 +26,10 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <ctype.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "cals-typedef.h"
 #include "cals-ical.h"
@@ -37,8 +41,6 @@
 #include "cals-utils.h"
 #include "cals-time.h"
 
-#define ICALENAR_BUFFER_MAX (1024*1024)
-
 
 enum {
 	ENCODE_NONE = 0x0,
@@ -363,6 +365,237 @@ struct _val_func _optional_list[TEXT_MAX] =
 	{ "ENCODING=", cals_func_encoding },
 };
 
+/*
+ * Name dispatch of the tables above.
+ * Candidate is picked by the length and a few characters of the name,
+ * then verified by one compare, instead of strncmp() with every entry.
+ * Functions return the index of the table, or -1.
+ */
+static inline int _cals_ical_match(const char *name, const char *key)
+{
+	return !strncasecmp(name, key, strlen(key));
+}
+
+/* length of "KEY=" at p, 0 if p does not start with a parameter */
+static inline int _cals_ical_key_len(const char *p)
+{
+	int n = 0;
+
+	while (p[n] && '=' != p[n] && ';' != p[n] && ':' != p[n])
+		n++;
+	return '=' == p[n] ? n + 1 : 0;
+}
+
+static int _cals_ical_vcal_idx(const char *prop)
+{
+	int idx = -1;
+
+	switch (strlen(prop)) {
+	case 6:
+		idx = VCAL_PRODID;
+		break;
+	case 7:
+		idx = VCAL_VERSION;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(prop, _vcal_list[idx].prop)) ? idx : -1;
+}
+
+static int _cals_ical_veve_idx(const char *prop)
+{
+	int idx = -1;
+
+	switch (strlen(prop)) {
+	case 5:
+		idx = ('R' == toupper(prop[0])) ? VEVE_RRULE : VEVE_DTEND;
+		break;
+	case 6:
+		idx = ('S' == toupper(prop[0])) ? VEVE_STATUS : VEVE_AALARM;
+		break;
+	case 7:
+		switch (toupper(prop[0])) {
+		case 'C':
+			idx = VEVE_CREATED;
+			break;
+		case 'S':
+			idx = VEVE_SUMMARY;
+			break;
+		case 'D':
+			idx = ('M' == toupper(prop[5])) ? VEVE_DTSTAMP : VEVE_DTSTART;
+			break;
+		}
+		break;
+	case 8:
+		switch (toupper(prop[0])) {
+		case 'L':
+			idx = ('A' == toupper(prop[1])) ? VEVE_LAST_MOD : VEVE_LOCATION;
+			break;
+		case 'P':
+			idx = VEVE_PRIORITY;
+			break;
+		case 'A':
+			idx = VEVE_ATTENDEE;
+			break;
+		}
+		break;
+	case 10:
+		idx = VEVE_CATEGORIES;
+		break;
+	case 11:
+		idx = VEVE_DESCRIPTION;
+		break;
+	case 13: /* LAST-MODIFIED */
+		idx = VEVE_LAST_MOD;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(prop, _veve_list[idx].prop)) ? idx : -1;
+}
+
+static int _cals_ical_vala_idx(const char *prop)
+{
+	int idx = -1;
+
+	switch (strlen(prop)) {
+	case 6:
+		if ('R' == toupper(prop[0]))
+			idx = VALA_REPEAT;
+		else
+			idx = ('C' == toupper(prop[1])) ? VALA_ACTION : VALA_ATTACH;
+		break;
+	case 7:
+		idx = ('T' == toupper(prop[0])) ? VALA_TRIGGER : VALA_SUMMARY;
+		break;
+	case 8:
+		idx = VALA_DURATION;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(prop, _vala_list[idx].prop)) ? idx : -1;
+}
+
+static int _cals_ical_rrule_idx(const char *p)
+{
+	int idx = -1;
+
+	switch (_cals_ical_key_len(p)) {
+	case 5:
+		idx = ('F' == toupper(p[0])) ? RRULE_FREQ : RRULE_WKST;
+		break;
+	case 6:
+		switch (toupper(p[0])) {
+		case 'U':
+			idx = RRULE_UNTIL;
+			break;
+		case 'C':
+			idx = RRULE_COUNT;
+			break;
+		case 'B':
+			idx = RRULE_BYDAY;
+			break;
+		}
+		break;
+	case 7:
+		idx = RRULE_BYHOUR;
+		break;
+	case 8:
+		idx = RRULE_BYMONTH;
+		break;
+	case 9:
+		if ('I' == toupper(p[0])) {
+			idx = RRULE_INTERVAL;
+			break;
+		}
+		switch (toupper(p[2])) {
+		case 'S':
+			idx = ('C' == toupper(p[4])) ? RRULE_BYSECOND : RRULE_BYSETPOS;
+			break;
+		case 'M':
+			idx = RRULE_BYMINUTE;
+			break;
+		case 'W':
+			idx = RRULE_BYWEEKNO;
+			break;
+		}
+		break;
+	case 10:
+		idx = RRULE_BYYEARDAY;
+		break;
+	case 11:
+		idx = RRULE_BYMONTHDAY;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(p, _rrule_list[idx].prop)) ? idx : -1;
+}
+
+static int _cals_ical_attendee_idx(const char *p)
+{
+	int idx = -1;
+
+	switch (_cals_ical_key_len(p)) {
+	case 3:
+		idx = ATTENDEE_CN;
+		break;
+	case 4:
+		idx = ATTENDEE_DIR;
+		break;
+	case 5:
+		idx = ('O' == toupper(p[1])) ? ATTENDEE_ROLE : ATTENDEE_RSVP;
+		break;
+	case 6:
+		idx = ATTENDEE_DELTO;
+		break;
+	case 7:
+		switch (toupper(p[0])) {
+		case 'C':
+			idx = ATTENDEE_CUTYPE;
+			break;
+		case 'M':
+			idx = ATTENDEE_MEMBER;
+			break;
+		case 'S':
+			idx = ATTENDEE_SENTBY;
+			break;
+		}
+		break;
+	case 8:
+		idx = ATTENDEE_DELFROM;
+		break;
+	case 9:
+		idx = ATTENDEE_PARTSTAT;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(p, _attendee_list[idx].prop)) ? idx : -1;
+}
+
+static int _cals_ical_trig_idx(const char *p)
+{
+	int idx = -1;
+
+	switch (_cals_ical_key_len(p)) {
+	case 6:
+		idx = TRIG_VALUE;
+		break;
+	case 8:
+		idx = TRIG_RELATED;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(p, _trig_list[idx].prop)) ? idx : -1;
+}
+
+static int _cals_ical_text_idx(const char *p)
+{
+	int idx = -1;
+
+	switch (_cals_ical_key_len(p)) {
+	case 8:
+		idx = TEXT_CHARSET;
+		break;
+	case 9:
+		idx = TEXT_ENCODING;
+		break;
+	}
+	return (0 <= idx && _cals_ical_match(p, _optional_list[idx].prop)) ? idx : -1;
+}
+
 char *cals_convert_sec_from_duration(char *p, int *dur_t, char *dur);
 
 //util //////////////////////////////////////////////////////////////////////
@@ -617,29 +850,25 @@ char *cals_read_line(char *stream, char **prop, char **cont)
 	return p;
 }
 
-inline void cals_get_optional_parameter(char *p, int *encoding)
+static inline void cals_get_optional_parameter(char *p, int *encoding)
 {
 	int i;
 
-	for (i = 0; i < TEXT_MAX; i++) {
-		if (!strncmp(p, _optional_list[i].prop, strlen(_optional_list[i].prop))) {
-			int j = 0;
-			char buf[64] = {0, };
-			p += strlen(_optional_list[i].prop);
-			while (p[j] != ':' && p[j] != ';' && p[j] != '\n' && p[j] != '\0') {
-				buf[j] = p[j];
-				j++;
-			}
-			if (p[j] != '\0') {
-				buf[j] = '\0';
-			}
-
-			p += j;
-			_optional_list[i].func(encoding, buf);
-			break;
-		} else {
-
+	i = _cals_ical_text_idx(p);
+	if (0 <= i) {
+		int j = 0;
+		char buf[64] = {0, };
+		p += strlen(_optional_list[i].prop);
+		while (p[j] != ':' && p[j] != ';' && p[j] != '\n' && p[j] != '\0') {
+			buf[j] = p[j];
+			j++;
 		}
+		if (p[j] != '\0') {
+			buf[j] = '\0';
+		}
+
+		p += j;
+		_optional_list[i].func(encoding, buf);
 	}
 }
 
@@ -681,162 +910,724 @@ API int calendar_svc_read_schedules(const char *stream, GList **schedules)
 	*schedules = l;
 	return ret;
 }
-#ifndef CALS_IPC_CLIENT
-int cals_do_importing(int calendar_id, char *stream, void *data)
+/*
+ * Streaming reader of the mmap'ed ics file.
+ * Physical lines are unfolded lazily into the line buffer,
+ * which holds "NAME\0" followed by ";params:value\0" as prop and cont.
+ * Handlers may decode cont in place, so the buffer is writable and reused.
+ */
+struct cals_ical_reader {
+	const char *base;
+	const char *cursor;
+	const char *end;
+	const char *released;
+	char *line;
+	int size;
+	char *prop;
+	char *cont;
+};
+
+static int _cals_ical_reader_append(struct cals_ical_reader *r, int len,
+		const char *src, int src_len)
+{
+	char *new_line;
+	int new_size;
+
+	if (r->size < len + src_len + 2) {
+		new_size = r->size ? r->size : 256;
+		while (new_size < len + src_len + 2)
+			new_size *= 2;
+		new_line = realloc(r->line, new_size);
+		retvm_if(NULL == new_line, CAL_ERR_OUT_OF_MEMORY, "realloc() Failed");
+		r->line = new_line;
+		r->size = new_size;
+	}
+	/* line is built from line[1], see _cals_ical_reader_next() */
+	memcpy(r->line + 1 + len, src, src_len);
+
+	return CAL_SUCCESS;
+}
+
+/* how a line goes on to the next physical line */
+enum {
+	CALS_ICAL_UNFOLDED,
+	CALS_ICAL_FOLDED, /* the next one starts with a white space */
+	CALS_ICAL_SOFT_BREAK, /* '=' at the end of quoted-printable of vCalendar 1.0 */
+};
+
+static bool _cals_ical_is_qp(const char *line, int len)
+{
+	const char *p, *e;
+	const int n = sizeof("QUOTED-PRINTABLE") - 1;
+
+	/* encoding is one of the parameters, before the value */
+	e = memchr(line, ':', len);
+	if (NULL == e)
+		e = line + len;
+	for (p = line; p + n <= e; p++) {
+		if (!strncasecmp(p, "QUOTED-PRINTABLE", n))
+			return true;
+	}
+	return false;
+}
+
+static inline int _cals_ical_get_fold(const char *line, int len,
+		const char *next, const char *end)
+{
+	if (end <= next)
+		return CALS_ICAL_UNFOLDED;
+	/* white space after a soft line break is the value */
+	if (0 < len && '=' == line[len - 1] && _cals_ical_is_qp(line, len))
+		return CALS_ICAL_SOFT_BREAK;
+	if (' ' == *next || '\t' == *next)
+		return CALS_ICAL_FOLDED;
+	return CALS_ICAL_UNFOLDED;
+}
+
+/* end of the physical line from s, the cursor is moved to the next one */
+static inline const char *_cals_ical_get_line_end(struct cals_ical_reader *r,
+		const char *s)
+{
+	const char *nl, *e;
+
+	nl = memchr(s, '\n', r->end - s);
+	e = nl ? nl : r->end;
+	r->cursor = nl ? nl + 1 : r->end;
+	if (s < e && '\r' == *(e - 1))
+		e--;
+
+	return e;
+}
+
+/*
+ * Unfolded line at the cursor, without the line breaks of folding
+ * and the soft ones of quoted-printable.
+ * It is copied to the line buffer only when it is continued.
+ * returns CAL_TRUE when a line is read, CAL_SUCCESS at the end of data
+ */
+static int _cals_ical_scan_line(struct cals_ical_reader *r,
+		const char **line, int *len)
 {
 	int ret;
-	GList *list_sch = NULL;
-	GList *l;
+	int fold;
+	const char *s, *e;
+
+	if (r->end <= r->cursor)
+		return CAL_SUCCESS;
+
+	*line = r->cursor;
+	*len = _cals_ical_get_line_end(r, *line) - *line;
+
+	while (CALS_ICAL_UNFOLDED != (fold = _cals_ical_get_fold(*line, *len, r->cursor, r->end))) {
+		if (CALS_ICAL_SOFT_BREAK == fold) {
+			(*len)--;
+			s = r->cursor;
+		} else {
+			s = r->cursor + 1;
+		}
+		e = _cals_ical_get_line_end(r, s);
+
+		/* line is built from line[1], see _cals_ical_reader_next() */
+		if (*line != r->line + 1) {
+			ret = _cals_ical_reader_append(r, 0, *line, *len);
+			retv_if(CAL_SUCCESS != ret, ret);
+		}
+		ret = _cals_ical_reader_append(r, *len, s, e - s);
+		retv_if(CAL_SUCCESS != ret, ret);
+		*line = r->line + 1;
+		*len += e - s;
+	}
+
+	return CAL_TRUE;
+}
+
+/* returns CAL_TRUE when a line is read, CAL_SUCCESS at the end of data */
+static int _cals_ical_reader_next(struct cals_ical_reader *r)
+{
+	int ret;
+	int len, name_len;
+	const char *s, *line;
+	char *sep;
+
+	while (r->cursor < r->end && ('\r' == *r->cursor || '\n' == *r->cursor))
+		r->cursor++;
+
+	ret = _cals_ical_scan_line(r, &line, &len);
+	if (CAL_TRUE != ret)
+		return ret;
+	if (line != r->line + 1) {
+		ret = _cals_ical_reader_append(r, 0, line, len);
+		retv_if(CAL_SUCCESS != ret, ret);
+	}
+	r->line[1 + len] = '\0';
+
+	sep = r->line + 1;
+	while (' ' == *sep)
+		sep++;
+	s = sep;
+	while (*sep && ';' != *sep && ':' != *sep)
+		sep++;
+
+	/* move the name in front of the separator to make a room for '\0' */
+	name_len = sep - s;
+	memmove(r->line, s, name_len);
+	r->line[name_len] = '\0';
+	r->prop = r->line;
+	r->cont = sep;
+
+	return CAL_TRUE;
+}
+
+/* gives back the pages already parsed, so that memory is bounded by a component */
+static void _cals_ical_reader_release(struct cals_ical_reader *r)
+{
+	long page;
+	const char *upto;
+
+	page = sysconf(_SC_PAGESIZE);
+	upto = r->base + ((r->cursor - r->base) / page) * page;
+	if (r->released < upto) {
+		madvise((void *)r->released, upto - r->released, MADV_DONTNEED);
+		r->released = upto;
+	}
+}
+
+static int _cals_ical_skip_comp(struct cals_ical_reader *r)
+{
+	int ret;
+	int depth = 1;
+
+	while (CAL_TRUE == (ret = _cals_ical_reader_next(r))) {
+		if (!strcasecmp(r->prop, "BEGIN"))
+			depth++;
+		else if (!strcasecmp(r->prop, "END") && 0 == --depth)
+			return CAL_SUCCESS;
+	}
+	return ret < 0 ? ret : CAL_ERR_VOBJECT_FAILED;
+}
+
+static int _cals_ical_parse_alarm(struct cals_ical_reader *r, cal_sch_full_t *sch)
+{
+	int i, ret;
+	cal_value *val;
+
+	val = calendar_svc_value_new(CAL_VALUE_LST_ALARM);
+	retvm_if(NULL == val, CAL_ERR_OUT_OF_MEMORY, "calendar_svc_value_new() Failed");
+	sch->alarm_list = g_list_append(sch->alarm_list, val);
+
+	while (CAL_TRUE == (ret = _cals_ical_reader_next(r))) {
+		if (!strcasecmp(r->prop, "BEGIN")) {
+			ret = _cals_ical_skip_comp(r);
+			retv_if(CAL_SUCCESS != ret, ret);
+			continue;
+		} else if (!strcasecmp(r->prop, "END")) {
+			return CAL_SUCCESS;
+		}
+
+		i = _cals_ical_vala_idx(r->prop);
+		if (0 <= i)
+			_vala_list[i].func(sch, r->cont);
+	}
+	return ret < 0 ? ret : CAL_ERR_VOBJECT_FAILED;
+}
+
+static int _cals_ical_parse_comp(struct cals_ical_reader *r, int ver, bool is_todo,
+		cal_struct **out)
+{
+	int i, ret;
 	cal_struct *cs;
 	cal_sch_full_t *sch;
 
-	ret = calendar_svc_read_schedules(stream, &list_sch);
-	retvm_if(ret < 0, ret, "Failed to parse(%d)", ret);
+	cs = calendar_svc_struct_new(is_todo ? CAL_STRUCT_TODO : CAL_STRUCT_SCHEDULE);
+	retvm_if(NULL == cs, CAL_ERR_OUT_OF_MEMORY, "calendar_svc_struct_new() Failed");
+	sch = cs->user_data;
+
+	while (CAL_TRUE == (ret = _cals_ical_reader_next(r))) {
+		if (!strcasecmp(r->prop, "BEGIN")) {
+			if (!strncmp(r->cont + 1, "VALARM", strlen("VALARM")))
+				ret = _cals_ical_parse_alarm(r, sch);
+			else
+				ret = _cals_ical_skip_comp(r);
+			if (CAL_SUCCESS != ret)
+				break;
+		} else if (!strcasecmp(r->prop, "END")) {
+			*out = cs;
+			return CAL_SUCCESS;
+		} else {
+			i = _cals_ical_veve_idx(r->prop);
+			if (0 <= i)
+				_veve_list[i].func(ver, sch, r->cont);
+		}
+	}
+	calendar_svc_struct_free(&cs);
+
+	if (CAL_TRUE == ret || CAL_SUCCESS == ret)
+		ret = CAL_ERR_VOBJECT_FAILED;
+	ERR("Failed to parse component(%d)", ret);
+	return ret;
+}
+
+/* map is NULL for an empty file */
+static int _cals_ical_map(const char *path, void **map, size_t *size)
+{
+	int fd, ret;
+	struct stat st;
+
+	*map = NULL;
+	*size = 0;
+
+	fd = open(path, O_RDONLY);
+	retvm_if(fd < 0, CAL_ERR_IO_ERR, "open(%s) Failed(%d)", path, errno);
+
+	ret = fstat(fd, &st);
+	if (ret < 0 || 0 == st.st_size) {
+		close(fd);
+		retvm_if(ret < 0, CAL_ERR_IO_ERR, "fstat(%s) Failed(%d)", path, errno);
+		return CAL_SUCCESS;
+	}
+
+	*map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == *map) {
+		*map = NULL;
+		ERR("mmap(%s) Failed(%d)", path, errno);
+		return CAL_ERR_IO_ERR;
+	}
+	madvise(*map, st.st_size, MADV_SEQUENTIAL);
+	*size = st.st_size;
+
+	return CAL_SUCCESS;
+}
+
+int cals_ical_parse_file(const char *path, cals_ical_cb cb, void *data)
+{
+	CALS_FN_CALL;
+	int ret;
+	int ver = -1;
+	void *map;
+	size_t size;
+	cal_struct *cs;
+	struct cals_ical_reader r = {0};
+
+	retv_if(NULL == path, CAL_ERR_ARG_NULL);
+	retv_if(NULL == cb, CAL_ERR_ARG_NULL);
+
+	ret = _cals_ical_map(path, &map, &size);
+	retv_if(CAL_SUCCESS != ret, ret);
+	if (NULL == map)
+		return CAL_SUCCESS;
+
+	r.base = map;
+	r.cursor = map;
+	r.released = map;
+	r.end = r.base + size;
+
+	while (CAL_TRUE == (ret = _cals_ical_reader_next(&r))) {
+		if (!strcasecmp(r.prop, "BEGIN")) {
+			if (!strncmp(r.cont + 1, "VCALENDAR", strlen("VCALENDAR"))) {
+				ver = -1;
+				continue;
+			} else if (!strncmp(r.cont + 1, "VEVENT", strlen("VEVENT"))) {
+				ret = _cals_ical_parse_comp(&r, ver, false, &cs);
+			} else if (!strncmp(r.cont + 1, "VTODO", strlen("VTODO"))) {
+				ret = _cals_ical_parse_comp(&r, ver, true, &cs);
+			} else {
+				ret = _cals_ical_skip_comp(&r);
+				if (CAL_SUCCESS != ret)
+					break;
+				continue;
+			}
+			if (CAL_SUCCESS != ret)
+				break;
+
+			ret = cb(cs, data);
+			if (CAL_SUCCESS != ret)
+				break;
+			_cals_ical_reader_release(&r);
+
+		} else if (VCAL_VERSION == _cals_ical_vcal_idx(r.prop)) {
+			ver = _vcal_list[VCAL_VERSION].func(NULL, r.cont);
+		}
+	}
+
+	munmap(map, size);
+	free(r.line);
+
+	return ret;
+}
+
+/*
+ * Parallel parsing.
+ * The writer thread finds the boundaries of top level VEVENT/VTODO
+ * copying only the lines continued, and workers parse the slices of a window.
+ * Parsed records are given to cb in the order of the file,
+ * on the calling thread, so cb may use the DB connection.
+ */
+#define CALS_ICAL_WORKERS_MAX 16
+#define CALS_ICAL_WINDOW_PER_WORKER 16
+
+struct cals_ical_slice {
+	const char *start;
+	const char *end;
+	int ver;
+	bool is_todo;
+	bool is_done;
+	int ret;
+	cal_struct *cs;
+};
+
+struct cals_ical_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	struct cals_ical_slice *slices;
+	int cnt;
+	int next;
+	bool quit;
+};
+
+static inline bool _cals_ical_line_is(const char *line, int len, const char *word)
+{
+	int n = strlen(word);
 
-	/* calendar id validation check */
+	return n <= len && !strncasecmp(line, word, n);
+}
+
+/* finds the next VEVENT or VTODO, returns CAL_TRUE when found */
+static int _cals_ical_scan_comp(struct cals_ical_reader *r, int *ver,
+		struct cals_ical_slice *s)
+{
+	int ret;
+	int len;
+	int depth;
+	bool is_event, is_todo;
+	char buf[16];
+	const char *line;
+
+	while (CAL_TRUE == (ret = _cals_ical_scan_line(r, &line, &len))) {
+		if (_cals_ical_line_is(line, len, "VERSION:")) {
+			snprintf(buf, sizeof(buf), "%.*s", len - 7, line + 7);
+			*ver = _vcal_list[VCAL_VERSION].func(NULL, buf);
+			continue;
+		}
+		if (!_cals_ical_line_is(line, len, "BEGIN:"))
+			continue;
 
-	/* insert schedules to db */
-	l = list_sch;
-	while (l) {
-		sch = (cal_sch_full_t *)((cal_struct *)l->data)->user_data;
-		if (sch) {
-			sch->calendar_id = calendar_id;
-			ret = cals_insert_schedule(sch);
+		if (_cals_ical_line_is(line + 6, len - 6, "VCALENDAR")) {
+			*ver = -1;
+			continue;
 		}
+		is_event = _cals_ical_line_is(line + 6, len - 6, "VEVENT");
+		is_todo = _cals_ical_line_is(line + 6, len - 6, "VTODO");
+
+		s->start = r->cursor;
+		depth = 1;
+		while (0 < depth && CAL_TRUE == (ret = _cals_ical_scan_line(r, &line, &len))) {
+			if (_cals_ical_line_is(line, len, "BEGIN:"))
+				depth++;
+			else if (_cals_ical_line_is(line, len, "END:"))
+				depth--;
+		}
+		retv_if(ret < 0, ret);
+		retvm_if(0 < depth, CAL_ERR_VOBJECT_FAILED, "Component is not closed");
+
+		if (!is_event && !is_todo)
+			continue;
 
-		l = g_list_next(l);
+		s->end = r->cursor;
+		s->ver = *ver;
+		s->is_todo = is_todo;
+		return CAL_TRUE;
 	}
+	return ret;
+}
 
-	/* free schedules in memory */
-	l = list_sch;
-	while (l) {
-		cs = (cal_struct *)l->data;
-		if (cs == NULL) {
-			ERR("Not cal struct\n");
+static void *_cals_ical_worker(void *data)
+{
+	int ret;
+	cal_struct *cs;
+	struct cals_ical_slice *s;
+	struct cals_ical_pool *pool = data;
+	struct cals_ical_reader r = {0};
+
+	while (1) {
+		pthread_mutex_lock(&pool->lock);
+		while (!pool->quit && pool->cnt <= pool->next)
+			pthread_cond_wait(&pool->work, &pool->lock);
+		if (pool->quit) {
+			pthread_mutex_unlock(&pool->lock);
 			break;
 		}
-		calendar_svc_struct_free(&cs);
-		l = g_list_next(l);
+		s = &pool->slices[pool->next++];
+		pthread_mutex_unlock(&pool->lock);
+
+		r.base = r.cursor = r.released = s->start;
+		r.end = s->end;
+		cs = NULL;
+		ret = _cals_ical_parse_comp(&r, s->ver, s->is_todo, &cs);
+
+		pthread_mutex_lock(&pool->lock);
+		s->ret = ret;
+		s->cs = cs;
+		s->is_done = true;
+		pthread_cond_broadcast(&pool->done);
+		pthread_mutex_unlock(&pool->lock);
+	}
+	free(r.line);
+
+	return NULL;
+}
+
+int cals_ical_parse_file_parallel(const char *path, int workers,
+		cals_ical_cb cb, void *data)
+{
+	CALS_FN_CALL;
+	int i, cnt, window;
+	int ret, scan_ret;
+	int ver = -1;
+	int threads = 0;
+	void *map;
+	size_t size;
+	pthread_t tids[CALS_ICAL_WORKERS_MAX];
+	struct cals_ical_pool pool;
+	struct cals_ical_reader r = {0};
+
+	retv_if(NULL == path, CAL_ERR_ARG_NULL);
+	retv_if(NULL == cb, CAL_ERR_ARG_NULL);
+
+	if (workers <= 1)
+		return cals_ical_parse_file(path, cb, data);
+	if (CALS_ICAL_WORKERS_MAX < workers)
+		workers = CALS_ICAL_WORKERS_MAX;
+
+	ret = _cals_ical_map(path, &map, &size);
+	retv_if(CAL_SUCCESS != ret, ret);
+	if (NULL == map)
+		return CAL_SUCCESS;
+
+	r.base = map;
+	r.cursor = map;
+	r.released = map;
+	r.end = r.base + size;
+
+	memset(&pool, 0, sizeof(pool));
+	window = workers * CALS_ICAL_WINDOW_PER_WORKER;
+	pool.slices = calloc(window, sizeof(struct cals_ical_slice));
+	if (NULL == pool.slices) {
+		ERR("calloc() Failed(%d)", errno);
+		munmap(map, size);
+		return CAL_ERR_OUT_OF_MEMORY;
 	}
-	g_list_free(list_sch);
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.work, NULL);
+	pthread_cond_init(&pool.done, NULL);
+
+	for (i = 0; i < workers; i++) {
+		if (pthread_create(&tids[threads], NULL, _cals_ical_worker, &pool)) {
+			ERR("pthread_create() Failed(%d)", errno);
+			break;
+		}
+		threads++;
+	}
+
+	scan_ret = CAL_TRUE;
+	while (0 < threads && CAL_SUCCESS == ret && CAL_TRUE == scan_ret) {
+		for (cnt = 0; cnt < window; cnt++) {
+			scan_ret = _cals_ical_scan_comp(&r, &ver, &pool.slices[cnt]);
+			if (CAL_TRUE != scan_ret)
+				break;
+			pool.slices[cnt].is_done = false;
+			pool.slices[cnt].cs = NULL;
+		}
+
+		pthread_mutex_lock(&pool.lock);
+		pool.next = 0;
+		pool.cnt = cnt;
+		pthread_cond_broadcast(&pool.work);
+		pthread_mutex_unlock(&pool.lock);
+
+		/* records are given in order, the rest are dropped after an error */
+		for (i = 0; i < cnt; i++) {
+			pthread_mutex_lock(&pool.lock);
+			while (!pool.slices[i].is_done)
+				pthread_cond_wait(&pool.done, &pool.lock);
+			pthread_mutex_unlock(&pool.lock);
+
+			if (CAL_SUCCESS == ret)
+				ret = pool.slices[i].ret;
+			if (CAL_SUCCESS == ret)
+				ret = cb(pool.slices[i].cs, data);
+			else if (pool.slices[i].cs)
+				calendar_svc_struct_free(&pool.slices[i].cs);
+		}
+		_cals_ical_reader_release(&r);
+
+		if (CAL_SUCCESS == ret && scan_ret < 0)
+			ret = scan_ret;
+	}
+
+	pthread_mutex_lock(&pool.lock);
+	pool.quit = true;
+	pthread_cond_broadcast(&pool.work);
+	pthread_mutex_unlock(&pool.lock);
+	for (i = 0; i < threads; i++)
+		pthread_join(tids[i], NULL);
+
+	pthread_cond_destroy(&pool.done);
+	pthread_cond_destroy(&pool.work);
+	pthread_mutex_destroy(&pool.lock);
+	free(pool.slices);
+	munmap(map, size);
+	free(r.line);
+
+	if (0 == threads)
+		return cals_ical_parse_file(path, cb, data);
 
 	return ret;
 }
-#endif
-static const char* cals_get_stream_from_path(const char *path)
+
+#ifndef CALS_IPC_CLIENT
+#define CALS_IMPORT_CHUNK 100 /* default number of schedules in a transaction */
+
+static int import_workers = 1;
+
+struct cals_import {
+	int calendar_id;
+	int chunk;
+	int cnt;
+	int imported;
+	cal_struct **cs;
+	cal_sch_full_t **sch;
+	int *ids;
+	calendar_svc_import_cb cb;
+	void *user_data;
+};
+
+/* inserts the schedules of the chunk in one transaction */
+static int _cals_import_flush(struct cals_import *im)
 {
-	FILE *file;
-	int buf_size, len;
-	char *stream;
-	char buf[1024];
+	int i;
+	int ret;
+
+	if (0 == im->cnt)
+		return CAL_SUCCESS;
 
-	file = fopen(path, "r");
+	ret = cals_insert_schedule_batch(im->sch, im->cnt, im->ids);
 
-	len = 0;
-	buf_size = ICALENAR_BUFFER_MAX;
-	stream = malloc(ICALENAR_BUFFER_MAX);
+	for (i = 0; i < im->cnt; i++)
+		calendar_svc_struct_free(&im->cs[i]);
+	if (CAL_SUCCESS == ret)
+		im->imported += im->cnt;
+	im->cnt = 0;
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_insert_schedule_batch() Failed(%d)", ret);
 
-	while (fgets(buf, sizeof(buf), file)) {
-		if (len + sizeof(buf) < buf_size) {
-			len += snprintf(stream + len, strlen(buf) +1, "%s", buf);
+	if (im->cb)
+		im->cb(im->imported, im->user_data);
+
+	return CAL_SUCCESS;
+}
+
+static int _cals_import_cb(cal_struct *cs, void *data)
+{
+	struct cals_import *im = data;
+
+	im->cs[im->cnt] = cs;
+	im->sch[im->cnt] = cs->user_data;
+	im->sch[im->cnt]->calendar_id = im->calendar_id;
+	im->cnt++;
+
+	if (im->cnt < im->chunk)
+		return CAL_SUCCESS;
+	return _cals_import_flush(im);
+}
+#endif
+
+static int _cals_read_cb(cal_struct *cs, void *data)
+{
+	GList **l = data;
 
-		} else {
-			char *new_stream;
-			buf_size *= 2;
-			new_stream = realloc(stream, buf_size);
-			if (new_stream) {
-				stream = new_stream;
-			} else {
-				free(stream);
-				fclose(file);
-				ERR("out of memory\n");
-				return NULL;
-			}
-			len += snprintf(stream + len, strlen(buf) +1, "%s", buf);
-		}
-	}
-	fclose(file);
-	return stream;
+	*l = g_list_prepend(*l, cs);
+	return CAL_SUCCESS;
 }
 
 int calendar_svc_read_schedules_from_file(const char *path, GList **schedules)
 {
-	const char *stream;
 	int ret;
+	GList *l = NULL;
+	GList *cursor;
+	cal_struct *cs;
 
-	ret = cals_file_exist(path);
-	if (ret < 0) {
-		ERR("Failed to access path(%s)\n", path);
-		return -1;
-	}
-
-	stream = cals_get_stream_from_path(path);
-	retvm_if(stream == NULL, -1, "Failed to get stream from path(%s)", path);
-
-	ret = calendar_svc_read_schedules(stream, schedules);
-	if (ret < 0) {
-		ERR("Failed to parse ics\n");
-		if (stream) {
-			free((void *)stream);
+	ret = cals_ical_parse_file(path, _cals_read_cb, &l);
+	l = g_list_reverse(l);
+	if (ret < 0 || NULL == l) {
+		ERR("Failed to parse ics(%d)\n", ret);
+		for (cursor = l; cursor; cursor = g_list_next(cursor)) {
+			cs = cursor->data;
+			calendar_svc_struct_free(&cs);
 		}
+		g_list_free(l);
 		return -1;
 	}
 
-	if (stream) {
-		free((void *)stream);
-	}
+	*schedules = l;
 	return 0;
 }
 #ifndef CALS_IPC_CLIENT
-int cals_import_schedules(const char *path, int calendar_id)
+int cals_import_schedules(const char *path, int calendar_id, int chunk,
+		calendar_svc_import_cb cb, void *user_data)
 {
-	FILE *file;
-	int buf_size, len;
-	char *stream;
-	char buf[1024];
+	int i;
+	int ret;
+	struct cals_import im = {0};
+
+	im.calendar_id = calendar_id;
+	im.chunk = 0 < chunk ? chunk : CALS_IMPORT_CHUNK;
+	im.cb = cb;
+	im.user_data = user_data;
+	im.cs = calloc(im.chunk, sizeof(cal_struct *));
+	im.sch = calloc(im.chunk, sizeof(cal_sch_full_t *));
+	im.ids = calloc(im.chunk, sizeof(int));
+	if (NULL == im.cs || NULL == im.sch || NULL == im.ids) {
+		ERR("calloc() Failed(%d)", errno);
+		free(im.cs);
+		free(im.sch);
+		free(im.ids);
+		return CAL_ERR_OUT_OF_MEMORY;
+	}
 
-	file = fopen(path, "r");
+	ret = cals_ical_parse_file_parallel(path, import_workers, _cals_import_cb, &im);
+	if (CAL_SUCCESS == ret) {
+		ret = _cals_import_flush(&im);
+	} else {
+		for (i = 0; i < im.cnt; i++)
+			calendar_svc_struct_free(&im.cs[i]);
+	}
 
-	len = 0;
-	buf_size = ICALENAR_BUFFER_MAX;
-	stream = malloc(ICALENAR_BUFFER_MAX);
+	free(im.cs);
+	free(im.sch);
+	free(im.ids);
 
-	while (fgets(buf, sizeof(buf), file)) {
-		if (len + sizeof(buf) < buf_size) {
-			len += snprintf(stream + len, strlen(buf) +1, "%s", buf);
+	return ret;
+}
 
-		} else {
-			char *new_stream;
-			buf_size *= 2;
-			new_stream = realloc(stream, buf_size);
-			if (new_stream) {
-				stream = new_stream;
-			} else {
-				if (stream) free(stream);
-				fclose(file);
-				ERR("out of memory");
-				return CAL_ERR_OUT_OF_MEMORY;
-			}
-			len += snprintf(stream + len, strlen(buf) +1, "%s", buf);
-		}
+API int calendar_svc_set_import_workers(int workers)
+{
+	retv_if(workers < 0, CAL_ERR_ARG_INVALID);
 
-		if (!strncmp(buf, "END:VCALENDAR", strlen("END:VCALENDAR"))){
-			DBG("end vcalendar");
+	if (0 == workers)
+		workers = sysconf(_SC_NPROCESSORS_ONLN);
+	import_workers = 0 < workers ? workers : 1;
 
-			if (cals_do_importing(calendar_id, stream, NULL)) {
-				if (stream) free(stream);
-				fclose(file);
-				return 0;
-			}
-			len = 0;
-		}
-	}
-	if (stream) free(stream);
-	fclose(file);
 	return CAL_SUCCESS;
 }
 
 API int calendar_svc_calendar_import(const char *path, int calendar_id)
+{
+	return calendar_svc_calendar_import_with_progress(path, calendar_id, 0, NULL, NULL);
+}
+
+API int calendar_svc_calendar_import_with_progress(const char *path, int calendar_id,
+		int chunk, calendar_svc_import_cb cb, void *user_data)
 {
 	int ret;
 	retv_if(path == NULL, CAL_ERR_ARG_INVALID);
@@ -847,7 +1638,7 @@ API int calendar_svc_calendar_import(const char *path, int calendar_id)
 		return -1;
 	}
 
-	ret = cals_import_schedules(path, calendar_id);
+	ret = cals_import_schedules(path, calendar_id, chunk, cb, user_data);
 	return ret;
 }
 #endif
@@ -874,14 +1665,13 @@ char *cals_func_vcalendar(GList **list_sch, void *data)
 
 		}
 
-		if (!strncmp(prop, "PRODID", strlen("PRODID"))) {
+		switch (_cals_ical_vcal_idx(prop)) {
+		case VCAL_PRODID:
 			_vcal_list[VCAL_PRODID].func(list_sch, cont);
-
-		} else if (!strncmp(prop, "VERSION", strlen("VERSION"))) {
+			break;
+		case VCAL_VERSION:
 			ver = _vcal_list[VCAL_VERSION].func(list_sch, cont);
-
-		} else {
-
+			break;
 		}
 
 		if (prop) {
@@ -942,7 +1732,6 @@ char *cals_func_vevent(int ver, GList **list_sch, void *data)
 	int i;
 	char *prop, *cont;
 	char *cursor = (char *)data;
-	GList *l;
 	cal_struct *cs;
 	cal_sch_full_t *sch;
 
@@ -971,13 +1760,9 @@ char *cals_func_vevent(int ver, GList **list_sch, void *data)
 			break;
 
 		} else {
-			for (i = 0; i < VEVE_MAX; i++) {
-				if (!strncmp(prop, _veve_list[i].prop, strlen(_veve_list[i].prop))) {
-					l = g_list_last(*list_sch);
-					_veve_list[i].func(ver, ((cal_struct *)(l->data))->user_data, cont);
-					break;
-				}
-			}
+			i = _cals_ical_veve_idx(prop);
+			if (0 <= i)
+				_veve_list[i].func(ver, sch, cont);
 		}
 
 		if (prop) free(prop);
@@ -998,7 +1783,6 @@ char *cals_func_vtodo(int ver, GList **list_sch, void *data)
 	int i;
 	char *prop, *cont;
 	char *cursor = (char *)data;
-	GList *l;
 	cal_struct *cs;
 	cal_sch_full_t *sch;
 
@@ -1027,13 +1811,9 @@ char *cals_func_vtodo(int ver, GList **list_sch, void *data)
 			break;
 
 		} else {
-			for (i = 0; i < VEVE_MAX; i++) {
-				if (!strncmp(prop, _veve_list[i].prop, strlen(_veve_list[i].prop))) {
-					l = g_list_last(*list_sch);
-					_veve_list[i].func(ver, ((cal_struct *)(l->data))->user_data, cont);
-					break;
-				}
-			}
+			i = _cals_ical_veve_idx(prop);
+			if (0 <= i)
+				_veve_list[i].func(ver, sch, cont);
 		}
 
 		if (prop) free(prop);
@@ -1067,12 +1847,9 @@ char *cals_func_valarm(cal_sch_full_t *sch, void *data)
 
 		}
 
-		for (i = 0; i < VALA_MAX; i++) {
-			if (!strncmp(prop, _vala_list[i].prop, strlen(_vala_list[i].prop))) {
-				_vala_list[i].func(sch, cont);
-				break;
-			}
-		}
+		i = _cals_ical_vala_idx(prop);
+		if (0 <= i)
+			_vala_list[i].func(sch, cont);
 		if (prop) {
 			free(prop);
 			prop = NULL;
@@ -1212,12 +1989,9 @@ int _work_description_property(cal_sch_full_t *sch, char *buf)
 	int i;
 	int ret = 0;
 
-	for (i = 0; i < TEXT_MAX; i++) {
-		if (!strncmp(buf, _optional_list[i].prop, strlen(_optional_list[i].prop))) {
-			_optional_list[i].func(&ret, buf);
-			break;
-		}
-	}
+	i = _cals_ical_text_idx(buf);
+	if (0 <= i)
+		_optional_list[i].func(&ret, buf);
 	return ret;
 }
 
@@ -1497,22 +2271,20 @@ int cals_func_rrule(int ver, cal_sch_full_t *sch, void *data)
 			switch (ver) {
 			case 1:
 				DBG("version 2");
-				for (i = 0; i < RRULE_MAX; i++) {
-					if (!strncmp(p, _rrule_list[i].prop, strlen(_rrule_list[i].prop))) {
-						int j = 0;
-						char buf[64] = {0, };
-						p += strlen(_rrule_list[i].prop);
-						while (p[j] != ';' && p[j] != '\n' && p[j] != '\0') {
-							buf[j] = p[j];
-							j++;
-						}
-						if (p[j] != '\0') {
-							buf[j] = '\0';
-						}
-						p += j;
-						_rrule_list[i].func(sch, buf);
-						break;
+				i = _cals_ical_rrule_idx(p);
+				if (0 <= i) {
+					int j = 0;
+					char buf[64] = {0, };
+					p += strlen(_rrule_list[i].prop);
+					while (p[j] != ';' && p[j] != '\n' && p[j] != '\0') {
+						buf[j] = p[j];
+						j++;
 					}
+					if (p[j] != '\0') {
+						buf[j] = '\0';
+					}
+					p += j;
+					_rrule_list[i].func(sch, buf);
 				}
 				break;
 
@@ -1566,12 +2338,9 @@ int cals_func_rrule1(int ver, cal_sch_full_t *sch, void *data)
 					break;
 				}
 
-				for (k = 0; k < RRULE_MAX; k++) {
-					if (!strncmp(buf, _rrule_list[k].prop, strlen(_rrule_list[k].prop))) {
-						_rrule_list[k].func(sch, buf + strlen(_rrule_list[k].prop));
-						break;
-					}
-				}
+				k = _cals_ical_rrule_idx(buf);
+				if (0 <= k)
+					_rrule_list[k].func(sch, buf + strlen(_rrule_list[k].prop));
 				j = 0;
 				break;
 
@@ -1585,13 +2354,9 @@ int cals_func_rrule1(int ver, cal_sch_full_t *sch, void *data)
 		}
 
 		buf[j] = '\0';
-		for (i = 0; i < RRULE_MAX; i++) {
-			if (!strncmp(buf, _rrule_list[i].prop, strlen(_rrule_list[i].prop))) {
-				version = 2;
-				_rrule_list[i].func(sch, buf + strlen(_rrule_list[i].prop));
-				break;
-			}
-		}
+		i = _cals_ical_rrule_idx(buf);
+		if (0 <= i)
+			_rrule_list[i].func(sch, buf + strlen(_rrule_list[i].prop));
 		return 0;
 	}
 
@@ -1916,14 +2681,12 @@ int _work_attendee_property(cal_sch_full_t *sch, char *buf)
 	int i;
 	int len_all, len_prop;
 
-	for (i = 0; i < ATTENDEE_MAX; i++) {
-		if (!strncmp(buf, _attendee_list[i].prop, strlen(_attendee_list[i].prop))) {
-			len_all = strlen(buf);
-			len_prop = strlen(_attendee_list[i].prop);
-			snprintf(buf, len_all - len_prop + 1, "%s", &buf[len_prop]);
-			_attendee_list[i].func(sch, buf);
-			break;
-		}
+	i = _cals_ical_attendee_idx(buf);
+	if (0 <= i) {
+		len_all = strlen(buf);
+		len_prop = strlen(_attendee_list[i].prop);
+		snprintf(buf, len_all - len_prop + 1, "%s", &buf[len_prop]);
+		_attendee_list[i].func(sch, buf);
 	}
 	return 0;
 }
@@ -2428,24 +3191,22 @@ int cals_func_trigger(cal_sch_full_t *sch, void *data)
 
 	while (*p != '\n' && *p != '\r' && *p != '\0') {
 
-		for (i = 0; i < TRIG_MAX; i++) {
-			if (!strncmp(p, _trig_list[i].prop, strlen(_trig_list[i].prop))) {
-				out = 1;
-				int j = 0;
-				char buf[64] = {0, };
-				p += strlen(_trig_list[i].prop);
-				while (p[j] != ';' && p[j] != '\n' && p[j] != '\0') {
-					buf[j] = p[j];
-					j++;
-				}
-				if (p[j] != '\0') {
-					buf[j] = '\0';
-				}
-
-				p += j;
-				_trig_list[i].func(sch, buf);
-				break;
+		i = _cals_ical_trig_idx(p);
+		if (0 <= i) {
+			out = 1;
+			int j = 0;
+			char buf[64] = {0, };
+			p += strlen(_trig_list[i].prop);
+			while (p[j] != ';' && p[j] != '\n' && p[j] != '\0') {
+				buf[j] = p[j];
+				j++;
 			}
+			if (p[j] != '\0') {
+				buf[j] = '\0';
+			}
+
+			p += j;
+			_trig_list[i].func(sch, buf);
 		}
 		if (out == 1) {
 			break;
@@ -2928,8 +3689,13 @@ int cals_func_encoding(int *val, void *data)
 	return 0;
 }
 
+#define CAL_SVC_BUF_INIT_SIZE 1024
+#define CAL_SVC_BUF_SYNC_SIZE (16 * 1024) /* written to fd when it is over */
+
 struct buf {
+	int fd; /* -1 if data is kept in memory */
 	int size;
+	int len;
 	char *data;
 	char lbuf[76];
 };
@@ -2938,16 +3704,61 @@ struct buf {
 
 static inline int _alloc(struct buf *b, int n)
 {
-	b->data = realloc(b->data, b->size + n);
+	int size;
+	char *data;
+
+	if (b->len + n < b->size)
+		return CAL_SUCCESS;
 
-	retvm_if(!b->data, CAL_ERR_OUT_OF_MEMORY, "Out of memory error");
-	b->size += n;
+	size = b->size ? b->size : CAL_SVC_BUF_INIT_SIZE;
+	while (size <= b->len + n)
+		size *= 2;
+
+	data = realloc(b->data, size);
+	retvm_if(!data, CAL_ERR_OUT_OF_MEMORY, "Out of memory error");
+	b->data = data;
+	b->size = size;
 
 	return CAL_SUCCESS;
 }
 
+static inline int _append(struct buf *b, const char *s, int n)
+{
+	int r;
+
+	r = _alloc(b, n);
+	retv_if(r < CAL_SUCCESS, r);
 
-static struct buf *cal_svc_buf_new()
+	memcpy(b->data + b->len, s, n);
+	b->len += n;
+	b->data[b->len] = '\0';
+
+	return CAL_SUCCESS;
+}
+
+static int _write(struct buf *b)
+{
+	int r;
+	int done;
+
+	done = 0;
+	while (done < b->len) {
+		r = write(b->fd, b->data + done, b->len - done);
+		if (r < 0) {
+			if (EINTR == errno)
+				continue;
+			ERR("write() Failed(%d)", errno);
+			return CAL_ERR_IO_ERR;
+		}
+		done += r;
+	}
+	b->len = 0;
+	*b->data = '\0';
+
+	return CAL_SUCCESS;
+}
+
+static struct buf *_buf_new(int fd)
 {
 	struct buf *b;
 
@@ -2956,18 +3767,26 @@ static struct buf *cal_svc_buf_new()
 		return NULL;
 	}
 
-	b->data = malloc(sizeof(char));
-	if (!b->data) {
+	b->fd = fd;
+	if (_alloc(b, 0) < CAL_SUCCESS) {
 		free(b);
 		return NULL;
 	}
-
 	*b->data = '\0';
-	b->size = 1;
 
 	return b;
 }
 
+static struct buf *cal_svc_buf_new()
+{
+	return _buf_new(-1);
+}
+
+/* data is written to fd as it grows, cal_svc_buf_sync() writes the rest */
+static struct buf *cal_svc_buf_new_fd(int fd)
+{
+	return _buf_new(fd);
+}
 
 static void cal_svc_buf_free(struct buf **b)
 {
@@ -2978,31 +3797,39 @@ static void cal_svc_buf_free(struct buf **b)
 		free((*b)->data);
 
 	free(*b);
-	b = NULL;
+	*b = NULL;
 }
 
-static inline int _flush(struct buf *b)
+static inline int cal_svc_buf_sync(struct buf *b)
+{
+	if (b->fd < 0 || 0 == b->len)
+		return CAL_SUCCESS;
+	return _write(b);
+}
+
+static inline int _end_line(struct buf *b, const char *eol, int n)
 {
 	int r;
-	r = _alloc(b, _strlen(b->lbuf) + 2);
-	retv_if(r < CAL_SUCCESS, r);
 
-	strncat(b->data, b->lbuf, b->size - _strlen(b->data) - 1);
-	strncat(b->data, "\r\n", b->size - _strlen(b->data) - 1);
+	r = _append(b, b->lbuf, _strlen(b->lbuf));
+	retv_if(r < CAL_SUCCESS, r);
+	r = _append(b, eol, n);
+	retv_if(r < CAL_SUCCESS, r);
 	*b->lbuf = '\0';
+
+	if (0 <= b->fd && CAL_SVC_BUF_SYNC_SIZE <= b->len)
+		return _write(b);
 	return CAL_SUCCESS;
 }
 
-static inline int _fold(struct buf *b)
+static inline int _flush(struct buf *b)
 {
-	int r;
-	r = _alloc(b, _strlen(b->lbuf) + 3);
-	retv_if(r < CAL_SUCCESS, r);
+	return _end_line(b, "\r\n", 2);
+}
 
-	strncat(b->data, b->lbuf, b->size - _strlen(b->data) - 1);
-	strncat(b->data, "\r\n ", b->size - _strlen(b->data) - 1);
-	*b->lbuf = '\0';
-	return CAL_SUCCESS;
+static inline int _fold(struct buf *b)
+{
+	return _end_line(b, "\r\n ", 3);
 }
 
 static inline int _set_str(struct buf *b, const char *s)
@@ -3070,11 +3897,17 @@ static int cal_svc_buf_printline(struct buf *b, const char *s1, const char *s2)
 }
 
 
+/* data is taken from the buffer, and should be freed by the caller */
 static char *cal_svc_buf_get_data(struct buf *b)
 {
+	char *data;
+
 	if (!b || !b->data)
 		return NULL;
-	return strdup(b->data);
+	data = b->data;
+	b->data = NULL;
+	b->size = b->len = 0;
+	return data;
 }
 
 static const char *vl_datetime(int y, int m, int d)
@@ -3438,11 +4271,9 @@ int cp_schedule(struct buf *b, cal_sch_full_t *s)
 }
 
 
-int cp_vcalendar(struct buf *b, GList *sch_l)
+static int cp_vcalendar_begin(struct buf *b)
 {
 	int r;
-	cal_sch_full_t *s;
-	GList *l;
 
 	r = cal_svc_buf_printline(b, "BEGIN:VCALENDAR", NULL);
 	retv_if(r < CAL_SUCCESS, r);
@@ -3453,7 +4284,21 @@ int cp_vcalendar(struct buf *b, GList *sch_l)
 	r = cal_svc_buf_printline(b, "PRODID:-//Samsung Electronics//Calendar//EN", NULL);
 	retv_if(r < CAL_SUCCESS, r);
 
-	r = cal_svc_buf_printline(b, "VERSION:2.0", NULL);
+	return cal_svc_buf_printline(b, "VERSION:2.0", NULL);
+}
+
+static inline int cp_vcalendar_end(struct buf *b)
+{
+	return cal_svc_buf_printline(b, "END:VCALENDAR", NULL);
+}
+
+int cp_vcalendar(struct buf *b, GList *sch_l)
+{
+	int r;
+	cal_sch_full_t *s;
+	GList *l;
+
+	r = cp_vcalendar_begin(b);
 	retv_if(r < CAL_SUCCESS, r);
 
 	for (l = sch_l; l; l = g_list_next(l)) {
@@ -3466,7 +4311,7 @@ int cp_vcalendar(struct buf *b, GList *sch_l)
 		retv_if(r < CAL_SUCCESS, r);
 	}
 
-	return cal_svc_buf_printline(b, "END:VCALENDAR", NULL);
+	return cp_vcalendar_end(b);
 }
 
 
@@ -3506,88 +4351,227 @@ API int calendar_svc_write_schedules(GList *schedules, char **stream)
 	return CAL_SUCCESS;
 }
 
+static const char *_fb_type[] = {
+	[EVENT_BUSY_FB] = "BUSY",
+	[EVENT_BUSY_UNAVAILABLE_FB] = "BUSY-UNAVAILABLE",
+	[EVENT_FREE_FB] = "FREE",
+	[EVENT_BUSY_TENTATIVE_FB] = "BUSY-TENTATIVE",
+};
+
+static int pr_utc(struct buf *b, const char *s1, long long int t)
+{
+	int r;
+	char *datetime;
+
+	datetime = cals_time_get_str_datetime(CALS_TZID_0, t);
+	retvm_if(NULL == datetime, CAL_ERR_OUT_OF_MEMORY, "cals_time_get_str_datetime() Failed");
+
+	r = cal_svc_buf_printline(b, s1, datetime);
+	free(datetime);
+
+	return r;
+}
+
+static int pr_freebusy(struct buf *b, const struct cals_freebusy *fb)
+{
+	int r;
+	int type;
+	char *s;
+	char *e;
+	char prop[64];
+	char period[64];
+
+	type = fb->type;
+	if (type < 0 || sizeof(_fb_type) / sizeof(_fb_type[0]) <= type)
+		type = EVENT_BUSY_FB;
+
+	s = cals_time_get_str_datetime(CALS_TZID_0, fb->start);
+	e = cals_time_get_str_datetime(CALS_TZID_0, fb->end);
+	if (NULL == s || NULL == e) {
+		ERR("cals_time_get_str_datetime() Failed");
+		free(s);
+		free(e);
+		return CAL_ERR_OUT_OF_MEMORY;
+	}
+
+	snprintf(prop, sizeof(prop), "FREEBUSY;FBTYPE=%s:", _fb_type[type]);
+	snprintf(period, sizeof(period), "%s/%s", s, e);
+	free(s);
+	free(e);
+
+	r = cal_svc_buf_printline(b, prop, period);
+	retv_if(r < CAL_SUCCESS, r);
+
+	return CAL_SUCCESS;
+}
+
+static int cp_vfreebusy(struct buf *b, const struct cals_freebusy *fb, int count,
+		long long int stime, long long int etime)
+{
+	int i;
+	int r;
+
+	r = cal_svc_buf_printline(b, "BEGIN:VFREEBUSY", NULL);
+	retv_if(r < CAL_SUCCESS, r);
+
+	r = pr_utc(b, "DTSTAMP:", cals_get_lli_now());
+	retv_if(r < CAL_SUCCESS, r);
+
+	r = pr_utc(b, "DTSTART:", stime);
+	retv_if(r < CAL_SUCCESS, r);
+
+	r = pr_utc(b, "DTEND:", etime);
+	retv_if(r < CAL_SUCCESS, r);
+
+	for (i = 0; i < count; i++) {
+		r = pr_freebusy(b, &fb[i]);
+		retv_if(r < CAL_SUCCESS, r);
+	}
+
+	return cal_svc_buf_printline(b, "END:VFREEBUSY", NULL);
+}
+
+API int calendar_svc_write_freebusy(const struct cals_freebusy *freebusy, int count,
+		long long int stime, long long int etime, char **stream)
+{
+	int r;
+	struct buf *b;
+	char *ical;
+
+	retvm_if(!stream, CAL_ERR_ARG_NULL, "Invalid parameter");
+	retvm_if(0 < count && !freebusy, CAL_ERR_ARG_NULL, "Invalid parameter");
+
+	b = cal_svc_buf_new();
+	retvm_if(!b, CAL_ERR_OUT_OF_MEMORY, "Failed to create a buffer");
+
+	r = cp_vcalendar_begin(b);
+	if (CAL_SUCCESS <= r)
+		r = cp_vfreebusy(b, freebusy, count, stime, etime);
+	if (CAL_SUCCESS <= r)
+		r = cp_vcalendar_end(b);
+
+	if (r < 0) {
+		cal_svc_buf_free(&b);
+		return r;
+	}
+
+	ical = cal_svc_buf_get_data(b);
+	cal_svc_buf_free(&b);
+	retvm_if(!ical, CAL_ERR_OUT_OF_MEMORY, "Failed to get ical data");
+
+	*stream = ical;
+
+	return CAL_SUCCESS;
+}
+
 #ifndef CALS_IPC_CLIENT
+/*
+ * creates the temporary file (tmp_path is its template, then its name)
+ * and writes the header, when the first schedule is read
+ */
+static int _cals_export_open(char *tmp_path, int *fd, struct buf **b)
+{
+	int r;
+
+	*fd = mkstemp(tmp_path);
+	retvm_if(*fd < 0, CAL_ERR_IO_ERR, "mkstemp(%s) Failed(%d)", tmp_path, errno);
+	fchmod(*fd, 0660);
+
+	*b = cal_svc_buf_new_fd(*fd);
+	if (NULL == *b) {
+		ERR("Failed to create a buffer");
+		close(*fd);
+		*fd = -1;
+		return CAL_ERR_OUT_OF_MEMORY;
+	}
+
+	r = cp_vcalendar_begin(*b);
+	retvm_if(r < CAL_SUCCESS, r, "cp_vcalendar_begin() Failed(%d)", r);
+
+	return CAL_SUCCESS;
+}
+
+/*
+ * The schedules are written to a temporary file beside path, which
+ * replaces path only when all of them are written. A failed export leaves
+ * path as it was, not a truncated calendar.
+ */
 API int calendar_svc_calendar_export(int calendar_id, const char *path)
 {
 	int fd, r;
-	char *stream = NULL;
+	struct buf *b = NULL;
 	cal_iter *it;
 	cal_struct *cs;
-	GList *schedules = NULL;
-	GList *l;
+	char tmp_path[PATH_MAX];
 
 	if (calendar_id < 0 || path == NULL) {
 		ERR("Invalid argument: calendar id(%d) path(%s)", calendar_id, path);
 		return CAL_ERR_ARG_INVALID;
 	}
+	r = snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+	retvm_if(sizeof(tmp_path) <= r, CAL_ERR_ARG_INVALID, "Too long path(%s)", path);
 
-	/* get schedules from DB */
 	r = calendar_svc_get_all(0, calendar_id, CAL_STRUCT_SCHEDULE, &it);
 	if (r != CAL_SUCCESS) {
 		ERR("Failed to get calendar(id:%d errno:%d)", calendar_id, r);
 		return CAL_ERR_FAIL;
 	}
-	while (calendar_svc_iter_next(it) == CAL_SUCCESS) {
+
+	/* each schedule is written out as it is read, not kept in memory */
+	fd = -1;
+	while ((r = calendar_svc_iter_next(it)) == CAL_SUCCESS) {
+		cs = NULL;
 		r = calendar_svc_iter_get_info(it, &cs);
-		if (r != CAL_SUCCESS) {
-			ERR("Failed to get cal_struct");
+		if (r != CAL_SUCCESS || cs == NULL || cs->user_data == NULL) {
+			ERR("Failed to get cal_struct(%d)", r);
+			if (cs)
+				calendar_svc_struct_free(&cs);
+			r = CAL_ERR_FAIL;
 			break;
 		}
 
-		if (cs == NULL) {
-			ERR("cal_struct is NULL");
-			break;
+		if (NULL == b) {
+			r = _cals_export_open(tmp_path, &fd, &b);
+			if (r < CAL_SUCCESS) {
+				calendar_svc_struct_free(&cs);
+				break;
+			}
 		}
-		schedules = g_list_append(schedules, cs);
-	}
-	calendar_svc_iter_remove(&it);
-	/* end getting schedules and close DB */
-
-	if (schedules == NULL) {
-		ERR("No schedules");
-		return CAL_ERR_FAIL;
-	}
-
-	/* get stream from schedules */
-	r = calendar_svc_write_schedules(schedules, &stream);
 
-	/* free schedules in memory */
-	l = schedules;
-	while (l) {
-		cs = (cal_struct *)l->data;
-		if (cs == NULL) {
-			ERR("Not cal struct");
-			break;
-		}
+		r = cp_schedule(b, cs->user_data);
 		calendar_svc_struct_free(&cs);
-		l = g_list_next(l);
-	}
-	g_list_free(schedules);
-
-	if (r < 0) {
-		ERR("Failed to write schedules(errno:%d)", r);
-		return CAL_ERR_FAIL;
+		if (r < CAL_SUCCESS)
+			break;
 	}
+	calendar_svc_iter_remove(&it);
 
-	if (stream == NULL) {
-		ERR("stream is NULL");
-		return CAL_ERR_FAIL;
+	if (CAL_ERR_FINISH_ITER == r) {
+		if (NULL == b) {
+			ERR("No schedules");
+			return CAL_ERR_FAIL;
+		}
+		r = cp_vcalendar_end(b);
+		if (CAL_SUCCESS == r)
+			r = cal_svc_buf_sync(b);
+		if (CAL_SUCCESS == r && fsync(fd) < 0) {
+			ERR("fsync(%s) Failed(%d)", tmp_path, errno);
+			r = CAL_ERR_IO_ERR;
+		}
 	}
+	cal_svc_buf_free(&b);
+	if (0 <= fd)
+		close(fd);
 
-	fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0660);
-	if (fd < 0) {
-		ERR("Failed to open path(%s)\n", path);
-		free(stream);
-		return CAL_ERR_IO_ERR;
+	if (CAL_SUCCESS == r && rename(tmp_path, path) < 0) {
+		ERR("rename(%s, %s) Failed(%d)", tmp_path, path, errno);
+		r = CAL_ERR_IO_ERR;
 	}
 
-	r = write(fd, stream, strlen(stream));
-	free(stream);
-	close(fd);
-
 	if (r < 0) {
-		ERR("Failed to write stream(errno:%d)\n", r);
-		return CAL_ERR_IO_ERR;
+		ERR("Failed to write schedules(errno:%d)", r);
+		if (0 <= fd)
+			unlink(tmp_path);
+		return CAL_ERR_IO_ERR == r ? r : CAL_ERR_FAIL;
 	}
 
 	return CAL_SUCCESS;
@@ -46,6 +46,35 @@
 */
 bool cal_convert_vdata_file_to_cal_data(const char * file_path, cal_sch_full_t ** sch_array, int * sch_count, int *error_code );
 
+typedef int (*cals_ical_cb)(cal_struct *cs, void *data);
+
+/**
+* @fn int cals_ical_parse_file(const char *path, cals_ical_cb cb, void *data);
+*  This function parses ics file without loading it, and gives each VEVENT or VTODO to cb.
+*
+* @return		This function returns CAL_SUCCESS or error code on failure.
+* @param[in]		path	Points the file path.
+* @param[in]		cb	Called with a new cal_struct, which should be freed by cb.
+*				Parsing stops when cb returns other than CAL_SUCCESS.
+* @param[in]		data	Passed to cb.
+* @exception	#CAL_ERR_IO_ERR - Open file error.
+* @exception	#CAL_ERR_VOBJECT_FAILED - Component is not closed.
+*/
+int cals_ical_parse_file(const char *path, cals_ical_cb cb, void *data);
+
+/**
+* @fn int cals_ical_parse_file_parallel(const char *path, int workers, cals_ical_cb cb, void *data);
+*  Same as cals_ical_parse_file(), but components are parsed by workers threads.
+*  cb is still called on the calling thread in the order of the file.
+*
+* @return		This function returns CAL_SUCCESS or error code on failure.
+* @param[in]		path	Points the file path.
+* @param[in]		workers	The number of threads, 1 or less parses on the calling thread.
+* @param[in]		cb	Same as cals_ical_parse_file().
+* @param[in]		data	Passed to cb.
+*/
+int cals_ical_parse_file_parallel(const char *path, int workers, cals_ical_cb cb, void *data);
+
 /**
 * @}
 */
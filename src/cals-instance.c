@@ -5,12 +5,17 @@
 #include <unicode/ustdio.h>
 #include <unicode/udat.h>
 #include <sys/types.h>
+#include <limits.h>
+#include <time.h>
 #include "cals-typedef.h"
 #include "cals-internal.h"
 #include "cals-instance.h"
 #include "cals-sqlite.h"
 #include "cals-db-info.h"
 #include "cals-utils.h"
+#include "cals-schedule.h"
+#include "cals-recur.h"
+#include "cals-tz.h"
 
 #define ms2sec(ms) (long long int)(ms / 1000.0)
 #define sec2ms(s) (s * 1000.0)
@@ -35,22 +40,58 @@ int _print_cal(UCalendar *cal)
 	return 0;
 }
 
+/*
+ * Instances are keyed by dtstart_utime for normal events and
+ * by YYYYMMDD for allday events.
+ */
+#define CALS_INST_KEY_MIN LLONG_MIN
+#define CALS_INST_KEY_MAX LLONG_MAX
+
+/* recurring instances are materialized this far ahead when inserted */
+#define CALS_INST_HORIZON_SEC (366 * 24 * 60 * 60)
+#define CALS_INST_HORIZON_DAY 366
+
+/* instances are written in chunks through one prepared statement */
+#define CALS_INST_SINK_SIZE 64
+
+struct inst_sink {
+	int event_id;
+	int type;
+	int cnt;
+	struct inst_row row[CALS_INST_SINK_SIZE];
+	int in_memory; /* rows are kept in mem instead of the database */
+	int mem_cnt;
+	int mem_size;
+	struct inst_row *mem;
+};
+
+struct inst_win {
+	long long int start; /* key of the first instance to insert */
+	long long int end; /* key of the last instance to insert */
+	int cnt; /* inserted instances */
+	int more; /* instances remain after end */
+	int ex_cnt;
+	long long int *exdate; /* keys of the excluded instances */
+	struct inst_sink sink;
+};
+
 static int _get_max_count(cal_sch_full_t *);
+static inline int _is_windowed(cal_sch_full_t *);
 static int instance_insert_yearly(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch);
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win);
 static int instance_insert_monthly(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch);
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win);
 static int instance_insert_weekly(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch);
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win);
 static int instance_insert_daily(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch);
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win);
 static int instance_insert_once(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch);
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win);
 
 struct inst_info {
-	int (*insert)(int, struct cals_time *, int duration, cal_sch_full_t *);
+	int (*insert)(int, struct cals_time *, int duration, cal_sch_full_t *, struct inst_win *);
 	UCalendarDateFields f;
-	int max;
+	int max; /* instances kept materialized per event */
 };
 
 static struct inst_info inst_info[] = {
@@ -114,27 +155,10 @@ static struct day wdays[] = {
 static UCalendar *_ucal_get_cal(const char *tzid, int wkst)
 {
 	UCalendar *cal;
-	UErrorCode status = U_ZERO_ERROR;
-	UChar *_tzid;
 
-	_tzid = NULL;
-
-	if (tzid) {
-		_tzid = (UChar*)malloc(sizeof(UChar) * (strlen(tzid) +1));
-		if (_tzid)
-			u_uastrcpy(_tzid, tzid);
-		else
-			ERR("malloc failed");
-	}
-
-	cal = ucal_open(_tzid, u_strlen(_tzid), "en_US", UCAL_TRADITIONAL, &status);
-	if (_tzid)
-		free(_tzid);
-
-	if (U_FAILURE(status)) {
-		ERR("ucal_open failed (%s)", u_errorName(status));
+	cal = cals_tz_open_cal(tzid);
+	if (!cal)
 		return NULL;
-	}
 
 	if (wkst >= CALS_SUNDAY && wkst <= CALS_SATURDAY)
 		ucal_setAttribute(cal, UCAL_FIRST_DAY_OF_WEEK, wdays[wkst].uday);
@@ -413,25 +437,190 @@ int _shift_to_valid_wday(UCalendar *cal, int year, int month, int mday, int wday
 }
 
 
+/*
+ * Once the first instance is placed by ICU, plain day/month/year steps are
+ * done by the civil date kernel. nth weekday rules still step through ICU.
+ */
+static int _recur_init(UCalendar *cal, struct cals_recur *rc,
+		int wday, cal_sch_full_t *sch)
+{
+	int sec;
+	int year;
+	int month;
+	int mday;
+	UErrorCode status = U_ZERO_ERROR;
+
+	switch (sch->freq) {
+	case CALS_FREQ_YEARLY:
+	case CALS_FREQ_MONTHLY:
+		if (wday != CALS_NODAY)
+			return -1;
+		break;
+	default:
+		break;
+	}
+
+	year = ucal_get(cal, UCAL_YEAR, &status);
+	month = ucal_get(cal, UCAL_MONTH, &status) + 1;
+	mday = ucal_get(cal, UCAL_DATE, &status);
+	sec = ucal_get(cal, UCAL_HOUR_OF_DAY, &status) * 60 * 60
+		+ ucal_get(cal, UCAL_MINUTE, &status) * 60
+		+ ucal_get(cal, UCAL_SECOND, &status);
+	if (U_FAILURE(status)) {
+		ERR("ucal_get failed (%s)", u_errorName(status));
+		return -1;
+	}
+
+	return cals_recur_init(rc, sch->freq, sch->interval, year, month, mday, sec);
+}
+
+static void _recur_get_instance(UCalendar *cal, struct cals_recur *rc,
+		struct cals_time *st, struct cals_time *result)
+{
+	UErrorCode status = U_ZERO_ERROR;
+
+	if (st->type == CALS_TIME_UTIME) {
+		result->type = CALS_TIME_UTIME;
+		if (!cals_tz_to_utime(st->tzid, cals_recur_get_local(rc), &result->utime))
+			return;
+		ucal_setDateTime(cal, rc->year, months[rc->month], rc->day,
+				rc->sec / (60 * 60), rc->sec / 60 % 60, rc->sec % 60, &status);
+		result->utime = (long long int)(ms2sec(ucal_getMillis(cal, &status)));
+		return;
+	}
+
+	result->type = CALS_TIME_LOCALTIME;
+	result->year = rc->year;
+	result->month = rc->month;
+	result->mday = rc->day;
+}
+
+static inline long long int _get_key(struct cals_time *t)
+{
+	if (t->type == CALS_TIME_UTIME)
+		return t->utime;
+	return t->year * 10000 + t->month * 100 + t->mday;
+}
+
+/*
+ * Day (from 1970-01-01) on which the walk of a window starting at key begins.
+ * Local dates of utime keys are within a day of the date in UTC.
+ */
+static inline long long int _get_first_day(int type, long long int key)
+{
+	long long int days;
+
+	if (type != CALS_TIME_UTIME)
+		return cals_recur_days_from_civil(key / 10000, key / 100 % 100, key % 100);
+
+	days = key / (24 * 60 * 60);
+	if (key < 0 && key % (24 * 60 * 60))
+		days--;
+	return days - 1;
+}
+
+static int _sink_flush(struct inst_sink *sink)
+{
+	int r;
+	int i;
+	sqlite3_stmt *stmt;
+
+	if (0 == sink->cnt)
+		return CAL_SUCCESS;
+
+	if (sink->in_memory) {
+		if (sink->mem_size < sink->mem_cnt + sink->cnt) {
+			struct inst_row *mem;
+			int size = sink->mem_size ? sink->mem_size * 2 : CALS_INST_SINK_SIZE * 4;
+
+			while (size < sink->mem_cnt + sink->cnt)
+				size *= 2;
+			mem = realloc(sink->mem, size * sizeof(struct inst_row));
+			retvm_if(NULL == mem, CAL_ERR_OUT_OF_MEMORY, "realloc() Failed");
+			sink->mem = mem;
+			sink->mem_size = size;
+		}
+		memcpy(sink->mem + sink->mem_cnt, sink->row, sink->cnt * sizeof(struct inst_row));
+		sink->mem_cnt += sink->cnt;
+		sink->cnt = 0;
+		return CAL_SUCCESS;
+	}
+
+	if (sink->type == CALS_TIME_UTIME)
+		stmt = cals_query_prepare_cached("INSERT INTO "CALS_TABLE_NORMAL_INSTANCE" VALUES (?, ?, ?)");
+	else
+		stmt = cals_query_prepare_cached("INSERT INTO "CALS_TABLE_ALLDAY_INSTANCE" VALUES (?, ?, ?)");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	r = CAL_SUCCESS;
+	sqlite3_bind_int(stmt, 1, sink->event_id);
+	for (i = 0; i < sink->cnt; i++) {
+		/* YYYYMMDD of allday is stored as text by column affinity */
+		sqlite3_bind_int64(stmt, 2, sink->row[i].start);
+		sqlite3_bind_int64(stmt, 3, sink->row[i].end);
+
+		r = cals_stmt_step(stmt);
+		sqlite3_reset(stmt);
+		if (r) {
+			ERR("cals_stmt_step() Failed(%d)", r);
+			break;
+		}
+	}
+	cals_stmt_release(stmt);
+	sink->cnt = 0;
+
+	return r;
+}
+
+static inline int _sink_add(struct inst_sink *sink, long long int start, long long int end)
+{
+	if (CALS_INST_SINK_SIZE == sink->cnt) {
+		int r = _sink_flush(sink);
+		retv_if(CAL_SUCCESS != r, r);
+	}
+
+	sink->row[sink->cnt].start = start;
+	sink->row[sink->cnt].end = end;
+	sink->cnt++;
+
+	return CAL_SUCCESS;
+}
+
+static inline int _is_exdate(struct inst_win *win, long long int key)
+{
+	int i;
+
+	for (i = 0; i < win->ex_cnt; i++) {
+		if (win->exdate[i] == key)
+			return 1;
+	}
+	return 0;
+}
+
 static int _insert_instance(UCalendar *cal, int event_id,
-		struct cals_time *st, int dr, int wday, int week, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, int wday, int week, cal_sch_full_t *sch,
+		struct inst_win *win)
 {
 	CALS_FN_CALL;
 	int r;
 	int i;
 	int cnt;
+	int interval;
+	long long int key;
+	long long int last;
 	int e_year;
 	int e_month;
 	int e_mday;
 	int year;
 	int month;
 	int mday;
+	int use_rc;
 
 	UCalendar *e_cal;
 	UErrorCode status = U_ZERO_ERROR;
 	struct cals_time in;
 	struct cals_time until;
-	char query[CALS_SQL_MIN_LEN];
+	struct cals_recur rc;
 
 	r = CAL_SUCCESS;
 
@@ -443,37 +632,67 @@ static int _insert_instance(UCalendar *cal, int event_id,
 	mday = ucal_get(cal, UCAL_DATE, &status);
 	cnt = _get_max_count(sch);
 	_set_until(&until, sch);
+	interval = sch->interval > 0 ? sch->interval : 1;
+	last = CALS_INST_KEY_MIN;
+	use_rc = 0;
 
 	for (i = 0; i < cnt; i++) {
-		if (wday != CALS_NODAY) {
-			DBG("set 15th for wday");
-			switch (inst_info[sch->freq].f) {
-			case UCAL_YEAR:
-			case UCAL_MONTH:
-				_ucal_set_mday(cal, 15);
-				break;
-			default:
-				break;
+		if (use_rc) {
+			_recur_get_instance(cal, &rc, st, &in);
+		} else {
+			if (wday != CALS_NODAY) {
+				DBG("set 15th for wday");
+				switch (inst_info[sch->freq].f) {
+				case UCAL_YEAR:
+				case UCAL_MONTH:
+					_ucal_set_mday(cal, 15);
+					break;
+				default:
+					break;
+				}
+			}
+			_ucal_set_wday(cal, wday);
+			_ucal_set_week(cal, week, sch);
+			_shift_to_valid_wday(cal, year, month, mday, wday, week, sch);
+
+			_ucal_get_instance(cal, st, &in);
+			if (0 == i)
+				use_rc = !_recur_init(cal, &rc, wday, sch);
+			if (0 == i && use_rc && _is_windowed(sch) && CALS_INST_KEY_MIN != win->start) {
+				cals_recur_skip(&rc, _get_first_day(st->type, win->start));
+				_recur_get_instance(cal, &rc, st, &in);
 			}
 		}
-		_ucal_set_wday(cal, wday);
-		_ucal_set_week(cal, week, sch);
-		_shift_to_valid_wday(cal, year, month, mday, wday, week, sch);
-
-		_ucal_get_instance(cal, st, &in);
 		if (sch->freq != CALS_FREQ_ONCE && _is_after(&in, &until)) {
 			DBG("exit in is_after");
 			break;
 		}
 
+		key = _get_key(&in);
+		if (key <= last) {
+			ERR("instance(%lld) does not proceed", key);
+			break;
+		}
+		last = key;
+
+		if (win->end < key) {
+			win->more = 1;
+			break;
+		}
+
+		if (key < win->start || _is_exdate(win, key))
+			goto next;
+
 		if (st->type == CALS_TIME_UTIME) {
-			snprintf(query, sizeof(query), "INSERT INTO %s "
-					"VALUES (%d, %lld, %lld)",
-					CALS_TABLE_NORMAL_INSTANCE,
-					event_id, in.utime, in.utime + dr);
+			r = _sink_add(&win->sink, in.utime, in.utime + dr);
 
 		} else if (st->type == CALS_TIME_LOCALTIME) {
-			if (dr > 0) {
+			if (dr > 0 && CALS_RECUR_MIN_YEAR <= in.year) {
+				e_year = in.year;
+				e_month = in.month;
+				e_mday = in.mday;
+				cals_recur_add_days(&e_year, &e_month, &e_mday, dr);
+			} else if (dr > 0) {
 				e_cal = ucal_clone(cal, &status);
 				ucal_add(e_cal, UCAL_DATE, dr, &status);
 				e_year = ucal_get(e_cal, UCAL_YEAR, &status);
@@ -487,24 +706,25 @@ static int _insert_instance(UCalendar *cal, int event_id,
 				e_mday = in.mday;
 			}
 
-			snprintf(query, sizeof(query), "INSERT INTO %s "
-					"VALUES (%d, %04d%02d%02d, %04d%02d%02d)",
-					CALS_TABLE_ALLDAY_INSTANCE, event_id,
-					in.year, in.month, in.mday,
-					e_year, e_month, e_mday);
+			r = _sink_add(&win->sink, in.year * 10000 + in.month * 100 + in.mday,
+					e_year * 10000 + e_month * 100 + e_mday);
 		} else {
 			ERR("Invalid dtstart time type");
+			ucal_close(cal);
 			return CAL_ERR_ARG_INVALID;
 		}
-
-		DBG("query(%s)", query);
-		r = cals_query_exec(query);
 		if (r) {
-			ERR("cals_query_prepare failed (%d)", r);
+			ERR("_sink_add() Failed(%d)", r);
 			break;
 		}
+		win->cnt++;
 
-		ucal_add(cal, inst_info[sch->freq].f, sch->interval, &status);
+next:
+		if (use_rc) {
+			cals_recur_next(&rc);
+			continue;
+		}
+		ucal_add(cal, inst_info[sch->freq].f, interval, &status);
 		_print_cal(cal);
 		_shift_to_valid_mday(cal, mday, wday, sch);
 	}
@@ -521,6 +741,10 @@ static int _get_duration(struct cals_time *st, struct cals_time *et)
 	if (st->type == CALS_TIME_UTIME)
 		return et->utime - st->utime;
 
+	if (CALS_RECUR_MIN_YEAR <= st->year && CALS_RECUR_MIN_YEAR <= et->year)
+		return cals_recur_days_from_civil(et->year, et->month, et->mday)
+			- cals_recur_days_from_civil(st->year, st->month, st->mday);
+
 	cal = _ucal_get_cal(et->tzid, -1);
 
 	_ucal_set_time(cal, et);
@@ -605,7 +829,7 @@ int _set_valid_first_mday(UCalendar *cal, struct cals_time *st, cal_sch_full_t *
 }
 
 static int insert_bymday(int event_id,
-		struct cals_time *st, int dr, int month, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, int month, cal_sch_full_t *sch, struct inst_win *win)
 {
 	UCalendar *cal;
 	int r;
@@ -642,7 +866,7 @@ static int insert_bymday(int event_id,
 		_ucal_set_mday(cal, mday);
 		_adjust_valid_first_mday(cal, y, m, d, sch);
 
-		r = _insert_instance(cal, event_id, st, dr, CALS_NODAY, 0, sch);
+		r = _insert_instance(cal, event_id, st, dr, CALS_NODAY, 0, sch, win);
 		if (r) {
 			ERR("_insert_bymday failed (%d)", r);
 			g_strfreev(t);
@@ -655,7 +879,7 @@ static int insert_bymday(int event_id,
 }
 
 static int insert_no_by(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win)
 {
 	UCalendar *cal;
 
@@ -665,7 +889,7 @@ static int insert_no_by(int event_id,
 
 	_ucal_set_time(cal, st);
 
-	return _insert_instance(cal, event_id, st, dr, CALS_NODAY, 0, sch);
+	return _insert_instance(cal, event_id, st, dr, CALS_NODAY, 0, sch, win);
 }
 
 static inline int _get_wday(const char *str, int *week, int *wday)
@@ -707,7 +931,7 @@ static inline int _get_wday(const char *str, int *week, int *wday)
 }
 
 static int insert_byday(int event_id,
-		struct cals_time *st, int dr, int month, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, int month, cal_sch_full_t *sch, struct inst_win *win)
 {
 	CALS_FN_CALL;
 	UCalendar *cal;
@@ -742,7 +966,7 @@ static int insert_byday(int event_id,
 		_ucal_set_time(cal, st);
 		_ucal_set_month(cal, month);
 
-		r = _insert_instance(cal, event_id, st, dr, wday, week, sch);
+		r = _insert_instance(cal, event_id, st, dr, wday, week, sch, win);
 		if (r) {
 			ERR("_insert_bymday failed (%d)", r);
 			g_strfreev(t);
@@ -757,7 +981,7 @@ static int insert_byday(int event_id,
 }
 
 static int instance_insert_yearly(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win)
 {
 	CALS_FN_CALL;
 	int month;
@@ -769,51 +993,60 @@ static int instance_insert_yearly(int event_id,
 	}
 
 	if (sch->bymonthday)
-		return insert_bymday(event_id, st, dr, month, sch);
+		return insert_bymday(event_id, st, dr, month, sch, win);
 	else
-		return insert_byday(event_id, st, dr, month, sch);
+		return insert_byday(event_id, st, dr, month, sch, win);
 
 	return CAL_ERR_ARG_INVALID;
 }
 
 static int instance_insert_monthly(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win)
 {
 	CALS_FN_CALL;
 	if (sch->bymonthday)
-		return insert_bymday(event_id, st, dr, CALS_NOMONTH, sch);
+		return insert_bymday(event_id, st, dr, CALS_NOMONTH, sch, win);
 	else if (sch->byday)
-		return insert_byday(event_id, st, dr, CALS_NOMONTH, sch);
+		return insert_byday(event_id, st, dr, CALS_NOMONTH, sch, win);
 	return CAL_ERR_ARG_INVALID;
 }
 
 static int instance_insert_daily(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win)
 {
 	CALS_FN_CALL;
-	return insert_no_by(event_id, st, dr, sch);
+	return insert_no_by(event_id, st, dr, sch, win);
 }
 
 static int instance_insert_weekly(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win)
 {
 	CALS_FN_CALL;
 	if (sch->byday)
-		return insert_byday(event_id, st, dr, CALS_NOMONTH, sch);
+		return insert_byday(event_id, st, dr, CALS_NOMONTH, sch, win);
 	return CAL_ERR_ARG_INVALID;
 }
 
 static int instance_insert_once(int event_id,
-		struct cals_time *st, int dr, cal_sch_full_t *sch)
+		struct cals_time *st, int dr, cal_sch_full_t *sch, struct inst_win *win)
 {
 	CALS_FN_CALL;
-	return insert_no_by(event_id, st, dr, sch);
+	return insert_no_by(event_id, st, dr, sch, win);
+}
+
+static inline int _is_windowed(cal_sch_full_t *sch)
+{
+	/* COUNT rules are trimmed on the whole set, so they are expanded at once */
+	return 1 < inst_info[sch->freq].max && sch->range_type != CALS_RANGE_COUNT;
 }
 
 static int _get_max_count(cal_sch_full_t *sch)
 {
 	int cnt;
 
+	if (_is_windowed(sch))
+		return INT_MAX;
+
 	cnt = inst_info[sch->freq].max;
 
 	if (sch->range_type == CALS_RANGE_COUNT) {
@@ -823,15 +1056,500 @@ static int _get_max_count(cal_sch_full_t *sch)
 	return cnt;
 }
 
+static long long int _add_key(int type, long long int key, int dr)
+{
+	int y, m, d;
+
+	if (key == CALS_INST_KEY_MIN || key == CALS_INST_KEY_MAX)
+		return key;
+
+	if (type == CALS_TIME_UTIME)
+		return key + dr;
+
+	y = key / 10000;
+	m = key / 100 % 100;
+	d = key % 100;
+	cals_recur_add_days(&y, &m, &d, dr);
+
+	return y * 10000 + m * 100 + d;
+}
+
+static long long int _get_now_key(int type)
+{
+	time_t t;
+	struct tm tm;
+
+	if (type == CALS_TIME_UTIME)
+		return cals_get_lli_now();
+
+	t = time(NULL);
+	localtime_r(&t, &tm);
+	return (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+}
+
+static inline void _set_tzid(struct cals_time *t, const char *tzid)
+{
+	if (tzid && strlen(tzid) < sizeof(t->tzid))
+		snprintf(t->tzid, sizeof(t->tzid), "%s", tzid);
+	else
+		snprintf(t->tzid, sizeof(t->tzid), "%s", CALS_TZID_0);
+}
+
+/* utime exdates are "YYYYMMDDTHHMMSSZ" as written by cals_time_get_str_datetime() */
+static inline long long int _exdate_to_utime(const char *datetime)
+{
+	int y, m, d;
+	int h = 0, min = 0, s = 0;
+
+	if (sscanf(datetime, "%4d%2d%2dT%2d%2d%2d", &y, &m, &d, &h, &min, &s) < 3)
+		return -1;
+
+	return cals_recur_days_from_civil(y, m, d) * 24 * 60 * 60 + (h * 60 + min) * 60 + s;
+}
+
+static int _get_exdate(int type, const char *exdate, struct inst_win *win)
+{
+	int i;
+	char **t;
+
+	win->ex_cnt = 0;
+	win->exdate = NULL;
+
+	if (!exdate || !*exdate)
+		return CAL_SUCCESS;
+
+	t = g_strsplit(exdate, ",", -1);
+	if (!t) {
+		ERR("g_strsplit failed");
+		return CAL_ERR_OUT_OF_MEMORY;
+	}
+
+	for (i = 0; t[i]; i++);
+
+	win->exdate = calloc(i, sizeof(long long int));
+	if (!win->exdate) {
+		ERR("calloc failed");
+		g_strfreev(t);
+		return CAL_ERR_OUT_OF_MEMORY;
+	}
+
+	for (i = 0; t[i]; i++) {
+		if (!*t[i])
+			continue;
+		if (type == CALS_TIME_UTIME)
+			win->exdate[win->ex_cnt++] = _exdate_to_utime(t[i]);
+		else
+			win->exdate[win->ex_cnt++] = atoi(t[i]);
+	}
+	g_strfreev(t);
+
+	return CAL_SUCCESS;
+}
+
+static int _get_range(int event_id, long long int *start, long long int *end, int *cnt)
+{
+	int r;
+	sqlite3_stmt *stmt;
+
+	stmt = cals_query_prepare_cached("SELECT range_start, range_end, inst_cnt "
+			"FROM "CALS_TABLE_INSTANCE_RANGE" WHERE event_id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+
+	r = cals_stmt_step(stmt);
+	if (CAL_TRUE == r) {
+		*start = sqlite3_column_int64(stmt, 0);
+		*end = sqlite3_column_int64(stmt, 1);
+		*cnt = sqlite3_column_int(stmt, 2);
+	}
+	cals_stmt_release(stmt);
+
+	return r;
+}
+
+static int _set_range(int event_id, long long int start, long long int end, int cnt)
+{
+	int r;
+	sqlite3_stmt *stmt;
+
+	stmt = cals_query_prepare_cached("INSERT OR REPLACE INTO "CALS_TABLE_INSTANCE_RANGE" "
+			"VALUES (?, ?, ?, ?)");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+	sqlite3_bind_int64(stmt, 2, start);
+	sqlite3_bind_int64(stmt, 3, end);
+	sqlite3_bind_int(stmt, 4, cnt);
+
+	r = cals_stmt_step(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != r, r, "cals_stmt_step() Failed(%d)", r);
+
+	return CAL_SUCCESS;
+}
+
+static int _clear_instances(int event_id, int type)
+{
+	int r;
+	sqlite3_stmt *stmt;
+
+	if (type == CALS_TIME_UTIME)
+		stmt = cals_query_prepare_cached("DELETE FROM "CALS_TABLE_NORMAL_INSTANCE" WHERE event_id = ?");
+	else
+		stmt = cals_query_prepare_cached("DELETE FROM "CALS_TABLE_ALLDAY_INSTANCE" WHERE event_id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+
+	r = cals_stmt_step(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != r, r, "cals_stmt_step() Failed(%d)", r);
+
+	return CAL_SUCCESS;
+}
+
+/*
+ * Materializes the instances overlapping [qs, qe] (key of query period).
+ * The covered period is kept in instance_range_table and grows with queries
+ * until inst_info[].max instances are cached, then it is rebuilt from [qs, qe].
+ */
+static int _instance_fill(int event_id, struct cals_time *st, int dr,
+		cal_sch_full_t *sch, long long int qs, long long int qe)
+{
+	int r;
+	int cnt = 0;
+	long long int rs;
+	long long int re;
+	struct inst_win win;
+
+	memset(&win, 0, sizeof(struct inst_win));
+	win.sink.event_id = event_id;
+	win.sink.type = st->type;
+
+	r = _get_exdate(st->type, sch->exdate, &win);
+	retvm_if(CAL_SUCCESS != r, r, "_get_exdate() Failed(%d)", r);
+
+	if (_is_windowed(sch)) {
+		r = _get_range(event_id, &rs, &re, &cnt);
+		if (r < CAL_SUCCESS) {
+			ERR("_get_range() Failed(%d)", r);
+			free(win.exdate);
+			return r;
+		}
+	} else {
+		qs = CALS_INST_KEY_MIN;
+		qe = CALS_INST_KEY_MAX;
+		r = CAL_SUCCESS;
+	}
+
+	if (CAL_TRUE == r && cnt < inst_info[sch->freq].max) {
+		r = CAL_SUCCESS;
+		if (qs < rs) {
+			win.start = _add_key(st->type, qs, -dr);
+			win.end = _add_key(st->type, rs, -dr) - 1;
+			r = inst_info[sch->freq].insert(event_id, st, dr, sch, &win);
+			rs = qs;
+		}
+		if (CAL_SUCCESS == r && re < qe) {
+			win.start = re + 1;
+			win.end = qe;
+			win.more = 0;
+			r = inst_info[sch->freq].insert(event_id, st, dr, sch, &win);
+			re = win.more ? qe : CALS_INST_KEY_MAX;
+		}
+		cnt += win.cnt;
+	} else {
+		r = _clear_instances(event_id, st->type);
+		if (CAL_SUCCESS == r) {
+			win.start = _add_key(st->type, qs, -dr);
+			win.end = qe;
+			r = inst_info[sch->freq].insert(event_id, st, dr, sch, &win);
+		}
+		rs = qs;
+		re = win.more ? qe : CALS_INST_KEY_MAX;
+		cnt = win.cnt;
+	}
+	if (CAL_SUCCESS == r)
+		r = _sink_flush(&win.sink);
+	free(win.exdate);
+	retvm_if(CAL_SUCCESS != r, r, "insert instance Failed(%d)", r);
+
+	if (sch->freq == CALS_FREQ_ONCE)
+		return CAL_SUCCESS;
+
+	return _set_range(event_id, rs, re, cnt);
+}
+
 int cals_instance_insert(int event_id, struct cals_time *st,
 		struct cals_time *et, cal_sch_full_t *sch)
 {
+	int r;
+	int dr;
+	long long int qs;
+	long long int qe;
+
 	if (sch->cal_type != CALS_SCH_TYPE_EVENT) {
 		DBG("Check schedule type, you're handling with type(%d)", sch->cal_type);
 		return -1;
 	}
-	int dr = _get_duration(st, et);
-	return inst_info[sch->freq].insert(event_id, st, dr, sch);
+
+	_set_tzid(st, sch->dtstart_tzid);
+	_set_tzid(et, sch->dtend_tzid);
+	dr = _get_duration(st, et);
+
+	r = cals_instance_clear_range(event_id);
+	retvm_if(CAL_SUCCESS != r, r, "cals_instance_clear_range() Failed(%d)", r);
+
+	/* the rest is materialized when it is queried */
+	qs = _get_now_key(st->type);
+	if (qs < _get_key(st))
+		qs = _get_key(st);
+	if (st->type == CALS_TIME_UTIME)
+		qe = _add_key(st->type, qs, CALS_INST_HORIZON_SEC);
+	else
+		qe = _add_key(st->type, qs, CALS_INST_HORIZON_DAY);
+
+	return _instance_fill(event_id, st, dr, sch, qs, qe);
+}
+
+int cals_instance_get(cal_sch_full_t *sch, long long int start, long long int end,
+		struct inst_row **rows, int *cnt)
+{
+	int r;
+	int dr;
+	struct cals_time st;
+	struct cals_time et;
+	struct inst_win win;
+
+	retv_if(NULL == sch, CAL_ERR_ARG_NULL);
+	retv_if(NULL == rows, CAL_ERR_ARG_NULL);
+	retv_if(NULL == cnt, CAL_ERR_ARG_NULL);
+	retvm_if(sch->freq < CALS_FREQ_ONCE || CALS_FREQ_SECONDLY < sch->freq, CAL_ERR_ARG_INVALID,
+			"Invalid freq(%d)", sch->freq);
+
+	memset(&st, 0, sizeof(struct cals_time));
+	memset(&et, 0, sizeof(struct cals_time));
+	st.type = sch->dtstart_type;
+	st.utime = sch->dtstart_utime;
+	st.year = sch->dtstart_year;
+	st.month = sch->dtstart_month;
+	st.mday = sch->dtstart_mday;
+	_set_tzid(&st, sch->dtstart_tzid);
+	et.type = sch->dtend_type;
+	et.utime = sch->dtend_utime;
+	et.year = sch->dtend_year;
+	et.month = sch->dtend_month;
+	et.mday = sch->dtend_mday;
+	_set_tzid(&et, sch->dtend_tzid);
+	dr = _get_duration(&st, &et);
+
+	memset(&win, 0, sizeof(struct inst_win));
+	win.sink.type = st.type;
+	win.sink.in_memory = 1;
+
+	r = _get_exdate(st.type, sch->exdate, &win);
+	retvm_if(CAL_SUCCESS != r, r, "_get_exdate() Failed(%d)", r);
+
+	win.start = _add_key(st.type, start, -dr);
+	win.end = end;
+	r = inst_info[sch->freq].insert(0, &st, dr, sch, &win);
+	if (CAL_SUCCESS == r)
+		r = _sink_flush(&win.sink);
+	free(win.exdate);
+
+	if (CAL_SUCCESS != r) {
+		ERR("insert instance Failed(%d)", r);
+		free(win.sink.mem);
+		return r;
+	}
+
+	*rows = win.sink.mem;
+	*cnt = win.sink.mem_cnt;
+
+	return CAL_SUCCESS;
+}
+
+int cals_instance_clear_range(int event_id)
+{
+	int r;
+	sqlite3_stmt *stmt;
+
+	stmt = cals_query_prepare_cached("DELETE FROM "CALS_TABLE_INSTANCE_RANGE" WHERE event_id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+
+	r = cals_stmt_step(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != r, r, "cals_stmt_step() Failed(%d)", r);
+
+	return CAL_SUCCESS;
+}
+
+static inline void _get_date(const unsigned char *datetime, int *y, int *m, int *d)
+{
+	if (!datetime || sscanf((const char *)datetime, "%4d%2d%2d", y, m, d) != 3) {
+		*y = 1970;
+		*m = 1;
+		*d = 1;
+	}
+}
+
+static int _instance_expand_event(int event_id, long long int qs, long long int qe)
+{
+	int r;
+	int dr;
+	sqlite3_stmt *stmt;
+	cal_sch_full_t sch;
+	struct cals_time st;
+	struct cals_time et;
+
+	stmt = cals_query_prepare_cached("SELECT type, "
+			"dtstart_type, dtstart_utime, dtstart_datetime, dtstart_tzid, "
+			"dtend_type, dtend_utime, dtend_datetime, dtend_tzid, exdate "
+			"FROM "CALS_TABLE_SCHEDULE" WHERE id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+
+	r = cals_stmt_step(stmt);
+	if (CAL_TRUE != r) {
+		ERR("cals_stmt_step() Failed(%d)", r);
+		cals_stmt_release(stmt);
+		return r;
+	}
+
+	memset(&sch, 0, sizeof(cal_sch_full_t));
+	memset(&st, 0, sizeof(struct cals_time));
+	memset(&et, 0, sizeof(struct cals_time));
+
+	sch.cal_type = sqlite3_column_int(stmt, 0);
+	st.type = sqlite3_column_int(stmt, 1);
+	st.utime = sqlite3_column_int64(stmt, 2);
+	_get_date(sqlite3_column_text(stmt, 3), &st.year, &st.month, &st.mday);
+	_set_tzid(&st, (const char *)sqlite3_column_text(stmt, 4));
+	et.type = sqlite3_column_int(stmt, 5);
+	et.utime = sqlite3_column_int64(stmt, 6);
+	_get_date(sqlite3_column_text(stmt, 7), &et.year, &et.month, &et.mday);
+	_set_tzid(&et, (const char *)sqlite3_column_text(stmt, 8));
+	sch.exdate = SAFE_STRDUP(sqlite3_column_text(stmt, 9));
+	cals_stmt_release(stmt);
+
+	r = cals_get_rrule_info(event_id, &sch);
+	if (CAL_SUCCESS == r) {
+		dr = _get_duration(&st, &et);
+		r = _instance_fill(event_id, &st, dr, &sch, qs, qe);
+	}
+
+	free(sch.exdate);
+	free(sch.bysecond);
+	free(sch.byminute);
+	free(sch.byhour);
+	free(sch.byday);
+	free(sch.bymonthday);
+	free(sch.byyearday);
+	free(sch.byweekno);
+	free(sch.bymonth);
+	free(sch.bysetpos);
+
+	return r;
+}
+
+int cals_instance_expand(int calendar_id, int type, long long int start, long long int end)
+{
+	int r;
+	int i;
+	int cnt;
+	int size;
+	int *ids;
+	sqlite3_stmt *stmt;
+
+	if (type == CALS_TIME_UTIME)
+		stmt = cals_query_prepare_cached("SELECT B.id "
+				"FROM "CALS_TABLE_SCHEDULE" as B LEFT JOIN "CALS_TABLE_INSTANCE_RANGE" as R "
+				"ON B.id = R.event_id "
+				"WHERE B.type = ? AND B.is_deleted = 0 AND B.rrule_id > 0 "
+				"AND B.dtstart_type = ? AND B.dtstart_utime <= ? "
+				"AND (? <= 0 OR B.calendar_id = ?) "
+				"AND (R.event_id IS NULL OR R.range_end < ? "
+				"OR R.range_start > MAX(?, B.dtstart_utime))");
+	else
+		stmt = cals_query_prepare_cached("SELECT B.id "
+				"FROM "CALS_TABLE_SCHEDULE" as B LEFT JOIN "CALS_TABLE_INSTANCE_RANGE" as R "
+				"ON B.id = R.event_id "
+				"WHERE B.type = ? AND B.is_deleted = 0 AND B.rrule_id > 0 "
+				"AND B.dtstart_type = ? "
+				"AND CAST(substr(B.dtstart_datetime, 1, 8) AS INTEGER) <= ? "
+				"AND (? <= 0 OR B.calendar_id = ?) "
+				"AND (R.event_id IS NULL OR R.range_end < ? "
+				"OR R.range_start > MAX(?, CAST(substr(B.dtstart_datetime, 1, 8) AS INTEGER)))");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, CALS_SCH_TYPE_EVENT);
+	sqlite3_bind_int(stmt, 2, type);
+	sqlite3_bind_int64(stmt, 3, end);
+	sqlite3_bind_int(stmt, 4, calendar_id);
+	sqlite3_bind_int(stmt, 5, calendar_id);
+	sqlite3_bind_int64(stmt, 6, end);
+	sqlite3_bind_int64(stmt, 7, start);
+
+	cnt = 0;
+	size = 0;
+	ids = NULL;
+	while (CAL_TRUE == (r = cals_stmt_step(stmt))) {
+		if (cnt == size) {
+			int *tmp;
+			size = size ? size * 2 : 16;
+			tmp = realloc(ids, size * sizeof(int));
+			if (!tmp) {
+				ERR("realloc failed");
+				r = CAL_ERR_OUT_OF_MEMORY;
+				break;
+			}
+			ids = tmp;
+		}
+		ids[cnt++] = sqlite3_column_int(stmt, 0);
+	}
+	cals_stmt_release(stmt);
+
+	if (r < CAL_SUCCESS) {
+		ERR("Failed to get events to expand(%d)", r);
+		free(ids);
+		return r;
+	}
+
+	if (0 == cnt)
+		return CAL_SUCCESS;
+
+	/*
+	 * Reads expand on demand, so a writer holding the lock must not fail them:
+	 * the period is served from the instances already stored then.
+	 */
+	r = cals_begin_trans();
+	if (CAL_ERR_DB_LOCK == r) {
+		WARN("Database is locked, %d events are not expanded", cnt);
+		free(ids);
+		return CAL_SUCCESS;
+	}
+	if (r) {
+		ERR("cals_begin_trans() Failed(%d)", r);
+		free(ids);
+		return r;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		r = _instance_expand_event(ids[i], start, end);
+		if (r) {
+			ERR("_instance_expand_event(%d) Failed(%d)", ids[i], r);
+			break;
+		}
+	}
+	free(ids);
+
+	cals_end_trans(CAL_SUCCESS == r);
+
+	return r;
 }
 
 int cals_instance_delete(int event_id, struct cals_time *st)
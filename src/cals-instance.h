@@ -1,6 +1,24 @@
+#ifndef __CALENDAR_SVC_INSTANCE_H__
+#define __CALENDAR_SVC_INSTANCE_H__
+
 #include "cals-typedef.h"
 #include "cals-time.h"
 
 int cals_instance_insert(int event_id, struct cals_time *st, struct cals_time *et, cal_sch_full_t *sch);
 int cals_instance_delete(int event_id, struct cals_time *st);
+int cals_instance_clear_range(int event_id);
+int cals_instance_expand(int calendar_id, int type, long long int start, long long int end);
+
+struct inst_row {
+	long long int start; /* utime or YYYYMMDD */
+	long long int end;
+};
+
+/*
+ * Instances of sch overlapping the keys [start, end], generated in memory
+ * in the order of the start. rows should be freed by free().
+ */
+int cals_instance_get(cal_sch_full_t *sch, long long int start, long long int end,
+		struct inst_row **rows, int *cnt);
 
+#endif /* __CALENDAR_SVC_INSTANCE_H__ */
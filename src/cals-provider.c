@@ -419,6 +419,55 @@ API int calendar_svc_insert(cal_struct *event)
 }
 
 
+API int calendar_svc_insert_batch(GList *structs, int *ids_out)
+{
+	int i, cnt, ret;
+	GList *l;
+	cal_struct *event;
+	cal_sch_full_t **sch_records;
+
+	retv_if(NULL == structs, CAL_ERR_ARG_NULL);
+	retv_if(NULL == ids_out, CAL_ERR_ARG_NULL);
+
+	cnt = g_list_length(structs);
+	sch_records = calloc(cnt, sizeof(cal_sch_full_t *));
+	retvm_if(NULL == sch_records, CAL_ERR_OUT_OF_MEMORY, "calloc() Failed(%d)", errno);
+
+	for (i = 0, l = structs; l; i++, l = g_list_next(l)) {
+		event = l->data;
+		if (NULL == event || NULL == event->user_data) {
+			ERR("Invalid cal_struct at %d", i);
+			free(sch_records);
+			return CAL_ERR_ARG_INVALID;
+		}
+
+		sch_records[i] = event->user_data;
+		switch (event->event_type) {
+		case CAL_STRUCT_TYPE_SCHEDULE:
+			ret = (CALS_SCH_TYPE_EVENT == sch_records[i]->cal_type);
+			break;
+		case CAL_STRUCT_TYPE_TODO:
+			ret = (CALS_SCH_TYPE_TODO == sch_records[i]->cal_type);
+			break;
+		default:
+			ret = 0;
+			break;
+		}
+		if (!ret) {
+			ERR("Invalid type(%d) at %d", event->event_type, i);
+			free(sch_records);
+			return CAL_ERR_ARG_INVALID;
+		}
+	}
+
+	ret = cals_insert_schedule_batch(sch_records, cnt, ids_out);
+	free(sch_records);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_insert_schedule_batch() Failed(%d)", ret);
+
+	return CAL_SUCCESS;
+}
+
+
 API int calendar_svc_get(const char *data_type,int index,const char *field_list, cal_struct **record)
 {
 	CALS_FN_CALL;
@@ -491,29 +540,14 @@ API int calendar_svc_get(const char *data_type,int index,const char *field_list,
 		stmt = NULL;
 
 		if (sch_record->rrule_id > 0) {
-
-			snprintf(sql_value, sizeof(sql_value),
-					"SELECT * FROM %s WHERE event_id = %d ",
-					CALS_TABLE_RRULE, index);
-
-			DBG("has rrule_is query(%s)", sql_value);
-
-			stmt = cals_query_prepare(sql_value);
-			retex_if(NULL == stmt,,"cals_query_prepare() Failed");
-
-			rc = cals_stmt_step(stmt);
-			if (rc != CAL_TRUE) {
-				ERR("Failed to step stmt(%d)", rc);
-				sqlite3_finalize(stmt);
+			rc = cals_get_rrule_info(index, sch_record);
+			if (rc != CAL_SUCCESS) {
+				ERR("cals_get_rrule_info() Failed(%d)", rc);
 				if (malloc_inside && *record != NULL) {
 					calendar_svc_struct_free(record);
 				}
 				return CAL_ERR_FAIL;
 			}
-
-			cals_stmt_fill_rrule(stmt, sch_record);
-			sqlite3_finalize(stmt);
-			stmt = NULL;
 		}
 
 		sch_record->index = index;
@@ -723,10 +757,9 @@ API int calendar_svc_get_count(int account_id, int calendar_id, const char *data
 	return count;
 }
 
-/* get entry */
-API int calendar_svc_get_all(int account_id, int calendar_id,const char *data_type, cal_iter **iter)
+static int _cals_get_all(int account_id, int calendar_id, const char *data_type,
+		const char *cond, const char *limit, cal_iter **iter)
 {
-	CALS_FN_CALL;
 	int type;
 	sqlite3_stmt *stmt = NULL;
 	char sql_value[CALS_SQL_MIN_LEN];
@@ -741,26 +774,26 @@ API int calendar_svc_get_all(int account_id, int calendar_id,const char *data_ty
 			snprintf(sql_value, sizeof(sql_value), "SELECT A.* "
 					"FROM %s A, %s B ON A.calendar_id = B.rowid "
 					"WHERE A.type=%d AND B.visibility = 1 AND A.is_deleted = 0 "
-					"ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR, CALS_SCH_TYPE_EVENT);
+					"%s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR, CALS_SCH_TYPE_EVENT, cond, limit);
 		}
 		else
 		{
 			if (calendar_id > 0)
 				snprintf(sql_value, sizeof(sql_value), "SELECT * FROM %s "
 					"WHERE type=%d AND calendar_id = %d AND is_deleted = 0 "
-					"ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_EVENT, calendar_id);
+					"%s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_EVENT, calendar_id, cond, limit);
 			else if (account_id)
 				snprintf(sql_value, sizeof(sql_value), "SELECT * FROM %s "
 					"WHERE type=%d AND account_id = %d AND is_deleted = 0 "
-					"ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_EVENT, account_id);
+					"%s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_EVENT, account_id, cond, limit);
 			else
 				snprintf(sql_value, sizeof(sql_value), "SELECT * FROM %s "
 					"WHERE type=%d AND is_deleted = 0 "
-					"ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_EVENT);
+					"%s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_EVENT, cond, limit);
 		}
 
 		type = CAL_STRUCT_TYPE_SCHEDULE;
@@ -769,21 +802,22 @@ API int calendar_svc_get_all(int account_id, int calendar_id,const char *data_ty
 	{
 		if (calendar_id > 0)
 			snprintf(sql_value, sizeof(sql_value), "SELECT * FROM %s "
-					"WHERE type=%d AND calendar_id = %d AND is_deleted = 0 ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_TODO, calendar_id);
+					"WHERE type=%d AND calendar_id = %d AND is_deleted = 0 %s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_TODO, calendar_id, cond, limit);
 		else if (account_id)
 			snprintf(sql_value, sizeof(sql_value), "SELECT * FROM %s "
-					"WHERE type=%d AND account_id = %d AND is_deleted = 0  ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_TODO, account_id);
+					"WHERE type=%d AND account_id = %d AND is_deleted = 0  %s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_TODO, account_id, cond, limit);
 		else
 			snprintf(sql_value, sizeof(sql_value), "SELECT * FROM %s "
-					"WHERE type=%d AND is_deleted = 0  ORDER BY id",
-					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_TODO);
+					"WHERE type=%d AND is_deleted = 0  %s ORDER BY id%s",
+					CALS_TABLE_SCHEDULE, CALS_SCH_TYPE_TODO, cond, limit);
 
 		type = CAL_STRUCT_TYPE_TODO;
 	}
 	else if(0 == strcmp(data_type,CAL_STRUCT_CALENDAR))
 	{
+		retvm_if(*cond, CAL_ERR_ARG_INVALID, "calendars are not paged");
 		if (account_id)
 			snprintf(sql_value, sizeof(sql_value), "SELECT rowid,* FROM %s WHERE account_id = %d", CALS_TABLE_CALENDAR, account_id);
 		else
@@ -810,6 +844,46 @@ API int calendar_svc_get_all(int account_id, int calendar_id,const char *data_ty
 	return CAL_SUCCESS;
 }
 
+/* get entry */
+API int calendar_svc_get_all(int account_id, int calendar_id,const char *data_type, cal_iter **iter)
+{
+	CALS_FN_CALL;
+
+	return _cals_get_all(account_id, calendar_id, data_type, "", "", iter);
+}
+
+API int calendar_svc_get_all_page(int account_id, int calendar_id, const char *data_type,
+		const char *token, int limit, cal_iter **iter)
+{
+	CALS_FN_CALL;
+	int ret;
+	int id;
+	long long int key;
+	char cond[64];
+	char limit_buf[32];
+
+	retvm_if(limit <= 0, CAL_ERR_ARG_INVALID, "Invalid limit(%d)", limit);
+
+	key = 0;
+	id = 0;
+	if (token) {
+		ret = cals_page_token_parse(token, &key, &id);
+		retvm_if(CAL_SUCCESS != ret, ret, "Invalid token(%s)", token);
+	}
+
+	/* the id is the key, so the seek is on the primary key */
+	snprintf(cond, sizeof(cond), "AND id > %d", id);
+	snprintf(limit_buf, sizeof(limit_buf), " LIMIT %d", limit);
+
+	ret = _cals_get_all(account_id, calendar_id, data_type, cond, limit_buf, iter);
+	retv_if(CAL_SUCCESS != ret, ret);
+
+	(*iter)->page_limit = limit;
+	(*iter)->page_col = -1;
+
+	return CAL_SUCCESS;
+}
+
 API int calendar_svc_update(cal_struct *record)
 {
 	CALS_FN_CALL;
@@ -864,6 +938,52 @@ API int calendar_svc_update(cal_struct *record)
 }
 
 
+API int calendar_svc_update_batch(GList *structs)
+{
+	CALS_FN_CALL;
+	int i, cnt, ret;
+	GList *l;
+	cal_struct *record;
+	cal_sch_full_t **sch_records;
+
+	retv_if(NULL == structs, CAL_ERR_ARG_NULL);
+
+	cnt = g_list_length(structs);
+	sch_records = calloc(cnt, sizeof(cal_sch_full_t *));
+	retvm_if(NULL == sch_records, CAL_ERR_OUT_OF_MEMORY, "calloc() Failed(%d)", errno);
+
+	for (i = 0, l = structs; l; i++, l = g_list_next(l)) {
+		record = l->data;
+		if (NULL == record || NULL == record->user_data
+				|| (CAL_STRUCT_TYPE_SCHEDULE != record->event_type
+					&& CAL_STRUCT_TYPE_TODO != record->event_type)) {
+			ERR("Invalid cal_struct at %d", i);
+			free(sch_records);
+			return CAL_ERR_ARG_INVALID;
+		}
+		sch_records[i] = record->user_data;
+	}
+
+	ret = cals_begin_trans();
+	if (CAL_SUCCESS != ret) {
+		ERR("cals_begin_trans() Failed(%d)", ret);
+		free(sch_records);
+		return ret;
+	}
+
+	ret = cals_update_schedule_batch(sch_records, cnt);
+	free(sch_records);
+	if (CAL_SUCCESS != ret) {
+		cals_end_trans(false);
+		ERR("cals_update_schedule_batch() Failed(%d)", ret);
+		return ret;
+	}
+	cals_end_trans(true);
+
+	return CAL_SUCCESS;
+}
+
+
 API int calendar_svc_delete(const char *data_type, int index)
 {
 	CALS_FN_CALL;
@@ -904,6 +1024,40 @@ API int calendar_svc_delete(const char *data_type, int index)
 }
 
 
+API int calendar_svc_delete_batch(const char *data_type, int *ids, int n)
+{
+	CALS_FN_CALL;
+	int ret = 0;
+	cals_sch_type sch_type;
+
+	retv_if(NULL == data_type, CAL_ERR_ARG_NULL);
+	retv_if(NULL == ids, CAL_ERR_ARG_NULL);
+	retv_if(n < 0, CAL_ERR_ARG_INVALID);
+
+	if (0 == strcmp(data_type, CAL_STRUCT_SCHEDULE)) {
+		sch_type = CALS_SCH_TYPE_EVENT;
+	} else if (0 == strcmp(data_type, CAL_STRUCT_TODO)) {
+		sch_type = CALS_SCH_TYPE_TODO;
+	} else {
+		ERR("Invalid data_type(%s)", data_type);
+		return CAL_ERR_ARG_INVALID;
+	}
+
+	ret = cals_begin_trans();
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_begin_trans() Failed(%d)", ret);
+
+	ret = cals_delete_schedule_batch(sch_type, ids, n);
+	if (ret) {
+		cals_end_trans(false);
+		ERR("cals_delete_schedule_batch() Failed(%d)", ret);
+		return ret;
+	}
+	cals_end_trans(true);
+
+	return CAL_SUCCESS;
+}
+
+
 API int calendar_svc_delete_account (int account_id)
 {
 	CALS_FN_CALL;
@@ -1123,6 +1277,10 @@ API int calendar_svc_find_event_list(int account_id,const char *search_type,cons
 		}
 	}
 
+	if ((*iter)->prefetch) {
+		cals_sch_prefetch_free((*iter)->prefetch);
+		CAL_FREE((*iter)->prefetch);
+	}
 	(*iter)->stmt = stmt;
 	(*iter)->i_type = CAL_STRUCT_TYPE_SCHEDULE;
 
@@ -1244,12 +1402,10 @@ API int calendar_svc_iter_get_info(cal_iter *iter, cal_struct **row_event)
 	char *s_datetime;
 	char *e_datetime;
 	char buf[8] = {0};
-	char sql_value[CALS_SQL_MIN_LEN] = {0};
 	cal_sch_full_t *sch_record = NULL;
 	calendar_t *cal_record = NULL;
 	cal_timezone_t *tz_record = NULL;
 	cals_updated *cal_updated = NULL;
-	sqlite3_stmt *stmt = NULL;
 
 	retv_if(NULL == iter, CAL_ERR_ARG_NULL);
 	retv_if(NULL == iter->stmt && NULL == iter->info, CAL_ERR_ARG_INVALID);
@@ -1264,8 +1420,6 @@ API int calendar_svc_iter_get_info(cal_iter *iter, cal_struct **row_event)
 			return ret;
 	}
 
-	int error_code = 0;
-
 	switch(iter->i_type)
 	{
 	case CAL_STRUCT_TYPE_SCHEDULE:
@@ -1277,27 +1431,9 @@ API int calendar_svc_iter_get_info(cal_iter *iter, cal_struct **row_event)
 		sch_record = (cal_sch_full_t*)(*row_event)->user_data;
 		retvm_if(NULL == sch_record, CAL_ERR_FAIL, "row_event is Invalid");
 
-		cals_stmt_get_full_schedule(iter->stmt,sch_record,true);
-
-		if (sch_record->rrule_id > 0) {
-			snprintf(sql_value, sizeof(sql_value),
-					"SELECT * FROM %s WHERE event_id = %d ",
-					CALS_TABLE_RRULE, sch_record->index);
-
-			stmt = cals_query_prepare(sql_value);
-			retvm_if(NULL == stmt, CAL_ERR_FAIL, "cals_query_prepare() Failed");
-
-			rc = cals_stmt_step(stmt);
-			retvm_if(CAL_TRUE != rc, CAL_ERR_FAIL, "cals_stmt_step() Failed(%d)", rc);
-
-
-			cals_stmt_fill_rrule(stmt, sch_record);
-			sqlite3_finalize(stmt);
-			stmt = NULL;
-		}
-
-		cal_db_service_get_participant_info_by_index(sch_record->index,&(sch_record->attendee_list),&error_code);
-		cals_get_alarm_info(sch_record->index, &(sch_record->alarm_list));
+		/* rows of schedules are read by pages in calendar_svc_iter_next() */
+		rc = cals_sch_prefetch_get(iter->prefetch, sch_record);
+		retvm_if(CAL_SUCCESS != rc, rc, "cals_sch_prefetch_get() Failed(%d)", rc);
 		break;
 
 	case CAL_STRUCT_TYPE_TODO:
@@ -1309,23 +1445,9 @@ API int calendar_svc_iter_get_info(cal_iter *iter, cal_struct **row_event)
 		sch_record = (cal_sch_full_t*)(*row_event)->user_data;
 		retvm_if(NULL == sch_record, CAL_ERR_FAIL, "row_event is Invalid");
 
-		cals_stmt_get_full_schedule(iter->stmt,sch_record,true);
-
-		if (sch_record->rrule_id > 0) {
-			snprintf(sql_value, sizeof(sql_value),
-					"SELECT * FROM %s WHERE event_id = %d ",
-					CALS_TABLE_RRULE, sch_record->index);
-
-			stmt = cals_query_prepare(sql_value);
-			retvm_if(NULL == stmt, CAL_ERR_FAIL, "cals_query_prepare() Failed");
-
-			rc = cals_stmt_step(stmt);
-			retvm_if(CAL_TRUE != rc, CAL_ERR_FAIL, "cals_stmt_step() Failed(%d)", rc);
-
-			cals_stmt_fill_rrule(stmt, sch_record);
-			sqlite3_finalize(stmt);
-			stmt = NULL;
-		}
+		/* rows of schedules are read by pages in calendar_svc_iter_next() */
+		rc = cals_sch_prefetch_get(iter->prefetch, sch_record);
+		retvm_if(CAL_SUCCESS != rc, rc, "cals_sch_prefetch_get() Failed(%d)", rc);
 		break;
 
 	case CAL_STRUCT_TYPE_CALENDAR:
@@ -1689,17 +1811,69 @@ API int calendar_svc_iter_next(cal_iter *iter)
 			return CAL_ERR_FINISH_ITER;
 		}
 	}
+	else if (CAL_STRUCT_TYPE_SCHEDULE == iter->i_type || CAL_STRUCT_TYPE_TODO == iter->i_type) {
+		retv_if(NULL == iter->stmt, CAL_ERR_ARG_INVALID);
+
+		if (NULL == iter->prefetch) {
+			iter->prefetch = calloc(1, sizeof(struct cals_sch_prefetch));
+			retvm_if(NULL == iter->prefetch, CAL_ERR_OUT_OF_MEMORY, "calloc() Failed(%d)", errno);
+		}
+
+		ret = cals_sch_prefetch_next(iter->prefetch, iter->stmt, iter->i_type);
+		if (CAL_ERR_FINISH_ITER != ret)
+			retvm_if(CAL_SUCCESS != ret, ret, "cals_sch_prefetch_next() Failed(%d)", ret);
+
+		if (CAL_SUCCESS == ret && iter->page_limit) {
+			iter->page_id = iter->prefetch->rec[iter->prefetch->cursor - 1].index;
+			iter->page_key = iter->page_id;
+			iter->page_cnt++;
+		}
+		return ret;
+	}
 	else {
 		ret = cals_stmt_step(iter->stmt);
 		retvm_if(ret < CAL_SUCCESS, ret, "cals_stmt_step() Failed(%d)", ret);
 
 		if (CAL_SUCCESS == ret)
 			return CAL_ERR_FINISH_ITER;
+
+		if (iter->page_limit) {
+			iter->page_id = sqlite3_column_int(iter->stmt, 0);
+			iter->page_key = sqlite3_column_int64(iter->stmt, iter->page_col);
+			iter->page_cnt++;
+		}
 	}
 
 	return CAL_SUCCESS;
 }
 
+API int calendar_svc_iter_set_row_reuse(cal_iter *iter, bool reuse)
+{
+	retv_if(NULL == iter, CAL_ERR_ARG_NULL);
+
+	iter->reuse_row = reuse;
+
+	return CAL_SUCCESS;
+}
+
+API int calendar_svc_iter_get_page_token(cal_iter *iter, char **token)
+{
+	retv_if(NULL == iter, CAL_ERR_ARG_NULL);
+	retv_if(NULL == token, CAL_ERR_ARG_NULL);
+	retvm_if(0 == iter->page_limit, CAL_ERR_ARG_INVALID, "The list is not paged");
+
+	/* a short page is the last one */
+	if (iter->page_cnt < iter->page_limit) {
+		*token = NULL;
+		return CAL_SUCCESS;
+	}
+
+	*token = cals_page_token_new(iter->page_key, iter->page_id);
+	retvm_if(NULL == *token, CAL_ERR_OUT_OF_MEMORY, "cals_page_token_new() Failed");
+
+	return CAL_SUCCESS;
+}
+
 API int calendar_svc_iter_remove(cal_iter **iter)
 {
 	CALS_FN_CALL;
@@ -1720,6 +1894,10 @@ API int calendar_svc_iter_remove(cal_iter **iter)
 			(*iter)->stmt = NULL;
 		}
 	}
+	if ((*iter)->prefetch) {
+		cals_sch_prefetch_free((*iter)->prefetch);
+		free((*iter)->prefetch);
+	}
 	free(*iter);
 	*iter = NULL;
 
@@ -1731,13 +1909,9 @@ API int calendar_svc_iter_get_main_info (cal_iter *iter, cal_struct **row_event)
 {
 	CALS_FN_CALL;
 	int ret;
-	int rc;
-	int error_code = 0;
-	char sql_value[CALS_SQL_MIN_LEN] = {0};
 	calendar_t *cal_record = NULL;
 	cal_sch_full_t *sch_record = NULL;
 	cal_timezone_t *tz_record = NULL;
-	sqlite3_stmt *stmt = NULL;
 
 	retv_if(iter == NULL, CAL_ERR_ARG_NULL);
 	retv_if(iter->stmt == NULL, CAL_ERR_ARG_INVALID);
@@ -1769,28 +1943,9 @@ API int calendar_svc_iter_get_main_info (cal_iter *iter, cal_struct **row_event)
 		sch_record = (cal_sch_full_t*)(*row_event)->user_data;
 		retv_if(NULL == sch_record, CAL_ERR_ARG_NULL);
 
-		cals_stmt_get_full_schedule(iter->stmt, sch_record, true);
-
-		if (sch_record->rrule_id > 0) {
-			snprintf(sql_value, sizeof(sql_value),
-					"SELECT * FROM %s WHERE event_id = %d ",
-					CALS_TABLE_RRULE, sch_record->index);
-
-			stmt = cals_query_prepare(sql_value);
-			retvm_if(NULL == stmt, CAL_ERR_FAIL, "cals_query_prepare() Failed");
-
-			rc = cals_stmt_step(stmt);
-			retvm_if(CAL_TRUE != rc, CAL_ERR_FAIL, "cals_stmt_step() Failed(%d)", rc);
-
-
-			cals_stmt_fill_rrule(stmt, sch_record);
-			sqlite3_finalize(stmt);
-			stmt = NULL;
-		}
-
-		cal_db_service_get_participant_info_by_index(sch_record->index,&(sch_record->attendee_list),&error_code);
-		ret = cals_get_alarm_info(sch_record->index, &(sch_record->alarm_list));
-		retvm_if(CAL_SUCCESS != ret, ret, "cals_get_alarm_info() Failed(%d)", ret);
+		/* rows of schedules are read by pages in calendar_svc_iter_next() */
+		ret = cals_sch_prefetch_get(iter->prefetch, sch_record);
+		retvm_if(CAL_SUCCESS != ret, ret, "cals_sch_prefetch_get() Failed(%d)", ret);
 		break;
 
 	case CAL_STRUCT_TYPE_TODO:
@@ -1804,24 +1959,9 @@ API int calendar_svc_iter_get_main_info (cal_iter *iter, cal_struct **row_event)
 		sch_record = (cal_sch_full_t*)(*row_event)->user_data;
 		retv_if(NULL == sch_record, CAL_ERR_ARG_NULL);
 
-		cals_stmt_get_full_schedule(iter->stmt, sch_record, true);
-
-		if (sch_record->rrule_id > 0) {
-			snprintf(sql_value, sizeof(sql_value),
-					"SELECT * FROM %s WHERE event_id = %d ",
-					CALS_TABLE_RRULE, sch_record->index);
-
-			stmt = cals_query_prepare(sql_value);
-			retvm_if(NULL == stmt, CAL_ERR_FAIL, "cals_query_prepare() Failed");
-
-			rc = cals_stmt_step(stmt);
-			retvm_if(CAL_TRUE != rc, CAL_ERR_FAIL, "cals_stmt_step() Failed(%d)", rc);
-
-			cals_stmt_fill_rrule(stmt, sch_record);
-			sqlite3_finalize(stmt);
-			stmt = NULL;
-		}
-
+		/* rows of schedules are read by pages in calendar_svc_iter_next() */
+		ret = cals_sch_prefetch_get(iter->prefetch, sch_record);
+		retvm_if(CAL_SUCCESS != ret, ret, "cals_sch_prefetch_get() Failed(%d)", ret);
 		break;
 
 	case CAL_STRUCT_TYPE_CALENDAR:
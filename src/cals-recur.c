@@ -0,0 +1,212 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "cals-recur.h"
+#include "calendar-svc-provider.h"
+
+static const int mdays[] = {
+	0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31,
+};
+
+static inline int _is_leap(int year)
+{
+	return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int cals_recur_days_in_month(int year, int month)
+{
+	if (month == 2 && _is_leap(year))
+		return 29;
+	return mdays[month];
+}
+
+long long int cals_recur_days_from_civil(int year, int month, int mday)
+{
+	long long int y;
+	long long int era;
+	long long int yoe;
+	long long int doy;
+	long long int doe;
+
+	y = month <= 2 ? year - 1 : year;
+	era = (y >= 0 ? y : y - 399) / 400;
+	yoe = y - era * 400;
+	doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + mday - 1;
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+	return era * 146097 + doe - 719468;
+}
+
+void cals_recur_civil_from_days(long long int days, int *year, int *month, int *mday)
+{
+	long long int z;
+	long long int era;
+	long long int doe;
+	long long int yoe;
+	long long int doy;
+	long long int mp;
+	int m;
+
+	z = days + 719468;
+	era = (z >= 0 ? z : z - 146096) / 146097;
+	doe = z - era * 146097;
+	yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	mp = (5 * doy + 2) / 153;
+	m = mp < 10 ? mp + 3 : mp - 9;
+
+	*year = yoe + era * 400 + (m <= 2);
+	*month = m;
+	*mday = doy - (153 * mp + 2) / 5 + 1;
+}
+
+int cals_recur_wday(long long int days)
+{
+	/* 1970-01-01 was thursday */
+	return ((days + 4) % 7 + 7) % 7;
+}
+
+void cals_recur_add_days(int *year, int *month, int *mday, int days)
+{
+	cals_recur_civil_from_days(
+			cals_recur_days_from_civil(*year, *month, *mday) + days,
+			year, month, mday);
+}
+
+int cals_recur_init(struct cals_recur *rc, int freq, int interval,
+		int year, int month, int mday, int sec)
+{
+	switch (freq) {
+	case CALS_FREQ_YEARLY:
+	case CALS_FREQ_MONTHLY:
+	case CALS_FREQ_WEEKLY:
+	case CALS_FREQ_DAILY:
+		break;
+	default:
+		return -1;
+	}
+
+	if (year < CALS_RECUR_MIN_YEAR || month < 1 || 12 < month
+			|| mday < 1 || cals_recur_days_in_month(year, month) < mday)
+		return -1;
+
+	rc->freq = freq;
+	rc->interval = 0 < interval ? interval : 1;
+	rc->mday = mday;
+	rc->year = year;
+	rc->month = month;
+	rc->day = mday;
+	rc->sec = sec;
+
+	return 0;
+}
+
+static inline void _add_months(struct cals_recur *rc, int months)
+{
+	int m;
+
+	m = rc->month - 1 + months;
+	rc->year += m / 12;
+	rc->month = m % 12 + 1;
+}
+
+/*
+ * Same steps as ucal_add() followed by _shift_to_valid_mday():
+ * monthly skips to the next month having mday,
+ * yearly skips by interval until the month has mday (Feb 29).
+ */
+void cals_recur_next(struct cals_recur *rc)
+{
+	switch (rc->freq) {
+	case CALS_FREQ_YEARLY:
+		do {
+			rc->year += rc->interval;
+		} while (cals_recur_days_in_month(rc->year, rc->month) < rc->mday);
+		rc->day = rc->mday;
+		break;
+	case CALS_FREQ_MONTHLY:
+		_add_months(rc, rc->interval);
+		while (cals_recur_days_in_month(rc->year, rc->month) < rc->mday)
+			_add_months(rc, 1);
+		rc->day = rc->mday;
+		break;
+	case CALS_FREQ_WEEKLY:
+		cals_recur_add_days(&rc->year, &rc->month, &rc->day, 7 * rc->interval);
+		break;
+	case CALS_FREQ_DAILY:
+		cals_recur_add_days(&rc->year, &rc->month, &rc->day, rc->interval);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Skips the occurrences before days (counted from 1970-01-01) without
+ * visiting them one by one where the steps keep their phase, so rc is left
+ * on the occurrence cals_recur_next() would reach first on or after days.
+ */
+void cals_recur_skip(struct cals_recur *rc, long long int days)
+{
+	int y, m, d;
+	long long int n;
+	long long int cur;
+	long long int step;
+
+	cur = cals_recur_days_from_civil(rc->year, rc->month, rc->day);
+	if (days <= cur)
+		return;
+
+	switch (rc->freq) {
+	case CALS_FREQ_DAILY:
+	case CALS_FREQ_WEEKLY:
+		step = rc->freq == CALS_FREQ_DAILY ? rc->interval : 7 * rc->interval;
+		n = (days - cur + step - 1) / step;
+		cals_recur_civil_from_days(cur + n * step, &rc->year, &rc->month, &rc->day);
+		return;
+	case CALS_FREQ_YEARLY:
+		/* to the last year of the phase an interval before days */
+		cals_recur_civil_from_days(days, &y, &m, &d);
+		n = (y - rc->year) / rc->interval - 1;
+		if (0 < n) {
+			rc->year += n * rc->interval;
+			while (cals_recur_days_in_month(rc->year, rc->month) < rc->mday)
+				rc->year += rc->interval;
+		}
+		break;
+	case CALS_FREQ_MONTHLY:
+		/* months missing mday shift the phase, so those are stepped */
+		if (28 < rc->mday)
+			break;
+		cals_recur_civil_from_days(days, &y, &m, &d);
+		n = ((y - rc->year) * 12 + m - rc->month) / rc->interval - 1;
+		if (0 < n)
+			_add_months(rc, n * rc->interval);
+		break;
+	default:
+		return;
+	}
+
+	while (cals_recur_days_from_civil(rc->year, rc->month, rc->day) < days)
+		cals_recur_next(rc);
+}
+
+long long int cals_recur_get_local(struct cals_recur *rc)
+{
+	return cals_recur_days_from_civil(rc->year, rc->month, rc->day) * 24 * 60 * 60 + rc->sec;
+}
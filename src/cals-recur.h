@@ -0,0 +1,50 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __CALENDAR_SVC_RECUR_H__
+#define __CALENDAR_SVC_RECUR_H__
+
+/*
+ * Civil (proleptic gregorian) date arithmetic for instance expansion.
+ * Days are counted from 1970-01-01, months are 1 ~ 12.
+ */
+#define CALS_RECUR_MIN_YEAR 1583 /* julian calendar is used before */
+
+struct cals_recur {
+	int freq; /* enum cals_freq */
+	int interval;
+	int mday; /* day of month kept by monthly and yearly */
+	int year;
+	int month;
+	int day;
+	int sec; /* seconds from the start of the day */
+};
+
+int cals_recur_days_in_month(int year, int month);
+long long int cals_recur_days_from_civil(int year, int month, int mday);
+void cals_recur_civil_from_days(long long int days, int *year, int *month, int *mday);
+int cals_recur_wday(long long int days);
+void cals_recur_add_days(int *year, int *month, int *mday, int days);
+
+int cals_recur_init(struct cals_recur *rc, int freq, int interval,
+		int year, int month, int mday, int sec);
+void cals_recur_next(struct cals_recur *rc);
+void cals_recur_skip(struct cals_recur *rc, long long int days);
+long long int cals_recur_get_local(struct cals_recur *rc);
+
+#endif /* __CALENDAR_SVC_RECUR_H__ */
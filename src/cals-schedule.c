@@ -17,6 +17,7 @@
  *
  */
 #include <errno.h>
+#include <stddef.h>
 
 #include "cals-internal.h"
 #include "cals-typedef.h"
@@ -26,25 +27,27 @@
 #include "cals-utils.h"
 #include "cals-alarm.h"
 #include "cals-schedule.h"
+#include "cals-struct.h"
 #include "cals-instance.h"
 #include "cals-time.h"
+#include "cals-arena.h"
 
 int _cals_clear_instances(int id);
 
 static inline int _cals_insert_schedule(cal_sch_full_t *record)
 {
 	int ret = -1;
-	char query[CALS_SQL_MAX_LEN] = {0};
+	int count;
+	int input_ver;
 	char dtstart_datetime[32] = {0};
 	char dtend_datetime[32] = {0};
 	sqlite3_stmt *stmt = NULL;
 
 	retv_if(NULL == record, CAL_ERR_ARG_NULL);
 
-	int input_ver = cals_get_next_ver();
+	input_ver = cals_get_next_ver();
 
-	ret = snprintf(query, sizeof(query),
-		"INSERT INTO %s ("
+	stmt = cals_query_prepare_cached("INSERT INTO "CALS_TABLE_SCHEDULE" ("
 			"account_id, type, "
 			"created_ver, changed_ver, "
 			"summary, description, location, categories, exdate, "
@@ -62,43 +65,29 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 			"dtend_type, dtend_utime, dtend_datetime, dtend_tzid, "
 			"last_mod, rrule_id "
 			") VALUES ( "
-			"%d, %d, "
-			"%d, %d, "
+			"?, ?, "
+			"?, ?, "
 			"?, ?, ?, ?, ?, "
-			"%d, "
-			"%d, %d, %d, %d, "
-			"%d, %d, %d, ?, "
-			"%d, ?, ?, %d, "
-			"?, ?, %d, "
-			"?, ?, %d, %d, "
-			"?, ?, %d, %d, "
-			"%lf, %lf, "
-			"%d, %d, "
-			"strftime('%%s', 'now'), %lld, %d, "
-			"%d, %lld, ?, ?, "
-			"%d, %lld, ?, ?, "
-			"strftime('%%s', 'now'), %d ) ",
-			CALS_TABLE_SCHEDULE,
-			record->account_id, record->cal_type,
-			input_ver, input_ver,
-			record->missed,
-			record->task_status, record->priority,	record->timezone, record->file_id,
-			record->contact_id, record->busy_status, record->sensitivity,
-			record->calendar_type, record->meeting_status,
-			record->location_type,
-			record->calendar_id, record->sync_status,
-			record->dst, record->original_event_id,
-			record->latitude, record->longitude,
-			record->email_id, record->availability,
-			record->completed_time, record->progress,
-			record->dtstart_type, record->dtstart_utime,
-			record->dtend_type, record->dtend_utime,
-			record->rrule_id);
-
-	stmt = cals_query_prepare(query);
-	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() Failed");
+			"?, "
+			"?, ?, ?, ?, "
+			"?, ?, ?, ?, "
+			"?, ?, ?, ?, "
+			"?, ?, ?, "
+			"?, ?, ?, ?, "
+			"?, ?, ?, ?, "
+			"?, ?, "
+			"?, ?, "
+			"strftime('%s', 'now'), ?, ?, "
+			"?, ?, ?, ?, "
+			"?, ?, ?, ?, "
+			"strftime('%s', 'now'), ? ) ");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
 
-	int count = 1;
+	count = 1;
+	sqlite3_bind_int(stmt, count++, record->account_id);
+	sqlite3_bind_int(stmt, count++, record->cal_type);
+	sqlite3_bind_int(stmt, count++, input_ver);
+	sqlite3_bind_int(stmt, count++, input_ver);
 
 	if (record->summary)
 		cals_stmt_bind_text(stmt, count, record->summary);
@@ -120,10 +109,21 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->exdate);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->missed);
+	sqlite3_bind_int(stmt, count++, record->task_status);
+	sqlite3_bind_int(stmt, count++, record->priority);
+	sqlite3_bind_int(stmt, count++, record->timezone);
+	sqlite3_bind_int(stmt, count++, record->file_id);
+	sqlite3_bind_int(stmt, count++, record->contact_id);
+	sqlite3_bind_int(stmt, count++, record->busy_status);
+	sqlite3_bind_int(stmt, count++, record->sensitivity);
+
 	if (record->uid)
 		cals_stmt_bind_text(stmt, count, record->uid);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->calendar_type);
+
 	if (record->organizer_name)
 		cals_stmt_bind_text(stmt, count, record->organizer_name);
 	count++;
@@ -132,6 +132,8 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->organizer_email);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->meeting_status);
+
 	if (record->gcal_id)
 		cals_stmt_bind_text(stmt, count, record->gcal_id);
 	count++;
@@ -140,6 +142,8 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->updated);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->location_type);
+
 	if (record->location_summary)
 		cals_stmt_bind_text(stmt, count, record->location_summary);
 	count++;
@@ -148,6 +152,9 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->etag);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->calendar_id);
+	sqlite3_bind_int(stmt, count++, record->sync_status);
+
 	if (record->edit_uri)
 		cals_stmt_bind_text(stmt, count, record->edit_uri);
 	count++;
@@ -156,6 +163,18 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->gevent_id);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->dst);
+	sqlite3_bind_int(stmt, count++, record->original_event_id);
+	sqlite3_bind_double(stmt, count++, record->latitude);
+	sqlite3_bind_double(stmt, count++, record->longitude);
+	sqlite3_bind_int(stmt, count++, record->email_id);
+	sqlite3_bind_int(stmt, count++, record->availability);
+	sqlite3_bind_int64(stmt, count++, record->completed_time);
+	sqlite3_bind_int(stmt, count++, record->progress);
+
+	sqlite3_bind_int(stmt, count++, record->dtstart_type);
+	sqlite3_bind_int64(stmt, count++, record->dtstart_utime);
+
 	snprintf(dtstart_datetime, sizeof(dtstart_datetime), "%04d%02d%02dT000000",
 			record->dtstart_year, record->dtstart_month, record->dtstart_mday);
 	cals_stmt_bind_text(stmt, count, dtstart_datetime);
@@ -165,6 +184,9 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->dtstart_tzid);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->dtend_type);
+	sqlite3_bind_int64(stmt, count++, record->dtend_utime);
+
 	snprintf(dtend_datetime, sizeof(dtend_datetime), "%04d%02d%02dT235959",
 			record->dtend_year, record->dtend_month, record->dtend_mday);
 	cals_stmt_bind_text(stmt, count, dtend_datetime);
@@ -174,13 +196,11 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, count, record->dtend_tzid);
 	count++;
 
+	sqlite3_bind_int(stmt, count++, record->rrule_id);
+
 	ret = cals_stmt_step(stmt);
-	if (CAL_SUCCESS != ret) {
-		sqlite3_finalize(stmt);
-		ERR("sqlite3_step() Failed(%d)", ret);
-		return ret;
-	}
-	sqlite3_finalize(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_stmt_step() Failed(%d)", ret);
 
 	return cals_last_insert_id();
 }
@@ -188,24 +208,21 @@ static inline int _cals_insert_schedule(cal_sch_full_t *record)
 static inline int _cals_insert_rrule_id(int index, cal_sch_full_t *record)
 {
 	CALS_FN_CALL;
-	int ret = -1;
-	char query[CALS_SQL_MAX_LEN] = {0};
+	int ret;
+	sqlite3_stmt *stmt;
 
 	retv_if(NULL == record, CAL_ERR_ARG_NULL);
 
-	ret = snprintf(query, sizeof(query),
-			"UPDATE %s SET "
-			"rrule_id = %d "
-			"WHERE id = %d ",
-			CALS_TABLE_SCHEDULE,
-			record->rrule_id,
-			index);
-DBG("query(%s)", query);
-	ret = cals_query_exec(query);
-	if (ret) {
-		ERR("cals_query_exec() failed (%d)", ret);
-		return ret;
-	}
+	stmt = cals_query_prepare_cached("UPDATE "CALS_TABLE_SCHEDULE" SET rrule_id = ? WHERE id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, record->rrule_id);
+	sqlite3_bind_int(stmt, 2, index);
+
+	ret = cals_stmt_step(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_stmt_step() Failed(%d)", ret);
+
 	return CAL_SUCCESS;
 }
 
@@ -213,12 +230,10 @@ static inline int _cals_insert_rrule(int index, cal_sch_full_t *record)
 {
 	int ret;
 	int cnt;
-	char query[CALS_SQL_MAX_LEN] = {0};
 	char until_datetime[32] = {0};
 	sqlite3_stmt *stmt = NULL;
 
-	snprintf(query, sizeof(query),
-			"INSERT INTO %s ( "
+	stmt = cals_query_prepare_cached("INSERT INTO "CALS_TABLE_RRULE" ( "
 			"event_id, freq, range_type, "
 			"until_type, until_utime, until_datetime, "
 			"count, interval, "
@@ -226,28 +241,30 @@ static inline int _cals_insert_rrule(int index, cal_sch_full_t *record)
 			"bymonthday, byyearday, byweekno, bymonth, "
 			"bysetpos, wkst "
 			") VALUES ( "
-			"%d, %d, %d, "
-			"%d, %lld, ?, "
-			"%d, %d, "
+			"?, ?, ?, "
+			"?, ?, ?, "
+			"?, ?, "
 			"?, ?, ?, ?, "
 			"?, ?, ?, ?, "
-			"?, %d "
-			") ",
-			CALS_TABLE_RRULE,
-			index, record->freq, record->range_type,
-			record->until_type, record->until_utime,
-			record->count, record->interval,
-			record->wkst);
-
-	stmt = cals_query_prepare(query);
+			"?, ? "
+			") ");
 	retvm_if(stmt == NULL, CAL_ERR_DB_FAILED, "Failed to query prepare");
 
 	cnt = 1;
+	sqlite3_bind_int(stmt, cnt++, index);
+	sqlite3_bind_int(stmt, cnt++, record->freq);
+	sqlite3_bind_int(stmt, cnt++, record->range_type);
+	sqlite3_bind_int(stmt, cnt++, record->until_type);
+	sqlite3_bind_int64(stmt, cnt++, record->until_utime);
+
 	snprintf(until_datetime, sizeof(until_datetime), "%04d%02d%02dT235959",
 			record->until_year, record->until_month, record->until_mday);
 	cals_stmt_bind_text(stmt, cnt, until_datetime);
 	cnt++;
 
+	sqlite3_bind_int(stmt, cnt++, record->count);
+	sqlite3_bind_int(stmt, cnt++, record->interval);
+
 	if (record->bysecond)
 		cals_stmt_bind_text(stmt, cnt, record->bysecond);
 	cnt++;
@@ -284,48 +301,54 @@ static inline int _cals_insert_rrule(int index, cal_sch_full_t *record)
 		cals_stmt_bind_text(stmt, cnt, record->bysetpos);
 	cnt++;
 
+	sqlite3_bind_int(stmt, cnt++, record->wkst);
+
 	ret = cals_stmt_step(stmt);
-	if (CAL_SUCCESS != ret) {
-		sqlite3_finalize(stmt);
-		ERR("sqlite3_step() Failed(%d)", ret);
-		return ret;
-	}
-	sqlite3_finalize(stmt);
+	cals_stmt_release(stmt);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_stmt_step() Failed(%d)", ret);
 
 	return cals_last_insert_id();
 }
 
-int cals_insert_schedule(cal_sch_full_t *sch_record)
+static inline void _cals_get_sch_time(cal_sch_full_t *sch_record,
+		struct cals_time *st, struct cals_time *et)
+{
+	st->type = sch_record->dtstart_type;
+	if (st->type == CALS_TIME_UTIME)
+		st->utime = sch_record->dtstart_utime;
+	else {
+		st->year = sch_record->dtstart_year;
+		st->month = sch_record->dtstart_month;
+		st->mday = sch_record->dtstart_mday;
+	}
+
+	et->type = sch_record->dtend_type;
+	if (et->type == CALS_TIME_UTIME)
+		et->utime = sch_record->dtend_utime;
+	else {
+		et->year = sch_record->dtend_year;
+		et->month = sch_record->dtend_month;
+		et->mday = sch_record->dtend_mday;
+	}
+}
+
+/* inserts the rows of schedule, rrule and attendees, and returns the index */
+static int _cals_insert_schedule_rows(cal_sch_full_t *sch_record)
 {
 	int ret = 0;
 	int index = 0;
 	cal_value *cvalue = NULL;
-	bool is_success = false;
-	struct cals_time st;
-	struct cals_time et;
-
-	retvm_if(NULL == sch_record, CAL_ERR_ARG_INVALID, "sch_record is NULL");
 
 	sch_record->missed = 0;
 
-	ret = cals_begin_trans();
-	retvm_if(ret, ret, "cals_begin_trans() is Failed(%d)", ret);
-
 	ret = _cals_insert_schedule(sch_record);
-	if(ret < CAL_SUCCESS) {
-		ERR("_cals_insert_schedule() Failed(%d)", ret);
-		cals_end_trans(false);
-		return ret;
-	}
+	retvm_if(ret < CAL_SUCCESS, ret, "_cals_insert_schedule() Failed(%d)", ret);
 	index = ret;
 
 	if (sch_record->freq != CALS_FREQ_ONCE) {
 		ret = _cals_insert_rrule(index, sch_record);
-		if (ret < CAL_SUCCESS) {
-			ERR("Failed in _cals_insert_rrule(%d)\n", ret);
-			cals_end_trans(false);
-			return ret;
-		}
+		retvm_if(ret < CAL_SUCCESS, ret, "Failed in _cals_insert_rrule(%d)", ret);
+
 		sch_record->rrule_id = ret;
 		DBG("added rrule_id(%d)", ret);
 		ret = _cals_insert_rrule_id(index, sch_record);
@@ -335,26 +358,6 @@ int cals_insert_schedule(cal_sch_full_t *sch_record)
 		DBG("ended add");
 	}
 
-	st.type = sch_record->dtstart_type;
-	if (st.type == CALS_TIME_UTIME)
-		st.utime = sch_record->dtstart_utime;
-	else {
-		st.year = sch_record->dtstart_year;
-		st.month = sch_record->dtstart_month;
-		st.mday = sch_record->dtstart_mday;
-	}
-
-	et.type = sch_record->dtend_type;
-	if (et.type == CALS_TIME_UTIME)
-		et.utime = sch_record->dtend_utime;
-	else {
-		et.year = sch_record->dtend_year;
-		et.month = sch_record->dtend_month;
-		et.mday = sch_record->dtend_mday;
-	}
-
-	cals_instance_insert(index, &st, &et, sch_record);
-
 	if (sch_record->attendee_list)
 	{
 		DBG("attendee exists");
@@ -379,6 +382,21 @@ int cals_insert_schedule(cal_sch_full_t *sch_record)
 		DBG("No attendee exists");
 	}
 
+	return index;
+}
+
+/* generates instances and registers alarms of the inserted schedule */
+static void _cals_insert_schedule_post(int index, cal_sch_full_t *sch_record)
+{
+	int ret;
+	cal_value *cvalue = NULL;
+	struct cals_time st;
+	struct cals_time et;
+
+	_cals_get_sch_time(sch_record, &st, &et);
+
+	cals_instance_insert(index, &st, &et, sch_record);
+
 	if (sch_record->alarm_list)
 	{
 		DBG("alarm exists");
@@ -428,6 +446,28 @@ int cals_insert_schedule(cal_sch_full_t *sch_record)
 	} else {
 		DBG("No alarm exists");
 	}
+}
+
+int cals_insert_schedule(cal_sch_full_t *sch_record)
+{
+	int ret = 0;
+	int index = 0;
+	bool is_success = false;
+
+	retvm_if(NULL == sch_record, CAL_ERR_ARG_INVALID, "sch_record is NULL");
+
+	ret = cals_begin_trans();
+	retvm_if(ret, ret, "cals_begin_trans() is Failed(%d)", ret);
+
+	ret = _cals_insert_schedule_rows(sch_record);
+	if(ret < CAL_SUCCESS) {
+		ERR("_cals_insert_schedule_rows() Failed(%d)", ret);
+		cals_end_trans(false);
+		return ret;
+	}
+	index = ret;
+
+	_cals_insert_schedule_post(index, sch_record);
 
 	cals_end_trans(true);
 	sch_record->index = index;
@@ -441,6 +481,49 @@ int cals_insert_schedule(cal_sch_full_t *sch_record)
 	return index;
 }
 
+/*
+ * Inserts all records in one transaction.
+ * The rows of every record are written first with the cached statements,
+ * then instances and alarms are made in one pass at the end.
+ * Changes are notified once by cals_end_trans().
+ */
+int cals_insert_schedule_batch(cal_sch_full_t **sch_records, int cnt, int *ids)
+{
+	int i;
+	int ret;
+
+	retv_if(NULL == sch_records, CAL_ERR_ARG_NULL);
+	retv_if(NULL == ids, CAL_ERR_ARG_NULL);
+
+	ret = cals_begin_trans();
+	retvm_if(ret, ret, "cals_begin_trans() is Failed(%d)", ret);
+
+	for (i = 0; i < cnt; i++) {
+		ret = _cals_insert_schedule_rows(sch_records[i]);
+		if (ret < CAL_SUCCESS) {
+			ERR("_cals_insert_schedule_rows(%d) Failed(%d)", i, ret);
+			cals_end_trans(false);
+			return ret;
+		}
+		ids[i] = ret;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		_cals_insert_schedule_post(ids[i], sch_records[i]);
+		sch_records[i]->index = ids[i];
+
+		if (sch_records[i]->cal_type == CALS_SCH_TYPE_EVENT)
+			cals_notify(CALS_NOTI_TYPE_EVENT);
+		else
+			cals_notify(CALS_NOTI_TYPE_TODO);
+	}
+
+	ret = cals_end_trans(true);
+	retvm_if(ret < CAL_SUCCESS, ret, "cals_end_trans() Failed(%d)", ret);
+
+	return CAL_SUCCESS;
+}
+
 static int _cals_delete_participant_info(const int index)
 {
 	int ret;
@@ -770,15 +853,12 @@ int _cals_get_rrule_id(int index, int *rrule_id)
 	return CAL_SUCCESS;
 }
 
-int cals_update_schedule(const int index, cal_sch_full_t *sch_record)
+/* updates the rows of schedule and rrule */
+static int _cals_update_schedule_rows(const int index, cal_sch_full_t *sch_record)
 {
-	bool is_success = false;
-	cal_value * cvalue = NULL;
 	int ret = 0;
 	int rrule_id = 0;
 
-	retv_if(NULL == sch_record, CAL_ERR_ARG_NULL);
-
 	sch_record->missed = 0;
 
 	ret = _cals_update_schedule(index, sch_record);
@@ -807,7 +887,18 @@ int cals_update_schedule(const int index, cal_sch_full_t *sch_record)
 		}
 	}
 
-	_cals_delete_participant_info(index);
+	return CAL_SUCCESS;
+}
+
+/*
+ * adds attendees, alarms and instances of the updated schedule,
+ * old ones should be removed before
+ */
+static void _cals_update_schedule_post(const int index, cal_sch_full_t *sch_record)
+{
+	int ret;
+	cal_value * cvalue = NULL;
+
 	if (sch_record->attendee_list)
 	{
 		GList *list = g_list_first(sch_record->attendee_list);
@@ -827,8 +918,6 @@ int cals_update_schedule(const int index, cal_sch_full_t *sch_record)
 		}
 	}
 
-	/* delete registered alarm */
-	cals_alarm_remove(CALS_ALARM_REMOVE_BY_EVENT_ID, index);
 	if (sch_record->alarm_list)
 	{
 		GList *list = sch_record->alarm_list;
@@ -858,6 +947,34 @@ int cals_update_schedule(const int index, cal_sch_full_t *sch_record)
 
 	/* TODO: re register alarm */
 
+	/* insert instance */
+	struct cals_time st;
+	struct cals_time et;
+
+	_cals_get_sch_time(sch_record, &st, &et);
+	cals_instance_insert(index, &st, &et, sch_record);
+
+	/* set notify */
+	if(sch_record->cal_type == CALS_SCH_TYPE_EVENT)
+		cals_notify(CALS_NOTI_TYPE_EVENT);
+	else
+		cals_notify(CALS_NOTI_TYPE_TODO);
+}
+
+int cals_update_schedule(const int index, cal_sch_full_t *sch_record)
+{
+	int ret = 0;
+
+	retv_if(NULL == sch_record, CAL_ERR_ARG_NULL);
+
+	ret = _cals_update_schedule_rows(index, sch_record);
+	retvm_if(CAL_SUCCESS != ret, ret, "_cals_update_schedule_rows() Failed(%d)", ret);
+
+	_cals_delete_participant_info(index);
+
+	/* delete registered alarm */
+	cals_alarm_remove(CALS_ALARM_REMOVE_BY_EVENT_ID, index);
+
 	/* clear instance */
 	ret = _cals_clear_instances(index);
 	if (ret) {
@@ -865,37 +982,121 @@ int cals_update_schedule(const int index, cal_sch_full_t *sch_record)
 		return ret;
 	}
 
-	/* insert instance */
-	struct cals_time st;
-	struct cals_time et;
+	_cals_update_schedule_post(index, sch_record);
 
-	st.type = sch_record->dtstart_type;
-	if (st.type == CALS_TIME_UTIME)
-		st.utime = sch_record->dtstart_utime;
-	else {
-		st.year = sch_record->dtstart_year;
-		st.month = sch_record->dtstart_month;
-		st.mday = sch_record->dtstart_mday;
+	return CAL_SUCCESS;
+}
+
+/* fills CALS_TABLE_TMP_IDS with ids, and returns the number of distinct ids */
+static int _cals_set_tmp_ids(const int *ids, int cnt)
+{
+	int i;
+	int ret;
+	sqlite3_stmt *stmt;
+
+	ret = cals_query_exec("CREATE TABLE IF NOT EXISTS "CALS_TABLE_TMP_IDS" (id INTEGER PRIMARY KEY)");
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_query_exec() Failed(%d)", ret);
+
+	ret = cals_query_exec("DELETE FROM "CALS_TABLE_TMP_IDS);
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_query_exec() Failed(%d)", ret);
+
+	stmt = cals_query_prepare_cached("INSERT OR IGNORE INTO "CALS_TABLE_TMP_IDS" VALUES(?)");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	for (i = 0; i < cnt; i++) {
+		sqlite3_bind_int(stmt, 1, ids[i]);
+		ret = cals_stmt_step(stmt);
+		if (CAL_SUCCESS != ret) {
+			ERR("cals_stmt_step() Failed(%d)", ret);
+			cals_stmt_release(stmt);
+			return ret;
+		}
+		sqlite3_reset(stmt);
 	}
+	cals_stmt_release(stmt);
 
-	et.type = sch_record->dtend_type;
-	if (et.type == CALS_TIME_UTIME)
-		et.utime = sch_record->dtend_utime;
-	else {
-		et.year = sch_record->dtend_year;
-		et.month = sch_record->dtend_month;
-		et.mday = sch_record->dtend_mday;
+	return cals_query_get_first_int_result("SELECT COUNT(*) FROM "CALS_TABLE_TMP_IDS);
+}
+
+static inline void _cals_clear_tmp_ids(void)
+{
+	int ret;
+
+	ret = cals_query_exec("DELETE FROM "CALS_TABLE_TMP_IDS);
+	warn_if(CAL_SUCCESS != ret, "cals_query_exec() Failed(%d)", ret);
+}
+
+/* removes instances of the events in CALS_TABLE_TMP_IDS */
+static int _cals_clear_tmp_ids_instances(void)
+{
+	int ret;
+
+	ret = cals_query_exec("DELETE FROM "CALS_TABLE_NORMAL_INSTANCE" "
+			"WHERE event_id IN (SELECT id FROM "CALS_TABLE_TMP_IDS")");
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_query_exec() Failed(%d)", ret);
+
+	ret = cals_query_exec("DELETE FROM "CALS_TABLE_ALLDAY_INSTANCE" "
+			"WHERE event_id IN (SELECT id FROM "CALS_TABLE_TMP_IDS")");
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_query_exec() Failed(%d)", ret);
+
+	ret = cals_query_exec("DELETE FROM "CALS_TABLE_INSTANCE_RANGE" "
+			"WHERE event_id IN (SELECT id FROM "CALS_TABLE_TMP_IDS")");
+	retvm_if(CAL_SUCCESS != ret, ret, "cals_query_exec() Failed(%d)", ret);
+
+	return CAL_SUCCESS;
+}
+
+/*
+ * Updates all records, should be called in a transaction.
+ * Old attendees, alarms and instances of all records are removed
+ * by one statement each.
+ */
+int cals_update_schedule_batch(cal_sch_full_t **sch_records, int cnt)
+{
+	int i;
+	int ret;
+	int *ids;
+
+	retv_if(NULL == sch_records, CAL_ERR_ARG_NULL);
+	if (cnt <= 0)
+		return CAL_SUCCESS;
+
+	ids = malloc(cnt * sizeof(int));
+	retvm_if(NULL == ids, CAL_ERR_OUT_OF_MEMORY, "malloc() Failed(%d)", errno);
+
+	for (i = 0; i < cnt; i++) {
+		ids[i] = sch_records[i]->index;
+		ret = _cals_update_schedule_rows(ids[i], sch_records[i]);
+		if (CAL_SUCCESS != ret) {
+			ERR("_cals_update_schedule_rows(%d) Failed(%d)", ids[i], ret);
+			free(ids);
+			return ret;
+		}
 	}
 
-	cals_instance_insert(index, &st, &et, sch_record);
+	ret = _cals_set_tmp_ids(ids, cnt);
+	free(ids);
+	retvm_if(ret < CAL_SUCCESS, ret, "_cals_set_tmp_ids() Failed(%d)", ret);
 
-	/* set notify */
-	if(sch_record->cal_type == CALS_SCH_TYPE_EVENT)
-		is_success= cals_notify(CALS_NOTI_TYPE_EVENT);
-	else
-		is_success= cals_notify(CALS_NOTI_TYPE_TODO);
+	ret = cals_query_exec("DELETE FROM "CALS_TABLE_PARTICIPANT" "
+			"WHERE event_id IN (SELECT id FROM "CALS_TABLE_TMP_IDS")");
+	retex_if(CAL_SUCCESS != ret, , "cals_query_exec() Failed(%d)", ret);
+
+	ret = cals_alarm_remove(CALS_ALARM_REMOVE_BY_TMP_IDS, 0);
+	retex_if(CAL_SUCCESS != ret, , "cals_alarm_remove() Failed(%d)", ret);
+
+	ret = _cals_clear_tmp_ids_instances();
+	retex_if(CAL_SUCCESS != ret, , "_cals_clear_tmp_ids_instances() Failed(%d)", ret);
+
+	_cals_clear_tmp_ids();
+
+	for (i = 0; i < cnt; i++)
+		_cals_update_schedule_post(sch_records[i]->index, sch_records[i]);
 
 	return CAL_SUCCESS;
+CATCH:
+	_cals_clear_tmp_ids();
+	return ret;
 }
 
 int _get_sch_basic_info(int id, int *cal_id, int *sch_type, int *acc_id)
@@ -997,6 +1198,12 @@ int _cals_clear_instances(int id)
 		return r;
 	}
 
+	r = cals_instance_clear_range(id);
+	if (r) {
+		ERR("cals_instance_clear_range() failed (%d)", r);
+		return r;
+	}
+
 	return CAL_SUCCESS;
 }
 
@@ -1102,13 +1309,106 @@ int cals_delete_schedule(int id)
 	return CAL_SUCCESS;
 }
 
-int cals_rearrange_schedule_field(const char *src, char *dest, int dest_size)
+/*
+ * Deletes all ids, should be called in a transaction.
+ * Each side table is handled by one statement over CALS_TABLE_TMP_IDS,
+ * and registered alarms are removed in one sweep.
+ */
+int cals_delete_schedule_batch(cals_sch_type sch_type, const int *ids, int cnt)
 {
-	int ret = 0;
-	if (strstr(src, CAL_VALUE_INT_INDEX))
-		ret += snprintf(dest+ret, dest_size-ret, ",%s", CAL_VALUE_INT_INDEX);
+	int ret;
+	int n_ids;
+	int n_type;
+	sqlite3_stmt *stmt;
+	char query[CALS_SQL_MAX_LEN];
 
-	if (strstr(src,CAL_VALUE_INT_ACCOUNT_ID))
+	retv_if(NULL == ids, CAL_ERR_ARG_NULL);
+	if (cnt <= 0)
+		return CAL_SUCCESS;
+
+	n_ids = _cals_set_tmp_ids(ids, cnt);
+	retvm_if(n_ids < CAL_SUCCESS, n_ids, "_cals_set_tmp_ids() Failed(%d)", n_ids);
+
+	stmt = cals_query_prepare_cached("SELECT COUNT(*), SUM(type = ?) "
+			"FROM "CALS_TABLE_SCHEDULE" WHERE id IN (SELECT id FROM "CALS_TABLE_TMP_IDS")");
+	retex_if(NULL == stmt, ret = CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, sch_type);
+	ret = cals_stmt_step(stmt);
+	if (CAL_TRUE != ret) {
+		ERR("cals_stmt_step() Failed(%d)", ret);
+		cals_stmt_release(stmt);
+		if (CAL_SUCCESS == ret)
+			ret = CAL_ERR_DB_FAILED;
+		goto CATCH;
+	}
+	ret = sqlite3_column_int(stmt, 0);
+	n_type = sqlite3_column_int(stmt, 1);
+	cals_stmt_release(stmt);
+	retex_if(ret != n_ids, ret = CAL_ERR_NO_DATA, "%d of %d ids are not found", n_ids - ret, n_ids);
+	retex_if(n_type != n_ids, ret = CAL_ERR_ARG_INVALID,
+			"%d of %d ids are not type(%d)", n_ids - n_type, n_ids, sch_type);
+
+	/* before the rows are gone with trg_sch_del */
+	ret = cals_alarm_remove(CALS_ALARM_REMOVE_BY_TMP_IDS, 0);
+	retex_if(CAL_SUCCESS != ret, , "cals_alarm_remove() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "INSERT INTO %s "
+			"SELECT id, type, calendar_id, %d FROM %s "
+			"WHERE id IN (SELECT id FROM %s) AND account_id = %d",
+			CALS_TABLE_DELETED, cals_get_next_ver(), CALS_TABLE_SCHEDULE,
+			CALS_TABLE_TMP_IDS, LOCAL_ACCOUNT_ID);
+	ret = cals_query_exec(query);
+	retex_if(CAL_SUCCESS != ret, , "cals_query_exec() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "DELETE FROM %s "
+			"WHERE event_id IN (SELECT id FROM %s WHERE id IN (SELECT id FROM %s) AND account_id = %d)",
+			CALS_TABLE_PARTICIPANT, CALS_TABLE_SCHEDULE, CALS_TABLE_TMP_IDS, LOCAL_ACCOUNT_ID);
+	ret = cals_query_exec(query);
+	retex_if(CAL_SUCCESS != ret, , "cals_query_exec() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "DELETE FROM %s "
+			"WHERE event_id IN (SELECT id FROM %s WHERE id IN (SELECT id FROM %s) AND account_id = %d)",
+			CALS_TABLE_RRULE, CALS_TABLE_SCHEDULE, CALS_TABLE_TMP_IDS, LOCAL_ACCOUNT_ID);
+	ret = cals_query_exec(query);
+	retex_if(CAL_SUCCESS != ret, , "cals_query_exec() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "DELETE FROM %s "
+			"WHERE id IN (SELECT id FROM %s) AND account_id = %d",
+			CALS_TABLE_SCHEDULE, CALS_TABLE_TMP_IDS, LOCAL_ACCOUNT_ID);
+	ret = cals_query_exec(query);
+	retex_if(CAL_SUCCESS != ret, , "cals_query_exec() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "UPDATE %s "
+			"SET is_deleted = 1, changed_ver = %d, last_mod = strftime('%%s','now') "
+			"WHERE id IN (SELECT id FROM %s) AND account_id <> %d",
+			CALS_TABLE_SCHEDULE, cals_get_next_ver(), CALS_TABLE_TMP_IDS, LOCAL_ACCOUNT_ID);
+	ret = cals_query_exec(query);
+	retex_if(CAL_SUCCESS != ret, , "cals_query_exec() Failed(%d)", ret);
+
+	ret = _cals_clear_tmp_ids_instances();
+	retex_if(CAL_SUCCESS != ret, , "_cals_clear_tmp_ids_instances() Failed(%d)", ret);
+
+	_cals_clear_tmp_ids();
+
+	if (CALS_SCH_TYPE_EVENT == sch_type)
+		cals_notify(CALS_NOTI_TYPE_EVENT);
+	else
+		cals_notify(CALS_NOTI_TYPE_TODO);
+
+	return CAL_SUCCESS;
+CATCH:
+	_cals_clear_tmp_ids();
+	return ret;
+}
+
+int cals_rearrange_schedule_field(const char *src, char *dest, int dest_size)
+{
+	int ret = 0;
+	if (strstr(src, CAL_VALUE_INT_INDEX))
+		ret += snprintf(dest+ret, dest_size-ret, ",%s", CAL_VALUE_INT_INDEX);
+
+	if (strstr(src,CAL_VALUE_INT_ACCOUNT_ID))
 		ret += snprintf(dest+ret, dest_size-ret, ",%s", CAL_VALUE_INT_ACCOUNT_ID);
 
 	if (strstr(src,CAL_VALUE_INT_TYPE))
@@ -1461,6 +1761,21 @@ int cals_stmt_get_filted_schedule(sqlite3_stmt *stmt,
 	return CAL_SUCCESS;
 }
 
+/* the text is carved from the arena of the record if it has one */
+static inline char *_cals_sch_column_text(sqlite3_stmt *stmt, int column, cal_sch_full_t *sch_record)
+{
+	const unsigned char *text;
+
+	text = sqlite3_column_text(stmt, column);
+	if (NULL == text)
+		return NULL;
+
+	if (sch_record->arena)
+		return cals_arena_strndup(sch_record->arena, (const char *)text,
+				sqlite3_column_bytes(stmt, column));
+
+	return strdup((const char *)text);
+}
 
 void cals_stmt_get_full_schedule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record, bool is_utc)
 {
@@ -1470,24 +1785,23 @@ void cals_stmt_get_full_schedule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record,
 	char buf[8] = {0};
 	const unsigned char *temp;
 
+	/* all strings of the record are freed at once */
+	if (NULL == sch_record->arena)
+		sch_record->arena = cals_arena_new();
+
 	sch_record->index = sqlite3_column_int(stmt, count++);
 	sch_record->account_id = sqlite3_column_int(stmt, count++);
 	sch_record->cal_type = sqlite3_column_int(stmt, count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->summary = SAFE_STRDUP(temp);
+	sch_record->summary = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->description = SAFE_STRDUP(temp);
+	sch_record->description = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->location = SAFE_STRDUP(temp);
+	sch_record->location = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->categories = SAFE_STRDUP(temp);
+	sch_record->categories = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->exdate = SAFE_STRDUP(temp);
+	sch_record->exdate = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->missed = sqlite3_column_int(stmt, count++);
 	sch_record->task_status = sqlite3_column_int(stmt, count++);
@@ -1498,42 +1812,33 @@ void cals_stmt_get_full_schedule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record,
 	sch_record->busy_status = sqlite3_column_int(stmt, count++);
 	sch_record->sensitivity = sqlite3_column_int(stmt, count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->uid = SAFE_STRDUP(temp);
+	sch_record->uid = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->calendar_type = sqlite3_column_int(stmt, count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->organizer_name = SAFE_STRDUP(temp);
+	sch_record->organizer_name = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->organizer_email = SAFE_STRDUP(temp);
+	sch_record->organizer_email = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->meeting_status = sqlite3_column_int(stmt, count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->gcal_id = SAFE_STRDUP(temp);
+	sch_record->gcal_id = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->updated = SAFE_STRDUP(temp);
+	sch_record->updated = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->location_type = sqlite3_column_int(stmt, count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->location_summary = SAFE_STRDUP(temp);
+	sch_record->location_summary = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->etag = SAFE_STRDUP(temp);
+	sch_record->etag = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->calendar_id = sqlite3_column_int(stmt, count++);
 
 	sch_record->sync_status = sqlite3_column_int(stmt, count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->edit_uri = SAFE_STRDUP(temp);
+	sch_record->edit_uri = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->gevent_id = SAFE_STRDUP(temp);
+	sch_record->gevent_id = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->dst = sqlite3_column_int(stmt, count++);
 
@@ -1561,33 +1866,29 @@ void cals_stmt_get_full_schedule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record,
 	sch_record->dtstart_utime = sqlite3_column_int64(stmt,count++);
 	temp = sqlite3_column_text(stmt, count++);
 	if (temp) {
-		dtstart_datetime = SAFE_STRDUP(temp);
+		dtstart_datetime = (char *)temp;
 		snprintf(buf, strlen("YYYY") + 1, "%s", &dtstart_datetime[0]);
 		sch_record->dtstart_year =  atoi(buf);
 		snprintf(buf, strlen("MM") + 1, "%s", &dtstart_datetime[4]);
 		sch_record->dtstart_month = atoi(buf);
 		snprintf(buf, strlen("DD") + 1, "%s", &dtstart_datetime[6]);
 		sch_record->dtstart_mday = atoi(buf);
-		if (dtstart_datetime) free(dtstart_datetime);
 	}
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->dtstart_tzid = SAFE_STRDUP(temp);
+	sch_record->dtstart_tzid = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->dtend_type = sqlite3_column_int(stmt, count++);
 	sch_record->dtend_utime = sqlite3_column_int64(stmt, count++);
 	temp = sqlite3_column_text(stmt, count++);
 	if (temp) {
-		dtend_datetime = SAFE_STRDUP(temp);
+		dtend_datetime = (char *)temp;
 		snprintf(buf, strlen("YYYY") + 1, "%s", &dtend_datetime[0]);
 		sch_record->dtend_year =  atoi(buf);
 		snprintf(buf, strlen("MM") + 1, "%s", &dtend_datetime[4]);
 		sch_record->dtend_month = atoi(buf);
 		snprintf(buf, strlen("DD") + 1, "%s", &dtend_datetime[6]);
 		sch_record->dtend_mday = atoi(buf);
-		if (dtend_datetime) free(dtend_datetime);
 	}
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->dtend_tzid = SAFE_STRDUP(temp);
+	sch_record->dtend_tzid = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->last_mod = sqlite3_column_int64(stmt,count++);
 	sch_record->rrule_id = sqlite3_column_int(stmt,count++);
@@ -1609,114 +1910,533 @@ void cals_stmt_fill_rrule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record)
 
 	temp = sqlite3_column_text(stmt, count++);
 	if (temp) {
-		until_datetime = SAFE_STRDUP(temp);
+		until_datetime = (char *)temp;
 		snprintf(buf, strlen("YYYY") + 1, "%s", &until_datetime[0]);
 		sch_record->until_year =  atoi(buf);
 		snprintf(buf, strlen("MM") + 1, "%s", &until_datetime[4]);
 		sch_record->until_month = atoi(buf);
 		snprintf(buf, strlen("DD") + 1, "%s", &until_datetime[6]);
 		sch_record->until_mday = atoi(buf);
-		if (until_datetime) free(until_datetime);
 	}
 
 	sch_record->count = sqlite3_column_int(stmt,count++);
 	sch_record->interval = sqlite3_column_int(stmt,count++);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->bysecond = SAFE_STRDUP(temp);
+	sch_record->bysecond = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->byminute = SAFE_STRDUP(temp);
+	sch_record->byminute = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->byhour = SAFE_STRDUP(temp);
+	sch_record->byhour = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->byday = SAFE_STRDUP(temp);
+	sch_record->byday = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->bymonthday = SAFE_STRDUP(temp);
+	sch_record->bymonthday = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->byyearday = SAFE_STRDUP(temp);
+	sch_record->byyearday = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->byweekno = SAFE_STRDUP(temp);
+	sch_record->byweekno = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->bymonth = SAFE_STRDUP(temp);
+	sch_record->bymonth = _cals_sch_column_text(stmt, count++, sch_record);
 
-	temp = sqlite3_column_text(stmt, count++);
-	sch_record->bysetpos = SAFE_STRDUP(temp);
+	sch_record->bysetpos = _cals_sch_column_text(stmt, count++, sch_record);
 
 	sch_record->wkst = sqlite3_column_int(stmt,count++);
 }
 
-inline char *cals_strcat(char * const dest, const char *src, int bufsize)
+int cals_get_rrule_info(int event_id, cal_sch_full_t *sch_record)
 {
-	return strncat(dest, src, bufsize - strlen(dest) -1);
+	int ret;
+	sqlite3_stmt *stmt;
+
+	retv_if(NULL == sch_record, CAL_ERR_ARG_NULL);
+
+	stmt = cals_query_prepare_cached("SELECT * FROM "CALS_TABLE_RRULE" WHERE event_id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, event_id);
+
+	ret = cals_stmt_step(stmt);
+	if (CAL_TRUE != ret) {
+		ERR("cals_stmt_step() Failed(%d)", ret);
+		cals_stmt_release(stmt);
+		if (CAL_SUCCESS == ret)
+			return CAL_ERR_DB_RECORD_NOT_FOUND;
+		return ret;
+	}
+
+	cals_stmt_fill_rrule(stmt, sch_record);
+	cals_stmt_release(stmt);
+
+	return CAL_SUCCESS;
 }
 
-void _cals_sch_search_get_cond(int fields, char * const buf, int bufsize)
+/* fills the rrule of records[i] which has the event id ids[i] */
+static int _cals_get_rrule_info_by_ids(const int *ids, int cnt, cal_sch_full_t **records)
 {
-	int first;
+	int i;
+	int ret;
+	sqlite3_stmt *stmt;
 
-	first = 1;
+	if (0 == cnt)
+		return CAL_SUCCESS;
 
-	if (fields & CALS_SEARCH_FIELD_SUMMARY) {
-		if (first)
-			first = 0;
-		else
-			cals_strcat(buf, "OR ", bufsize);
-		cals_strcat(buf, "A.summary LIKE ('%%' || :key || '%%') ", bufsize);
+	stmt = cals_query_prepare_cached("SELECT * FROM "CALS_TABLE_RRULE" "
+			"WHERE event_id IN "CALS_SQL_IN);
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	cals_stmt_bind_ids(stmt, ids, cnt);
+
+	while (CAL_TRUE == (ret = cals_stmt_step(stmt))) {
+		for (i = 0; i < cnt; i++) {
+			if (ids[i] == sqlite3_column_int(stmt, 1))
+				break;
+		}
+		if (i < cnt)
+			cals_stmt_fill_rrule(stmt, records[i]);
 	}
+	cals_stmt_release(stmt);
+	retvm_if(ret < CAL_SUCCESS, ret, "cals_stmt_step() Failed(%d)", ret);
 
-	if (fields & CALS_SEARCH_FIELD_DESCRIPTION) {
-		if (first)
-			first = 0;
-		else
-			cals_strcat(buf, "OR ", bufsize);
-		cals_strcat(buf, "A.description LIKE ('%%' || :key || '%%') ", bufsize);
+	return CAL_SUCCESS;
+}
+
+/* empties the record to read the next row into it, the arena is kept */
+void cals_sch_reset_record(cal_sch_full_t *sch_record, int type)
+{
+	struct cals_arena *arena;
+
+	cal_db_service_clear_full_record(sch_record);
+
+	arena = sch_record->arena;
+	if (CAL_STRUCT_TYPE_TODO == type)
+		cals_todo_init(sch_record);
+	else
+		cals_event_init(sch_record);
+	sch_record->arena = arena;
+}
+
+/*
+ * Reads the next page of the schedule rows of stmt.
+ * rrule, attendees and alarms of the page are fetched by one query each
+ * instead of three queries per row.
+ * A row repeated in the page (joined queries) is completed by itself.
+ */
+int cals_sch_prefetch_fill(struct cals_sch_prefetch *pf, sqlite3_stmt *stmt, int type)
+{
+	int i, j;
+	int ret;
+	int cnt;
+	int u_cnt;
+	int r_cnt;
+	int error_code;
+	int is_dup[CALS_SCH_PREFETCH_SIZE];
+	int ids[CALS_SCH_PREFETCH_SIZE];
+	int r_ids[CALS_SCH_PREFETCH_SIZE];
+	cal_sch_full_t *recs[CALS_SCH_PREFETCH_SIZE];
+	cal_sch_full_t *r_recs[CALS_SCH_PREFETCH_SIZE];
+	GList *lists[CALS_SCH_PREFETCH_SIZE];
+	cal_sch_full_t *rec;
+
+	retv_if(NULL == pf, CAL_ERR_ARG_NULL);
+	retv_if(NULL == stmt, CAL_ERR_ARG_NULL);
+
+	pf->cnt = 0;
+	pf->cursor = 0;
+
+	cnt = u_cnt = r_cnt = 0;
+	while (cnt < CALS_SCH_PREFETCH_SIZE) {
+		ret = cals_stmt_step(stmt);
+		retex_if(ret < CAL_SUCCESS, , "cals_stmt_step() Failed(%d)", ret);
+		if (CAL_SUCCESS == ret) {
+			pf->is_done = TRUE;
+			break;
+		}
+
+		rec = &pf->rec[cnt];
+		cals_sch_reset_record(rec, type);
+
+		cals_stmt_get_full_schedule(stmt, rec, true);
+
+		for (j = 0; j < u_cnt; j++) {
+			if (ids[j] == rec->index)
+				break;
+		}
+		is_dup[cnt] = (j < u_cnt);
+		pf->cnt = ++cnt;
+
+		if (is_dup[cnt - 1])
+			continue;
+
+		ids[u_cnt] = rec->index;
+		recs[u_cnt++] = rec;
+		if (0 < rec->rrule_id) {
+			r_ids[r_cnt] = rec->index;
+			r_recs[r_cnt++] = rec;
+		}
 	}
 
-	if (fields & CALS_SEARCH_FIELD_LOCATION) {
-		if (first)
-			first = 0;
-		else
-			cals_strcat(buf, "OR ", bufsize);
-		cals_strcat(buf, "A.location LIKE ('%%' || :key || '%%') ", bufsize);
+	ret = _cals_get_rrule_info_by_ids(r_ids, r_cnt, r_recs);
+	retex_if(CAL_SUCCESS != ret, , "_cals_get_rrule_info_by_ids() Failed(%d)", ret);
+
+	if (CAL_STRUCT_TYPE_SCHEDULE == type) {
+		ret = cal_db_service_get_participant_info_by_ids(ids, u_cnt, lists);
+		retex_if(CAL_SUCCESS != ret, , "cal_db_service_get_participant_info_by_ids() Failed(%d)", ret);
+		for (i = 0; i < u_cnt; i++)
+			recs[i]->attendee_list = lists[i];
+
+		ret = cals_get_alarm_info_by_ids(ids, u_cnt, lists);
+		retex_if(CAL_SUCCESS != ret, , "cals_get_alarm_info_by_ids() Failed(%d)", ret);
+		for (i = 0; i < u_cnt; i++)
+			recs[i]->alarm_list = lists[i];
+	}
+
+	for (i = 0; i < cnt; i++) {
+		if (!is_dup[i])
+			continue;
+
+		rec = &pf->rec[i];
+		if (0 < rec->rrule_id) {
+			ret = cals_get_rrule_info(rec->index, rec);
+			retex_if(CAL_SUCCESS != ret, , "cals_get_rrule_info() Failed(%d)", ret);
+		}
+		if (CAL_STRUCT_TYPE_SCHEDULE == type) {
+			cal_db_service_get_participant_info_by_index(rec->index, &rec->attendee_list, &error_code);
+			ret = cals_get_alarm_info(rec->index, &rec->alarm_list);
+			retex_if(CAL_SUCCESS != ret, , "cals_get_alarm_info() Failed(%d)", ret);
+		}
+	}
+
+	return CAL_SUCCESS;
+CATCH:
+	cals_sch_prefetch_free(pf);
+	return ret;
+}
+
+/* frees the records of the page and their arenas, is_done is kept */
+void cals_sch_prefetch_free(struct cals_sch_prefetch *pf)
+{
+	int i;
+
+	if (NULL == pf)
+		return;
+
+	/* a slot over cnt can still have the record of a longer page */
+	for (i = 0; i < CALS_SCH_PREFETCH_SIZE; i++)
+		cal_db_service_free_full_record(&pf->rec[i]);
+	pf->cnt = 0;
+	pf->cursor = 0;
+}
+
+/* strings of cal_sch_full_t, which cal_db_service_clear_full_record() frees */
+static const size_t cals_sch_str_offsets[] = {
+	offsetof(cal_sch_full_t, summary),
+	offsetof(cal_sch_full_t, description),
+	offsetof(cal_sch_full_t, location),
+	offsetof(cal_sch_full_t, categories),
+	offsetof(cal_sch_full_t, exdate),
+	offsetof(cal_sch_full_t, uid),
+	offsetof(cal_sch_full_t, organizer_name),
+	offsetof(cal_sch_full_t, organizer_email),
+	offsetof(cal_sch_full_t, gcal_id),
+	offsetof(cal_sch_full_t, updated),
+	offsetof(cal_sch_full_t, location_summary),
+	offsetof(cal_sch_full_t, etag),
+	offsetof(cal_sch_full_t, edit_uri),
+	offsetof(cal_sch_full_t, gevent_id),
+	offsetof(cal_sch_full_t, dtstart_tzid),
+	offsetof(cal_sch_full_t, dtend_tzid),
+	offsetof(cal_sch_full_t, bysecond),
+	offsetof(cal_sch_full_t, byminute),
+	offsetof(cal_sch_full_t, byhour),
+	offsetof(cal_sch_full_t, byday),
+	offsetof(cal_sch_full_t, bymonthday),
+	offsetof(cal_sch_full_t, byyearday),
+	offsetof(cal_sch_full_t, byweekno),
+	offsetof(cal_sch_full_t, bymonth),
+	offsetof(cal_sch_full_t, bysetpos),
+};
+
+static cal_value *_cals_attendee_value_dup(const cal_value *src)
+{
+	cal_value *cv;
+	cal_participant_info_t *pi;
+	const cal_participant_info_t *s = src->user_data;
+
+	cv = calloc(1, sizeof(cal_value));
+	retvm_if(NULL == cv, NULL, "calloc() Failed(%d)", errno);
+	pi = calloc(1, sizeof(cal_participant_info_t));
+	if (NULL == pi) {
+		ERR("calloc() Failed(%d)", errno);
+		free(cv);
+		return NULL;
+	}
+	cv->v_type = src->v_type;
+	cv->user_data = pi;
+
+	memcpy(pi, s, sizeof(cal_participant_info_t));
+	pi->attendee_number = SAFE_STRDUP(s->attendee_number);
+	pi->attendee_uid = SAFE_STRDUP(s->attendee_uid);
+	pi->attendee_group = SAFE_STRDUP(s->attendee_group);
+	pi->attendee_email = SAFE_STRDUP(s->attendee_email);
+	pi->attendee_delegate_uri = SAFE_STRDUP(s->attendee_delegate_uri);
+	pi->attendee_delegator_uri = SAFE_STRDUP(s->attendee_delegator_uri);
+	pi->attendee_name = SAFE_STRDUP(s->attendee_name);
+
+	return cv;
+}
+
+static cal_value *_cals_alarm_value_dup(const cal_value *src)
+{
+	cal_value *cv;
+	cal_alarm_info_t *ai;
+	const cal_alarm_info_t *s = src->user_data;
+
+	cv = calloc(1, sizeof(cal_value));
+	retvm_if(NULL == cv, NULL, "calloc() Failed(%d)", errno);
+	ai = calloc(1, sizeof(cal_alarm_info_t));
+	if (NULL == ai) {
+		ERR("calloc() Failed(%d)", errno);
+		free(cv);
+		return NULL;
+	}
+	cv->v_type = src->v_type;
+	cv->user_data = ai;
+
+	memcpy(ai, s, sizeof(cal_alarm_info_t));
+	ai->alarm_tone = SAFE_STRDUP(s->alarm_tone);
+	ai->alarm_description = SAFE_STRDUP(s->alarm_description);
+
+	return cv;
+}
+
+/* copies the values of src in order, *dest is NULL on failure */
+static int _cals_value_list_dup(GList *src, GList **dest,
+		cal_value *(*dup)(const cal_value *))
+{
+	GList *l;
+	cal_value *cv;
+
+	for (l = src; l; l = g_list_next(l)) {
+		if (NULL == l->data || NULL == ((cal_value *)l->data)->user_data)
+			continue;
+
+		cv = dup(l->data);
+		retvm_if(NULL == cv, CAL_ERR_OUT_OF_MEMORY, "dup() Failed");
+		*dest = g_list_prepend(*dest, cv);
 	}
+	*dest = g_list_reverse(*dest);
+
+	return CAL_SUCCESS;
+}
+
+/*
+ * Copies the current record of the page to sch_record.
+ * The strings and lists sch_record had are freed first, and the strings are
+ * carved from its arena, which is kept for the next row.
+ * The record stays in the page, so the same row can be got again.
+ */
+int cals_sch_prefetch_get(struct cals_sch_prefetch *pf, cal_sch_full_t *sch_record)
+{
+	int i;
+	int ret;
+	char **dest;
+	const char *src;
+	cal_sch_full_t *rec;
+	struct cals_arena *arena;
+
+	retv_if(NULL == pf, CAL_ERR_ARG_NULL);
+	retv_if(NULL == sch_record, CAL_ERR_ARG_NULL);
+	retv_if(pf->cursor < 1 || pf->cnt < pf->cursor, CAL_ERR_NO_DATA);
 
-	if (fields & CALS_SEARCH_FIELD_ATTENDEE) {
-		if (first)
-			first = 0;
+	rec = &pf->rec[pf->cursor - 1];
+
+	cal_db_service_clear_full_record(sch_record);
+	if (NULL == sch_record->arena)
+		sch_record->arena = cals_arena_new();
+	arena = sch_record->arena;
+
+	memcpy(sch_record, rec, sizeof(cal_sch_full_t));
+	sch_record->arena = arena;
+	sch_record->attendee_list = NULL;
+	sch_record->alarm_list = NULL;
+	sch_record->exception_date_list = NULL;
+
+	for (i = 0; i < sizeof(cals_sch_str_offsets) / sizeof(cals_sch_str_offsets[0]); i++) {
+		dest = (char **)((char *)sch_record + cals_sch_str_offsets[i]);
+		src = *dest;
+		if (NULL == src)
+			continue;
+
+		if (arena)
+			*dest = cals_arena_strndup(arena, src, strlen(src));
 		else
-			cals_strcat(buf, "OR ", bufsize);
-		cals_strcat(buf, "B.attendee_name LIKE ('%%' || :key || '%%') ", bufsize);
+			*dest = strdup(src);
+
+		if (NULL == *dest) {
+			ERR("Failed to copy the strings of the record");
+			/* the rest still point to rec */
+			for (i++; i < sizeof(cals_sch_str_offsets) / sizeof(cals_sch_str_offsets[0]); i++)
+				*(char **)((char *)sch_record + cals_sch_str_offsets[i]) = NULL;
+			cal_db_service_clear_full_record(sch_record);
+			return CAL_ERR_OUT_OF_MEMORY;
+		}
+	}
+
+	ret = _cals_value_list_dup(rec->attendee_list, &sch_record->attendee_list,
+			_cals_attendee_value_dup);
+	if (CAL_SUCCESS == ret)
+		ret = _cals_value_list_dup(rec->alarm_list, &sch_record->alarm_list,
+				_cals_alarm_value_dup);
+	if (CAL_SUCCESS != ret) {
+		ERR("Failed to copy the lists of the record(%d)", ret);
+		cal_db_service_clear_full_record(sch_record);
+		return ret;
 	}
 
-	return;
+	return CAL_SUCCESS;
 }
 
-int cals_sch_search(cals_sch_type sch_type, int fields, const char *keyword, cal_iter **iter)
+/* steps to the next record, the next page is read when needed */
+int cals_sch_prefetch_next(struct cals_sch_prefetch *pf, sqlite3_stmt *stmt, int type)
 {
-	cal_iter *it;
-	sqlite3_stmt *stmt;
-	char query[CALS_SQL_MAX_LEN] = {0};
-	char cond[CALS_SQL_MIN_LEN] = {0};
+	int ret;
 
-	_cals_sch_search_get_cond(fields, cond, sizeof(cond));
-	snprintf(query, sizeof(query), "SELECT A.* "
-			"FROM %s A LEFT JOIN %s B ON A.id = B.event_id "
-			"JOIN %s C ON A.calendar_id = C.ROWID "
-			"WHERE A.type = %d AND (%s) AND C.visibility = 1",
-			CALS_TABLE_SCHEDULE, CALS_TABLE_PARTICIPANT, CALS_TABLE_CALENDAR, sch_type, cond);
-	DBG("QUERY [%s]", query);
+	retv_if(NULL == pf, CAL_ERR_ARG_NULL);
 
-	stmt = cals_query_prepare(query);
-	retvm_if (!stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() failed");
+	if (pf->cursor == pf->cnt) {
+		if (pf->is_done)
+			return CAL_ERR_FINISH_ITER;
+
+		ret = cals_sch_prefetch_fill(pf, stmt, type);
+		retvm_if(CAL_SUCCESS != ret, ret, "cals_sch_prefetch_fill() Failed(%d)", ret);
+
+		if (0 == pf->cnt)
+			return CAL_ERR_FINISH_ITER;
+	}
+	pf->cursor++;
+
+	return CAL_SUCCESS;
+}
+
+static const struct {
+	int field;
+	const char *column; /* of the search index */
+	const char *like; /* substring match of a non ASCII keyword */
+} cals_search_columns[] = {
+	{CALS_SEARCH_FIELD_SUMMARY, "summary", "A.summary LIKE :key ESCAPE '\\'"},
+	{CALS_SEARCH_FIELD_DESCRIPTION, "description", "A.description LIKE :key ESCAPE '\\'"},
+	{CALS_SEARCH_FIELD_LOCATION, "location", "A.location LIKE :key ESCAPE '\\'"},
+	{CALS_SEARCH_FIELD_ATTENDEE, "attendee", "A.id IN (SELECT event_id FROM "CALS_TABLE_PARTICIPANT" "
+		"WHERE attendee_name LIKE :key ESCAPE '\\')"},
+};
+
+#define CALS_SEARCH_FIELD_ALL (CALS_SEARCH_FIELD_SUMMARY | CALS_SEARCH_FIELD_DESCRIPTION \
+		| CALS_SEARCH_FIELD_LOCATION | CALS_SEARCH_FIELD_ATTENDEE)
+
+/* bytes of the text kept on each side of the keyword in a snippet of a LIKE match */
+#define CALS_SEARCH_SNIPPET_AROUND 30
+
+/*
+ * The simple tokenizer of the index splits words at ASCII separators only,
+ * so a CJK or Hangul keyword is usually the middle of a longer token and
+ * can not be found by MATCH. Keywords having non ASCII characters are
+ * matched as a substring of the fields by LIKE instead, like before the
+ * index was added: those searches scan the table and are not ranked.
+ */
+static inline bool _cals_sch_search_is_ascii(const char *keyword)
+{
+	for (; *keyword; keyword++) {
+		if (0x80 & *(const unsigned char *)keyword)
+			return false;
+	}
+	return true;
+}
+
+/* "%keyword%" with LIKE wildcards of the keyword escaped by '\' */
+static void _cals_sch_search_get_like(const char *keyword, char *buf, int bufsize)
+{
+	int len;
+
+	buf[0] = '%';
+	len = 1 + cals_escape_like_pattern(keyword, buf + 1, bufsize - 2);
+	buf[len++] = '%';
+	buf[len] = '\0';
+}
+
+static void _cals_sch_search_get_like_cond(int fields, char *buf, int bufsize)
+{
+	int i;
+	int len;
+
+	len = snprintf(buf, bufsize, "AND (");
+	for (i = 0; i < sizeof(cals_search_columns) / sizeof(cals_search_columns[0]); i++) {
+		if (0 == (fields & cals_search_columns[i].field) || bufsize <= len)
+			continue;
+		len += snprintf(buf + len, bufsize - len, "%s%s ",
+				(5 < len) ? "OR " : "", cals_search_columns[i].like);
+	}
+	if (len < bufsize)
+		snprintf(buf + len, bufsize - len, ")");
+}
+
+/*
+ * The keyword is matched as a phrase whose last token is a prefix,
+ * e.g. "team mee*" for search as you type.
+ * Returns -1 if no token is left.
+ */
+static int _cals_sch_search_get_match(const char *keyword, char *buf, int bufsize)
+{
+	int i;
+	int len;
+
+	len = 0;
+	buf[len++] = '"';
+	for (i = 0; keyword[i] && len < bufsize - 3; i++)
+		buf[len++] = ('"' == keyword[i] || '*' == keyword[i]) ? ' ' : keyword[i];
+
+	while (1 < len && ' ' == buf[len - 1])
+		len--;
+	if (1 == len)
+		return -1;
+
+	buf[len++] = '*';
+	buf[len++] = '"';
+	buf[len] = '\0';
+
+	return 0;
+}
+
+/*
+ * fts4 does not filter a phrase by column in the MATCH expression,
+ * so the docids are restricted by the column MATCH of each field.
+ */
+static void _cals_sch_search_get_cond(int fields, char *buf, int bufsize)
+{
+	int i;
+	int len;
+
+	buf[0] = '\0';
+	if (CALS_SEARCH_FIELD_ALL == (fields & CALS_SEARCH_FIELD_ALL))
+		return;
+
+	len = snprintf(buf, bufsize, "AND (");
+	for (i = 0; i < sizeof(cals_search_columns) / sizeof(cals_search_columns[0]); i++) {
+		if (0 == (fields & cals_search_columns[i].field) || bufsize <= len)
+			continue;
+		len += snprintf(buf + len, bufsize - len,
+				"%s"CALS_TABLE_SEARCH".docid IN "
+				"(SELECT docid FROM "CALS_TABLE_SEARCH" WHERE %s MATCH :key) ",
+				(5 < len) ? "OR " : "", cals_search_columns[i].column);
+	}
+	if (len < bufsize)
+		snprintf(buf + len, bufsize - len, ")");
+}
+
+static int _cals_sch_search_new_iter(sqlite3_stmt *stmt, const char *match, cal_iter **iter)
+{
+	cal_iter *it;
 
-	sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":key"), keyword, strlen(keyword), SQLITE_TRANSIENT);
+	sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":key"), match, strlen(match), SQLITE_TRANSIENT);
 
 	it = calloc(1, sizeof(cal_iter));
 	if (!it) {
@@ -1732,35 +2452,191 @@ int cals_sch_search(cals_sch_type sch_type, int fields, const char *keyword, cal
 	return CAL_SUCCESS;
 }
 
+/* one row per schedule from the full text index, the best ranked first */
+int cals_sch_search(cals_sch_type sch_type, int fields, const char *keyword, cal_iter **iter)
+{
+	int ret;
+	sqlite3_stmt *stmt;
+	char query[CALS_SQL_MAX_LEN] = {0};
+	char cond[CALS_SQL_MAX_LEN] = {0};
+	char match[CALS_SQL_MIN_LEN];
+
+	retv_if(NULL == keyword, CAL_ERR_ARG_NULL);
+	retv_if(NULL == iter, CAL_ERR_ARG_NULL);
+	retv_if(0 == (fields & CALS_SEARCH_FIELD_ALL), CAL_ERR_ARG_INVALID);
+
+	if (!_cals_sch_search_is_ascii(keyword)) {
+		_cals_sch_search_get_like(keyword, match, sizeof(match));
+		_cals_sch_search_get_like_cond(fields, cond, sizeof(cond));
+		snprintf(query, sizeof(query), "SELECT A.* "
+				"FROM %s A JOIN %s C ON A.calendar_id = C.ROWID "
+				"WHERE A.type = %d AND C.visibility = 1 %s"
+				"ORDER BY A.summary LIKE :key ESCAPE '\\' DESC, A.id",
+				CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR, sch_type, cond);
+		DBG("QUERY [%s]", query);
+
+		stmt = cals_query_prepare(query);
+		retvm_if (!stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() failed");
+
+		return _cals_sch_search_new_iter(stmt, match, iter);
+	}
+
+	ret = _cals_sch_search_get_match(keyword, match, sizeof(match));
+	retvm_if(ret < 0, CAL_ERR_ARG_INVALID, "keyword(%s) has no word", keyword);
+
+	_cals_sch_search_get_cond(fields, cond, sizeof(cond));
+	snprintf(query, sizeof(query), "SELECT A.* "
+			"FROM %s JOIN %s A ON A.id = %s.docid "
+			"JOIN %s C ON A.calendar_id = C.ROWID "
+			"WHERE %s MATCH :key AND A.type = %d AND C.visibility = 1 %s"
+			"ORDER BY cals_rank(matchinfo(%s, 'pcnalx')) DESC",
+			CALS_TABLE_SEARCH, CALS_TABLE_SCHEDULE, CALS_TABLE_SEARCH,
+			CALS_TABLE_CALENDAR, CALS_TABLE_SEARCH, sch_type, cond, CALS_TABLE_SEARCH);
+	DBG("QUERY [%s]", query);
+
+	stmt = cals_query_prepare(query);
+	retvm_if (!stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() failed");
+
+	return _cals_sch_search_new_iter(stmt, match, iter);
+}
+
 API int calendar_svc_smartsearch_excl(const char *keyword, int offset, int limit, cal_iter **iter)
 {
-	cal_iter *it;
+	int ret;
 	sqlite3_stmt *stmt;
 	char query[CALS_SQL_MAX_LEN] = {0};
-	char buf[1024] = {0};
+	char match[CALS_SQL_MIN_LEN];
+
+	retv_if(NULL == keyword, CAL_ERR_ARG_NULL);
+	retv_if(NULL == iter, CAL_ERR_ARG_NULL);
+
+	if (!_cals_sch_search_is_ascii(keyword)) {
+		_cals_sch_search_get_like(keyword, match, sizeof(match));
+		snprintf(query, sizeof(query), "SELECT A.* "
+				"FROM %s A JOIN %s B ON A.calendar_id = B.ROWID "
+				"WHERE A.summary LIKE :key ESCAPE '\\' AND B.visibility = 1 "
+				"ORDER BY A.id LIMIT %d OFFSET %d",
+				CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR, limit, offset);
+
+		stmt = cals_query_prepare(query);
+		retvm_if (!stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() failed");
+
+		return _cals_sch_search_new_iter(stmt, match, iter);
+	}
+
+	ret = _cals_sch_search_get_match(keyword, match, sizeof(match));
+	retvm_if(ret < 0, CAL_ERR_ARG_INVALID, "keyword(%s) has no word", keyword);
 
 	snprintf(query, sizeof(query), "SELECT A.* "
-			"FROM %s A LEFT JOIN %s B ON A.calendar_id = B.ROWID "
-			"WHERE A.summary LIKE ('%%' || :key || '%%') "
-			"AND B.visibility = 1 LIMIT %d OFFSET %d",
-			CALS_TABLE_SCHEDULE, CALS_TABLE_CALENDAR, limit, offset);
+			"FROM %s JOIN %s A ON A.id = %s.docid "
+			"JOIN %s B ON A.calendar_id = B.ROWID "
+			"WHERE %s.summary MATCH :key AND B.visibility = 1 "
+			"ORDER BY cals_rank(matchinfo(%s, 'pcnalx')) DESC "
+			"LIMIT %d OFFSET %d",
+			CALS_TABLE_SEARCH, CALS_TABLE_SCHEDULE, CALS_TABLE_SEARCH,
+			CALS_TABLE_CALENDAR, CALS_TABLE_SEARCH, CALS_TABLE_SEARCH, limit, offset);
 
 	stmt = cals_query_prepare(query);
 	retvm_if (!stmt, CAL_ERR_DB_FAILED, "cals_query_prepare() failed");
 
-	cals_escape_like_pattern(keyword, buf, sizeof(buf));
-	sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, ":key"), buf, strlen(buf), SQLITE_TRANSIENT);
+	return _cals_sch_search_new_iter(stmt, match, iter);
+}
 
-	it = calloc(1, sizeof(cal_iter));
-	if (!it) {
-		sqlite3_finalize(stmt);
-		ERR("calloc() failed(%d)", errno);
+/* the first field having the keyword, cut around it on character boundaries */
+static int _cals_sch_search_get_like_snippet(int index, const char *keyword, char **snippet)
+{
+	int i;
+	int ret;
+	int len;
+	int size;
+	const char *text;
+	const char *hit;
+	const char *start;
+	const char *end;
+	sqlite3_stmt *stmt;
+
+	stmt = cals_query_prepare_cached("SELECT summary, description, location, "
+			"(SELECT group_concat(attendee_name, ' ') FROM "CALS_TABLE_PARTICIPANT" "
+			"WHERE event_id = A.id) "
+			"FROM "CALS_TABLE_SCHEDULE" A WHERE id = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_int(stmt, 1, index);
+
+	ret = cals_stmt_step(stmt);
+	if (CAL_TRUE != ret) {
+		cals_stmt_release(stmt);
+		retvm_if(ret < CAL_SUCCESS, ret, "cals_stmt_step() Failed(%d)", ret);
+		return CAL_ERR_NO_DATA;
+	}
+
+	hit = NULL;
+	for (i = 0; i < 4 && NULL == hit; i++) {
+		text = (const char *)sqlite3_column_text(stmt, i);
+		if (text)
+			hit = strstr(text, keyword);
+	}
+	if (NULL == hit) {
+		cals_stmt_release(stmt);
+		return CAL_ERR_NO_DATA;
+	}
+
+	len = strlen(keyword);
+	start = (CALS_SEARCH_SNIPPET_AROUND < hit - text) ? hit - CALS_SEARCH_SNIPPET_AROUND : text;
+	while (text < start && 0x80 == (0xc0 & *(const unsigned char *)start))
+		start--;
+	end = hit + len;
+	for (i = 0; *end && (i < CALS_SEARCH_SNIPPET_AROUND
+				|| 0x80 == (0xc0 & *(const unsigned char *)end)); i++)
+		end++;
+
+	size = sizeof("...<b></b>...") + (end - start);
+	*snippet = malloc(size);
+	if (NULL == *snippet) {
+		ERR("malloc() Failed");
+		cals_stmt_release(stmt);
 		return CAL_ERR_OUT_OF_MEMORY;
 	}
+	snprintf(*snippet, size, "%s%.*s<b>%.*s</b>%.*s%s", (text < start) ? "..." : "",
+			(int)(hit - start), start, len, hit, (int)(end - hit - len), hit + len,
+			*end ? "..." : "");
+	cals_stmt_release(stmt);
 
-	it->i_type = CAL_STRUCT_TYPE_SCHEDULE;
-	it->stmt = stmt;
-	*iter = it;
+	return CAL_SUCCESS;
+}
+
+API int calendar_svc_search_get_snippet(int index, const char *keyword, char **snippet)
+{
+	int ret;
+	sqlite3_stmt *stmt;
+	char match[CALS_SQL_MIN_LEN];
+
+	retv_if(NULL == keyword, CAL_ERR_ARG_NULL);
+	retv_if(NULL == snippet, CAL_ERR_ARG_NULL);
+
+	if (!_cals_sch_search_is_ascii(keyword))
+		return _cals_sch_search_get_like_snippet(index, keyword, snippet);
+
+	ret = _cals_sch_search_get_match(keyword, match, sizeof(match));
+	retvm_if(ret < 0, CAL_ERR_ARG_INVALID, "keyword(%s) has no word", keyword);
+
+	stmt = cals_query_prepare_cached("SELECT snippet("CALS_TABLE_SEARCH", '<b>', '</b>', '...', -1, 10) "
+			"FROM "CALS_TABLE_SEARCH" WHERE "CALS_TABLE_SEARCH" MATCH ? AND docid = ?");
+	retvm_if(NULL == stmt, CAL_ERR_DB_FAILED, "cals_query_prepare_cached() Failed");
+
+	sqlite3_bind_text(stmt, 1, match, strlen(match), SQLITE_TRANSIENT);
+	sqlite3_bind_int(stmt, 2, index);
+
+	ret = cals_stmt_step(stmt);
+	if (CAL_TRUE != ret) {
+		cals_stmt_release(stmt);
+		retvm_if(ret < CAL_SUCCESS, ret, "cals_stmt_step() Failed(%d)", ret);
+		return CAL_ERR_NO_DATA;
+	}
+
+	*snippet = SAFE_STRDUP(sqlite3_column_text(stmt, 0));
+	cals_stmt_release(stmt);
+	retvm_if(NULL == *snippet, CAL_ERR_OUT_OF_MEMORY, "strdup() Failed");
 
 	return CAL_SUCCESS;
 }
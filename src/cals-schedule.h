@@ -28,8 +28,11 @@
  *				CAL_ERR_DB_RECORD_NOT_FOUND, CAL_ERR_DB_FAILED
  */
 int cals_insert_schedule(cal_sch_full_t *sch_record);
+int cals_insert_schedule_batch(cal_sch_full_t **sch_records, int cnt, int *ids);
 int cals_update_schedule(const int index, cal_sch_full_t *sch_record);
 int cals_delete_schedule(const int index);
+int cals_update_schedule_batch(cal_sch_full_t **sch_records, int cnt);
+int cals_delete_schedule_batch(cals_sch_type sch_type, const int *ids, int cnt);
 int cals_sch_search(cals_sch_type sch_type, int fields, const char *keyword, cal_iter **iter);
 
 int cals_rearrange_schedule_field(const char *src, char *dest, int dest_size);
@@ -37,6 +40,23 @@ int cals_rearrange_schedule_field(const char *src, char *dest, int dest_size);
 int cals_stmt_get_filted_schedule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record, const char *select_field);
 void cals_stmt_get_full_schedule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record, bool is_utc);
 void cals_stmt_fill_rrule(sqlite3_stmt *stmt,cal_sch_full_t *sch_record);
+int cals_get_rrule_info(int event_id, cal_sch_full_t *sch_record);
+
+#define CALS_SCH_PREFETCH_SIZE 64
+
+/* a page of schedule rows read ahead from an iterator */
+struct cals_sch_prefetch {
+	int cnt;
+	int cursor; /* rec[cursor - 1] is the current record */
+	int is_done;
+	cal_sch_full_t rec[CALS_SCH_PREFETCH_SIZE];
+};
+
+void cals_sch_reset_record(cal_sch_full_t *sch_record, int type);
+int cals_sch_prefetch_fill(struct cals_sch_prefetch *pf, sqlite3_stmt *stmt, int type);
+int cals_sch_prefetch_next(struct cals_sch_prefetch *pf, sqlite3_stmt *stmt, int type);
+int cals_sch_prefetch_get(struct cals_sch_prefetch *pf, cal_sch_full_t *sch_record);
+void cals_sch_prefetch_free(struct cals_sch_prefetch *pf);
 
 #endif /* __CALENDAR_SVC_SCHEDULE_H__ */
 
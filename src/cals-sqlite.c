@@ -16,6 +16,11 @@
  * limitations under the License.
  *
  */
+#include <time.h>
+#include <strings.h>
+#include <math.h>
+#include <unistd.h>
+#include <glib.h>
 #include <db-util.h>
 
 #include "cals-internal.h"
@@ -23,12 +28,227 @@
 #include "cals-db-info.h"
 #include "cals-sqlite.h"
 
+#define CALS_STMT_CACHE_SIZE 64
+#define CALS_RANK_K1 1.2
+#define CALS_RANK_B 0.75
+
+struct cals_stmt_cache {
+	const char *query;
+	sqlite3_stmt *stmt;
+	int in_use;
+};
+
+struct cals_lock_wait {
+	int min_usec;
+	int max_usec;
+	int deadline_msec;
+};
+
 #ifdef CALS_IPC_SERVER
 __thread sqlite3 *calendar_db_handle;
+static __thread struct cals_stmt_cache stmt_cache[CALS_STMT_CACHE_SIZE];
+static __thread long long int lock_wait_start;
 #else
 sqlite3 *calendar_db_handle;
+static struct cals_stmt_cache stmt_cache[CALS_STMT_CACHE_SIZE];
+static long long int lock_wait_start;
 #endif
 
+static struct cals_lock_wait lock_wait = {
+	.min_usec = CALS_DB_LOCK_WAIT_MIN,
+	.max_usec = CALS_DB_LOCK_WAIT_MAX,
+	.deadline_msec = CALS_DB_LOCK_DEADLINE,
+};
+static volatile int lock_waits;
+static volatile int lock_timeouts;
+
+static inline long long int _cals_get_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+/*
+ * Called by sqlite while the DB is locked by another connection.
+ * The sleep starts at min_usec and doubles up to max_usec,
+ * and the wait gives up (SQLITE_BUSY) after deadline_msec.
+ */
+static int _cals_db_busy_handler(void *data, int count)
+{
+	int i;
+	long long int now;
+	long long int left;
+	long long int delay;
+
+	now = _cals_get_usec();
+	if (0 == count) {
+		lock_wait_start = now;
+		g_atomic_int_inc(&lock_waits);
+	}
+
+	left = lock_wait.deadline_msec * 1000LL - (now - lock_wait_start);
+	if (left <= 0) {
+		g_atomic_int_inc(&lock_timeouts);
+		WARN("DB lock wait timed out after %d tries", count);
+		return 0;
+	}
+
+	delay = lock_wait.min_usec;
+	for (i = 0; i < count && delay < lock_wait.max_usec; i++)
+		delay *= 2;
+	if (lock_wait.max_usec < delay)
+		delay = lock_wait.max_usec;
+	if (left < delay)
+		delay = left;
+
+	usleep(delay);
+	return 1;
+}
+
+API int calendar_svc_set_lock_wait(int min_usec, int max_usec, int deadline_msec)
+{
+	retv_if(min_usec <= 0, CAL_ERR_ARG_INVALID);
+	retv_if(max_usec < min_usec, CAL_ERR_ARG_INVALID);
+	retv_if(deadline_msec < 0, CAL_ERR_ARG_INVALID);
+
+	lock_wait.min_usec = min_usec;
+	lock_wait.max_usec = max_usec;
+	lock_wait.deadline_msec = deadline_msec;
+
+	return CAL_SUCCESS;
+}
+
+API int calendar_svc_get_lock_stats(int *waits, int *timeouts)
+{
+	retv_if(NULL == waits, CAL_ERR_ARG_NULL);
+	retv_if(NULL == timeouts, CAL_ERR_ARG_NULL);
+
+	*waits = g_atomic_int_get(&lock_waits);
+	*timeouts = g_atomic_int_get(&lock_timeouts);
+
+	return CAL_SUCCESS;
+}
+
+static void _cals_stmt_cache_clear(void)
+{
+	int i;
+
+	for (i = 0; i < CALS_STMT_CACHE_SIZE; i++) {
+		if (NULL == stmt_cache[i].stmt)
+			continue;
+		warn_if(stmt_cache[i].in_use, "cached stmt(%s) is still in use", stmt_cache[i].query);
+		sqlite3_finalize(stmt_cache[i].stmt);
+		stmt_cache[i].stmt = NULL;
+		stmt_cache[i].query = NULL;
+		stmt_cache[i].in_use = 0;
+	}
+}
+
+/* the journal mode is kept in the DB file, see calendar-svc-initdb */
+static bool _cals_db_is_wal(sqlite3 *db)
+{
+	int ret;
+	bool is_wal;
+	sqlite3_stmt *stmt;
+
+	ret = sqlite3_prepare_v2(db, "PRAGMA journal_mode", -1, &stmt, NULL);
+	retvm_if(SQLITE_OK != ret, false, "sqlite3_prepare_v2() Failed(%s)", sqlite3_errmsg(db));
+
+	is_wal = false;
+	if (SQLITE_ROW == sqlite3_step(stmt))
+		is_wal = !strcasecmp("wal", (const char *)sqlite3_column_text(stmt, 0));
+	sqlite3_finalize(stmt);
+
+	return is_wal;
+}
+
+/*
+ * Per connection settings of a DB in WAL mode.
+ * The WAL and shm files are kept on close, so the group and permission
+ * calendar-svc-initdb gave them are not lost by recreating them,
+ * and the WAL is truncated to journal_size_limit instead.
+ */
+static void _cals_db_set_profile(sqlite3 *db)
+{
+	int ret;
+	int persist = 1;
+	char *errmsg = NULL;
+	char query[CALS_SQL_MIN_LEN];
+
+	ret = sqlite3_file_control(db, NULL, SQLITE_FCNTL_PERSIST_WAL, &persist);
+	warn_if(SQLITE_OK != ret, "sqlite3_file_control(PERSIST_WAL) Failed(%d)", ret);
+
+	snprintf(query, sizeof(query),
+			"PRAGMA synchronous = NORMAL;"
+			"PRAGMA cache_size = %d;"
+			"PRAGMA temp_store = MEMORY;"
+			"PRAGMA mmap_size = %d;"
+			"PRAGMA journal_size_limit = %d;",
+			CALS_DB_CACHE_SIZE, CALS_DB_MMAP_SIZE, CALS_DB_WAL_SIZE_LIMIT);
+
+	ret = sqlite3_exec(db, query, NULL, NULL, &errmsg);
+	if (SQLITE_OK != ret) {
+		ERR("sqlite3_exec(%s) Failed(%d, %s)", query, ret, errmsg);
+		sqlite3_free(errmsg);
+	}
+}
+
+/* weight of summary, description, location, attendee in the search index */
+static const double cals_rank_weight[] = {4.0, 1.0, 2.0, 1.0};
+
+/*
+ * Okapi BM25 of a match in the search index,
+ * argument is matchinfo() of the 'pcnalx' format.
+ */
+static void _cals_db_rank(sqlite3_context *ctx, int argc, sqlite3_value **argv)
+{
+	int i, j;
+	int p, c, n;
+	double idf;
+	double tf;
+	double score;
+	const unsigned int *a, *l, *x;
+
+	if (argc < 1 || sqlite3_value_bytes(argv[0]) < 3 * sizeof(unsigned int)) {
+		sqlite3_result_double(ctx, 0.0);
+		return;
+	}
+
+	a = sqlite3_value_blob(argv[0]);
+	p = a[0];
+	c = a[1];
+	n = a[2];
+	if (sqlite3_value_bytes(argv[0]) < (3 + 2 * c + 3 * p * c) * sizeof(unsigned int)) {
+		sqlite3_result_double(ctx, 0.0);
+		return;
+	}
+	l = a + 3 + c;
+	x = a + 3 + 2 * c;
+
+	score = 0.0;
+	for (i = 0; i < p; i++) {
+		for (j = 0; j < c; j++) {
+			/* hits in this row, hits in all rows, rows having hits */
+			tf = x[3 * (i * c + j)];
+			if (0.0 == tf)
+				continue;
+
+			idf = log((n - x[3 * (i * c + j) + 2] + 0.5) / (x[3 * (i * c + j) + 2] + 0.5));
+			if (idf < 1e-6)
+				idf = 1e-6;
+
+			score += ((j < sizeof(cals_rank_weight) / sizeof(double)) ? cals_rank_weight[j] : 1.0)
+				* idf * tf * (CALS_RANK_K1 + 1.0)
+				/ (tf + CALS_RANK_K1 * (1.0 - CALS_RANK_B
+							+ CALS_RANK_B * l[j] / (a[3 + j] ? a[3 + j] : 1)));
+		}
+	}
+
+	sqlite3_result_double(ctx, score);
+}
+
 int cals_db_open(void)
 {
 	int ret;
@@ -37,6 +257,15 @@ int cals_db_open(void)
 		ret = db_util_open(CALS_DB_PATH, &calendar_db_handle, 0);
 		retvm_if(SQLITE_OK != ret, CAL_ERR_DB_NOT_OPENED,
 				"db_util_open() Failed(%d).", ret);
+
+		sqlite3_busy_handler(calendar_db_handle, _cals_db_busy_handler, NULL);
+
+		ret = sqlite3_create_function(calendar_db_handle, "cals_rank", 1, SQLITE_UTF8, NULL,
+				_cals_db_rank, NULL, NULL);
+		warn_if(SQLITE_OK != ret, "sqlite3_create_function(cals_rank) Failed(%d)", ret);
+
+		if (_cals_db_is_wal(calendar_db_handle))
+			_cals_db_set_profile(calendar_db_handle);
 	}
 	return CAL_SUCCESS;
 }
@@ -46,6 +275,7 @@ int cals_db_close(void)
 	int ret = 0;
 
 	if (calendar_db_handle) {
+		_cals_stmt_cache_clear();
 		ret = db_util_close(calendar_db_handle);
 		warn_if(SQLITE_OK != ret, "db_util_close() Failed(%d)", ret);
 		calendar_db_handle = NULL;
@@ -129,6 +359,69 @@ sqlite3_stmt* cals_query_prepare(char *query)
 	return stmt;
 }
 
+/*
+ * The query must be a constant template (compared by address first),
+ * parameters have to be bound with sqlite3_bind_xxx().
+ * The statement must be given back with cals_stmt_release().
+ */
+sqlite3_stmt* cals_query_prepare_cached(const char *query)
+{
+	int i;
+	int ret;
+	int empty = -1;
+	sqlite3_stmt *stmt = NULL;
+
+	retvm_if(NULL == query, NULL, "Invalid query");
+	retvm_if(NULL == calendar_db_handle, NULL, "Database is not opended");
+
+	for (i = 0; i < CALS_STMT_CACHE_SIZE; i++) {
+		if (NULL == stmt_cache[i].stmt) {
+			if (empty < 0)
+				empty = i;
+			continue;
+		}
+		if (stmt_cache[i].query != query && strcmp(stmt_cache[i].query, query))
+			continue;
+
+		/* nested use of the same template gets an uncached stmt */
+		if (stmt_cache[i].in_use)
+			break;
+
+		stmt_cache[i].in_use = 1;
+		return stmt_cache[i].stmt;
+	}
+
+	ret = sqlite3_prepare_v2(calendar_db_handle, query, strlen(query), &stmt, NULL);
+	retvm_if(SQLITE_OK != ret, NULL,
+			"sqlite3_prepare_v2(%s) Failed(%s).", query, sqlite3_errmsg(calendar_db_handle));
+
+	if (i == CALS_STMT_CACHE_SIZE && 0 <= empty) {
+		stmt_cache[empty].query = query;
+		stmt_cache[empty].stmt = stmt;
+		stmt_cache[empty].in_use = 1;
+	}
+
+	return stmt;
+}
+
+void cals_stmt_release(sqlite3_stmt *stmt)
+{
+	int i;
+
+	if (NULL == stmt)
+		return;
+
+	for (i = 0; i < CALS_STMT_CACHE_SIZE; i++) {
+		if (stmt_cache[i].stmt == stmt) {
+			sqlite3_reset(stmt);
+			sqlite3_clear_bindings(stmt);
+			stmt_cache[i].in_use = 0;
+			return;
+		}
+	}
+	sqlite3_finalize(stmt);
+}
+
 int cals_stmt_step(sqlite3_stmt *stmt)
 {
 	int ret;
@@ -19,11 +19,33 @@
 #ifndef __CALENDAR_SVC_SQLITE_H__
 #define __CALENDAR_SVC_SQLITE_H__
 
+#include <stdlib.h>
+#include <stdbool.h>
 #include <sqlite3.h>
 
 #define CALS_SQL_MAX_LEN 2048
 #define CALS_SQL_MIN_LEN 1024
 
+/*
+ * Tuned PRAGMA profile of the connections to a DB in WAL journal mode.
+ * The journal mode is kept in the DB file, and calendar-svc-initdb
+ * switches it to WAL when built with -DCALS_DB_WAL (cmake -DCALS_DB_WAL=ON).
+ */
+#define CALS_DB_CACHE_SIZE -2048 /* KiB */
+#define CALS_DB_MMAP_SIZE (4 * 1024 * 1024)
+#define CALS_DB_WAL_SIZE_LIMIT (1024 * 1024)
+
+/* default lock wait policy, see calendar_svc_set_lock_wait() */
+#define CALS_DB_LOCK_WAIT_MIN 50 /* us */
+#define CALS_DB_LOCK_WAIT_MAX 20000 /* us */
+#define CALS_DB_LOCK_DEADLINE 1000 /* ms */
+
+/* "IN (...)" of the set based queries, unbound ids are NULL and never match */
+#define CALS_SQL_IN_MAX 64
+#define CALS_SQL_IN_8 "?,?,?,?,?,?,?,?"
+#define CALS_SQL_IN "("CALS_SQL_IN_8","CALS_SQL_IN_8","CALS_SQL_IN_8","CALS_SQL_IN_8"," \
+	CALS_SQL_IN_8","CALS_SQL_IN_8","CALS_SQL_IN_8","CALS_SQL_IN_8")"
+
 int cals_db_open(void);
 int cals_db_close(void);
 
@@ -33,12 +55,20 @@ int cals_query_get_first_int_result(const char *query);
 int cals_query_exec(char *query);
 
 sqlite3_stmt* cals_query_prepare(char *query);
+sqlite3_stmt* cals_query_prepare_cached(const char *query);
+void cals_stmt_release(sqlite3_stmt *stmt);
 int cals_stmt_step(sqlite3_stmt *stmt);
 
 static inline int cals_stmt_bind_text(sqlite3_stmt *stmt, int pos, const char *str) {
 	return sqlite3_bind_text(stmt, pos, str, strlen(str), SQLITE_STATIC);
 }
 
+static inline void cals_stmt_bind_ids(sqlite3_stmt *stmt, const int *ids, int cnt) {
+	int i;
+	for (i = 0; i < cnt && i < CALS_SQL_IN_MAX; i++)
+		sqlite3_bind_int(stmt, i + 1, ids[i]);
+}
+
 int cals_escape_like_pattern(const char *src, char *dest, int dest_size);
 
 #endif /* __CALENDAR_SVC_SQLITE_H__ */
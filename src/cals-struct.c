@@ -19,10 +19,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <stddef.h>
 
 #include "calendar-svc-provider.h"
 #include "cals-internal.h"
 #include "cals-typedef.h"
+#include "cals-arena.h"
 #ifdef CALS_IPC_CLIENT
 #else
 #include "cals-db.h"
@@ -51,19 +53,19 @@ static bool __cal_free_full_record(cal_sch_full_t *sch_full_record, int *error_c
     cal_value *value = NULL;
     GList *head;
 
-    CAL_FREE(sch_full_record->summary);
-    CAL_FREE(sch_full_record->description);
-    CAL_FREE(sch_full_record->location);
-    CAL_FREE(sch_full_record->categories);
-    CAL_FREE(sch_full_record->uid);
-    CAL_FREE(sch_full_record->organizer_name);
-    CAL_FREE(sch_full_record->organizer_email);
-    CAL_FREE(sch_full_record->gcal_id);
-    CAL_FREE(sch_full_record->updated);
-    CAL_FREE(sch_full_record->location_summary);
-    CAL_FREE(sch_full_record->etag);
-    CAL_FREE(sch_full_record->edit_uri);
-    CAL_FREE(sch_full_record->gevent_id);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->summary);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->description);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->location);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->categories);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->uid);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->organizer_name);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->organizer_email);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->gcal_id);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->updated);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->location_summary);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->etag);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->edit_uri);
+    CALS_ARENA_FREE(sch_full_record->arena, sch_full_record->gevent_id);
 
     if (sch_full_record->attendee_list)
     {
@@ -86,6 +88,9 @@ static bool __cal_free_full_record(cal_sch_full_t *sch_full_record, int *error_c
         g_list_free(head);
         sch_full_record->attendee_list = NULL;
     }
+
+    cals_arena_destroy(sch_full_record->arena);
+    sch_full_record->arena = NULL;
     return true;
 
 CATCH:
@@ -384,6 +389,251 @@ API int calendar_svc_struct_free (cal_struct** event)
 	return CAL_SUCCESS;
 }
 
+enum {
+	CALS_FIELD_TYPE_INT,
+	CALS_FIELD_TYPE_STR,
+	CALS_FIELD_TYPE_LLI,
+};
+
+struct cals_field_info {
+	const char *name;
+	int type;
+	size_t offset; /* in cal_sch_full_t */
+	bool read_only;
+};
+
+#define CALS_FIELD(id, name, type, member, read_only) \
+	[id] = {name, type, offsetof(cal_sch_full_t, member), read_only}
+
+/* same fields as the strcmp() chains of the schedule and todo */
+static const struct cals_field_info cals_fields[CALS_FIELD_MAX] = {
+	CALS_FIELD(CALS_FIELD_INT_INDEX, CAL_VALUE_INT_INDEX, CALS_FIELD_TYPE_INT, index, false),
+	CALS_FIELD(CALS_FIELD_INT_ACCOUNT_ID, CAL_VALUE_INT_ACCOUNT_ID, CALS_FIELD_TYPE_INT, account_id, false),
+	CALS_FIELD(CALS_FIELD_INT_TYPE, CAL_VALUE_INT_TYPE, CALS_FIELD_TYPE_INT, cal_type, true),
+	CALS_FIELD(CALS_FIELD_INT_FILE_ID, CAL_VALUE_INT_FILE_ID, CALS_FIELD_TYPE_INT, file_id, false),
+	CALS_FIELD(CALS_FIELD_INT_CONTACT_ID, CAL_VALUE_INT_CONTACT_ID, CALS_FIELD_TYPE_INT, contact_id, false),
+	CALS_FIELD(CALS_FIELD_INT_BUSY_STATUS, CAL_VALUE_INT_BUSY_STATUS, CALS_FIELD_TYPE_INT, busy_status, false),
+	CALS_FIELD(CALS_FIELD_INT_SENSITIVITY, CAL_VALUE_INT_SENSITIVITY, CALS_FIELD_TYPE_INT, sensitivity, false),
+	CALS_FIELD(CALS_FIELD_INT_CALENDAR_TYPE, CAL_VALUE_INT_CALENDAR_TYPE, CALS_FIELD_TYPE_INT, calendar_type, false),
+	CALS_FIELD(CALS_FIELD_INT_MEETING_STATUS, CAL_VALUE_INT_MEETING_STATUS, CALS_FIELD_TYPE_INT, meeting_status, false),
+	CALS_FIELD(CALS_FIELD_INT_LOCATION_TYPE, CAL_VALUE_INT_LOCATION_TYPE, CALS_FIELD_TYPE_INT, location_type, false),
+	CALS_FIELD(CALS_FIELD_INT_CALENDAR_ID, CAL_VALUE_INT_CALENDAR_ID, CALS_FIELD_TYPE_INT, calendar_id, false),
+	CALS_FIELD(CALS_FIELD_INT_DST, CAL_VALUE_INT_DST, CALS_FIELD_TYPE_INT, dst, false),
+	CALS_FIELD(CALS_FIELD_INT_ORIGINAL_EVENT_ID, CAL_VALUE_INT_ORIGINAL_EVENT_ID, CALS_FIELD_TYPE_INT, original_event_id, false),
+	CALS_FIELD(CALS_FIELD_INT_SYNC_STATUS, CAL_VALUE_INT_SYNC_STATUS, CALS_FIELD_TYPE_INT, sync_status, false),
+	CALS_FIELD(CALS_FIELD_INT_PRIORITY, CAL_VALUE_INT_PRIORITY, CALS_FIELD_TYPE_INT, priority, false),
+	CALS_FIELD(CALS_FIELD_INT_TASK_STATUS, CAL_VALUE_INT_TASK_STATUS, CALS_FIELD_TYPE_INT, task_status, false),
+	CALS_FIELD(CALS_FIELD_INT_TIMEZONE, CAL_VALUE_INT_TIMEZONE, CALS_FIELD_TYPE_INT, timezone, false),
+	CALS_FIELD(CALS_FIELD_INT_EMAIL_ID, CAL_VALUE_INT_EMAIL_ID, CALS_FIELD_TYPE_INT, email_id, false),
+	CALS_FIELD(CALS_FIELD_INT_AVAILABILITY, CAL_VALUE_INT_AVAILABILITY, CALS_FIELD_TYPE_INT, availability, false),
+	CALS_FIELD(CALS_FIELD_INT_PROGRESS, CAL_VALUE_INT_PROGRESS, CALS_FIELD_TYPE_INT, progress, false),
+	CALS_FIELD(CALS_FIELD_INT_DTSTART_TYPE, CALS_VALUE_INT_DTSTART_TYPE, CALS_FIELD_TYPE_INT, dtstart_type, false),
+	CALS_FIELD(CALS_FIELD_INT_DTSTART_YEAR, CALS_VALUE_INT_DTSTART_YEAR, CALS_FIELD_TYPE_INT, dtstart_year, false),
+	CALS_FIELD(CALS_FIELD_INT_DTSTART_MONTH, CALS_VALUE_INT_DTSTART_MONTH, CALS_FIELD_TYPE_INT, dtstart_month, false),
+	CALS_FIELD(CALS_FIELD_INT_DTSTART_MDAY, CALS_VALUE_INT_DTSTART_MDAY, CALS_FIELD_TYPE_INT, dtstart_mday, false),
+	CALS_FIELD(CALS_FIELD_INT_DTEND_TYPE, CALS_VALUE_INT_DTEND_TYPE, CALS_FIELD_TYPE_INT, dtend_type, false),
+	CALS_FIELD(CALS_FIELD_INT_DTEND_YEAR, CALS_VALUE_INT_DTEND_YEAR, CALS_FIELD_TYPE_INT, dtend_year, false),
+	CALS_FIELD(CALS_FIELD_INT_DTEND_MONTH, CALS_VALUE_INT_DTEND_MONTH, CALS_FIELD_TYPE_INT, dtend_month, false),
+	CALS_FIELD(CALS_FIELD_INT_DTEND_MDAY, CALS_VALUE_INT_DTEND_MDAY, CALS_FIELD_TYPE_INT, dtend_mday, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_FREQ, CALS_VALUE_INT_RRULE_FREQ, CALS_FIELD_TYPE_INT, freq, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_ID, CALS_VALUE_INT_RRULE_ID, CALS_FIELD_TYPE_INT, rrule_id, true),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_RANGE_TYPE, CALS_VALUE_INT_RRULE_RANGE_TYPE, CALS_FIELD_TYPE_INT, range_type, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_UNTIL_TYPE, CALS_VALUE_INT_RRULE_UNTIL_TYPE, CALS_FIELD_TYPE_INT, until_type, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_UNTIL_YEAR, CALS_VALUE_INT_RRULE_UNTIL_YEAR, CALS_FIELD_TYPE_INT, until_year, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_UNTIL_MONTH, CALS_VALUE_INT_RRULE_UNTIL_MONTH, CALS_FIELD_TYPE_INT, until_month, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_UNTIL_MDAY, CALS_VALUE_INT_RRULE_UNTIL_MDAY, CALS_FIELD_TYPE_INT, until_mday, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_COUNT, CALS_VALUE_INT_RRULE_COUNT, CALS_FIELD_TYPE_INT, count, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_INTERVAL, CALS_VALUE_INT_RRULE_INTERVAL, CALS_FIELD_TYPE_INT, interval, false),
+	CALS_FIELD(CALS_FIELD_INT_RRULE_WKST, CALS_VALUE_INT_RRULE_WKST, CALS_FIELD_TYPE_INT, wkst, false),
+	CALS_FIELD(CALS_FIELD_TXT_SUMMARY, CAL_VALUE_TXT_SUMMARY, CALS_FIELD_TYPE_STR, summary, false),
+	CALS_FIELD(CALS_FIELD_TXT_DESCRIPTION, CAL_VALUE_TXT_DESCRIPTION, CALS_FIELD_TYPE_STR, description, false),
+	CALS_FIELD(CALS_FIELD_TXT_LOCATION, CAL_VALUE_TXT_LOCATION, CALS_FIELD_TYPE_STR, location, false),
+	CALS_FIELD(CALS_FIELD_TXT_CATEGORIES, CAL_VALUE_TXT_CATEGORIES, CALS_FIELD_TYPE_STR, categories, false),
+	CALS_FIELD(CALS_FIELD_TXT_EXDATE, CAL_VALUE_TXT_EXDATE, CALS_FIELD_TYPE_STR, exdate, false),
+	CALS_FIELD(CALS_FIELD_TXT_UID, CAL_VALUE_TXT_UID, CALS_FIELD_TYPE_STR, uid, false),
+	CALS_FIELD(CALS_FIELD_TXT_ORGANIZER_NAME, CAL_VALUE_TXT_ORGANIZER_NAME, CALS_FIELD_TYPE_STR, organizer_name, false),
+	CALS_FIELD(CALS_FIELD_TXT_ORGANIZER_EMAIL, CAL_VALUE_TXT_ORGANIZER_EMAIL, CALS_FIELD_TYPE_STR, organizer_email, false),
+	CALS_FIELD(CALS_FIELD_TXT_GCAL_ID, CAL_VALUE_TXT_GCAL_ID, CALS_FIELD_TYPE_STR, gcal_id, false),
+	CALS_FIELD(CALS_FIELD_TXT_UPDATED, CAL_VALUE_TXT_UPDATED, CALS_FIELD_TYPE_STR, updated, false),
+	CALS_FIELD(CALS_FIELD_TXT_LOCATION_SUMMARY, CAL_VALUE_TXT_LOCATION_SUMMARY, CALS_FIELD_TYPE_STR, location_summary, false),
+	CALS_FIELD(CALS_FIELD_TXT_ETAG, CAL_VALUE_TXT_ETAG, CALS_FIELD_TYPE_STR, etag, false),
+	CALS_FIELD(CALS_FIELD_TXT_EDIT_URL, CAL_VALUE_TXT_EDIT_URL, CALS_FIELD_TYPE_STR, edit_uri, false),
+	CALS_FIELD(CALS_FIELD_TXT_GEDERID, CAL_VALUE_TXT_GEDERID, CALS_FIELD_TYPE_STR, gevent_id, false),
+	CALS_FIELD(CALS_FIELD_TXT_DTSTART_TZID, CALS_VALUE_TXT_DTSTART_TZID, CALS_FIELD_TYPE_STR, dtstart_tzid, false),
+	CALS_FIELD(CALS_FIELD_TXT_DTEND_TZID, CALS_VALUE_TXT_DTEND_TZID, CALS_FIELD_TYPE_STR, dtend_tzid, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYSECOND, CALS_VALUE_TXT_RRULE_BYSECOND, CALS_FIELD_TYPE_STR, bysecond, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYMINUTE, CALS_VALUE_TXT_RRULE_BYMINUTE, CALS_FIELD_TYPE_STR, byminute, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYHOUR, CALS_VALUE_TXT_RRULE_BYHOUR, CALS_FIELD_TYPE_STR, byhour, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYDAY, CALS_VALUE_TXT_RRULE_BYDAY, CALS_FIELD_TYPE_STR, byday, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYMONTHDAY, CALS_VALUE_TXT_RRULE_BYMONTHDAY, CALS_FIELD_TYPE_STR, bymonthday, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYYEARDAY, CALS_VALUE_TXT_RRULE_BYYEARDAY, CALS_FIELD_TYPE_STR, byyearday, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYWEEKNO, CALS_VALUE_TXT_RRULE_BYWEEKNO, CALS_FIELD_TYPE_STR, byweekno, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYMONTH, CALS_VALUE_TXT_RRULE_BYMONTH, CALS_FIELD_TYPE_STR, bymonth, false),
+	CALS_FIELD(CALS_FIELD_TXT_RRULE_BYSETPOS, CALS_VALUE_TXT_RRULE_BYSETPOS, CALS_FIELD_TYPE_STR, bysetpos, false),
+	CALS_FIELD(CALS_FIELD_LLI_DTSTART_UTIME, CALS_VALUE_LLI_DTSTART_UTIME, CALS_FIELD_TYPE_LLI, dtstart_utime, false),
+	CALS_FIELD(CALS_FIELD_LLI_DTEND_UTIME, CALS_VALUE_LLI_DTEND_UTIME, CALS_FIELD_TYPE_LLI, dtend_utime, false),
+	CALS_FIELD(CALS_FIELD_LLI_LASTMOD, CALS_VALUE_LLI_LASTMOD, CALS_FIELD_TYPE_LLI, last_mod, false),
+	CALS_FIELD(CALS_FIELD_LLI_RRULE_UNTIL_UTIME, CALS_VALUE_LLI_RRULE_UNTIL_UTIME, CALS_FIELD_TYPE_LLI, until_utime, false),
+	CALS_FIELD(CALS_FIELD_LLI_CREATED_TIME, CAL_VALUE_LLI_CREATED_TIME, CALS_FIELD_TYPE_LLI, created_time, false),
+	CALS_FIELD(CALS_FIELD_LLI_COMPLETED_TIME, CAL_VALUE_LLI_COMPLETED_TIME, CALS_FIELD_TYPE_LLI, completed_time, false),
+};
+
+static const struct {
+	const char *name;
+	int id;
+} cals_field_aliases[] = {
+	{"index", CALS_FIELD_INT_INDEX},
+	{CAL_VALUE_INT_CAL_TYPE, CALS_FIELD_INT_TYPE},
+};
+
+/* built once, read without the lock after that */
+static GHashTable *field_ids;
+G_LOCK_DEFINE_STATIC(field_ids);
+
+static GHashTable *_cals_field_get_ids(void)
+{
+	int i;
+	GHashTable *ids;
+
+	ids = g_atomic_pointer_get(&field_ids);
+	if (ids)
+		return ids;
+
+	G_LOCK(field_ids);
+	if (NULL == field_ids) {
+		ids = g_hash_table_new(g_str_hash, g_str_equal);
+		if (NULL == ids) {
+			G_UNLOCK(field_ids);
+			ERR("g_hash_table_new() Failed");
+			return NULL;
+		}
+		for (i = 0; i < CALS_FIELD_MAX; i++)
+			g_hash_table_insert(ids, (gpointer)cals_fields[i].name, GINT_TO_POINTER(i + 1));
+		for (i = 0; i < sizeof(cals_field_aliases) / sizeof(cals_field_aliases[0]); i++)
+			g_hash_table_insert(ids, (gpointer)cals_field_aliases[i].name,
+					GINT_TO_POINTER(cals_field_aliases[i].id + 1));
+		g_atomic_pointer_set(&field_ids, ids);
+	}
+	ids = field_ids;
+	G_UNLOCK(field_ids);
+
+	return ids;
+}
+
+API int calendar_svc_struct_get_field_id(const char *field)
+{
+	gpointer id;
+	GHashTable *ids;
+
+	retv_if(NULL == field, CAL_ERR_ARG_NULL);
+
+	ids = _cals_field_get_ids();
+	retv_if(NULL == ids, CAL_ERR_OUT_OF_MEMORY);
+
+	id = g_hash_table_lookup(ids, field);
+	if (NULL == id)
+		return CAL_ERR_ARG_INVALID;
+
+	return GPOINTER_TO_INT(id) - 1;
+}
+
+static inline void *_cals_field_get_ptr(cal_struct *cs, int id, int type)
+{
+	if (NULL == cs || NULL == cs->user_data)
+		return NULL;
+	if (CAL_STRUCT_TYPE_SCHEDULE != cs->event_type && CAL_STRUCT_TYPE_TODO != cs->event_type)
+		return NULL;
+	if (id < 0 || CALS_FIELD_MAX <= id || type != cals_fields[id].type)
+		return NULL;
+
+	return (char *)cs->user_data + cals_fields[id].offset;
+}
+
+/* id of the field in the table, or -1 to go through the strcmp() chain */
+static inline int _cals_field_find(cal_struct *cs, const char *field, int type)
+{
+	int id;
+
+	if (CAL_STRUCT_TYPE_SCHEDULE != cs->event_type && CAL_STRUCT_TYPE_TODO != cs->event_type)
+		return -1;
+
+	id = calendar_svc_struct_get_field_id(field);
+	if (id < 0 || type != cals_fields[id].type)
+		return -1;
+
+	return id;
+}
+
+API int calendar_svc_struct_get_int_by_id(cal_struct *record, int id)
+{
+	int *p;
+
+	p = _cals_field_get_ptr(record, id, CALS_FIELD_TYPE_INT);
+	retvm_if(NULL == p, 0, "Invalid parameters(record(%p), id(%d))", record, id);
+
+	return *p;
+}
+
+API int calendar_svc_struct_set_int_by_id(cal_struct *record, int id, int intval)
+{
+	int *p;
+
+	p = _cals_field_get_ptr(record, id, CALS_FIELD_TYPE_INT);
+	retvm_if(NULL == p, CAL_ERR_ARG_INVALID, "Invalid parameters(record(%p), id(%d))", record, id);
+	retvm_if(cals_fields[id].read_only, CAL_ERR_ARG_INVALID,
+			"field(%s) is read only", cals_fields[id].name);
+
+	*p = intval;
+	return CAL_SUCCESS;
+}
+
+API char *calendar_svc_struct_get_str_by_id(cal_struct *record, int id)
+{
+	char **p;
+
+	p = _cals_field_get_ptr(record, id, CALS_FIELD_TYPE_STR);
+	retvm_if(NULL == p, NULL, "Invalid parameters(record(%p), id(%d))", record, id);
+
+	return *p;
+}
+
+API int calendar_svc_struct_set_str_by_id(cal_struct *record, int id, const char *strval)
+{
+	char **p;
+
+	retv_if(NULL == strval, CAL_ERR_ARG_NULL);
+
+	p = _cals_field_get_ptr(record, id, CALS_FIELD_TYPE_STR);
+	retvm_if(NULL == p, CAL_ERR_ARG_INVALID, "Invalid parameters(record(%p), id(%d))", record, id);
+
+	CALS_ARENA_FREE(((cal_sch_full_t *)record->user_data)->arena, *p);
+	*p = strdup(strval);
+	retvm_if(NULL == *p, CAL_ERR_OUT_OF_MEMORY, "strdup() Failed");
+
+	return CAL_SUCCESS;
+}
+
+API long long int calendar_svc_struct_get_lli_by_id(cal_struct *record, int id)
+{
+	long long int *p;
+
+	p = _cals_field_get_ptr(record, id, CALS_FIELD_TYPE_LLI);
+	retvm_if(NULL == p, 0, "Invalid parameters(record(%p), id(%d))", record, id);
+
+	return *p;
+}
+
+API int calendar_svc_struct_set_lli_by_id(cal_struct *record, int id, long long int llival)
+{
+	long long int *p;
+
+	p = _cals_field_get_ptr(record, id, CALS_FIELD_TYPE_LLI);
+	retvm_if(NULL == p, CAL_ERR_ARG_INVALID, "Invalid parameters(record(%p), id(%d))", record, id);
+
+	*p = llival;
+	return CAL_SUCCESS;
+}
+
 API char * calendar_svc_struct_get_str (cal_struct *event,const char *field)
 {
 	//CALS_FN_CALL();
@@ -399,6 +649,11 @@ API char * calendar_svc_struct_get_str (cal_struct *event,const char *field)
 	cals_struct_period_allday_osp *aosp = NULL;
 	cals_struct_period_normal_location *nosl = NULL;
 	cals_struct_period_allday_location *aosl = NULL;
+	int id;
+
+	id = _cals_field_find(event, field, CALS_FIELD_TYPE_STR);
+	if (0 <= id)
+		return calendar_svc_struct_get_str_by_id(event, id);
 
 	switch(event->event_type)
 	{
@@ -667,9 +922,15 @@ API int calendar_svc_struct_get_int(cal_struct *event, const char *field)
 	cals_struct_period_normal_location *nosl = NULL;
 	cals_struct_period_allday_location *aosl = NULL;
 	cals_struct_period_normal_alarm *nosa = NULL;
+	int id;
 
 	retvm_if(NULL == event || NULL==event->user_data || NULL == field, 0,
 				"Invalid parameters(event(%p), field(%p))", event, field);
+
+	id = _cals_field_find(event, field, CALS_FIELD_TYPE_INT);
+	if (0 <= id)
+		return calendar_svc_struct_get_int_by_id(event, id);
+
 	switch(event->event_type)
 	{
 	case CAL_STRUCT_TYPE_SCHEDULE:
@@ -1248,10 +1509,15 @@ API int calendar_svc_struct_set_int (cal_struct *event, const char *field, int i
 	cals_struct_period_normal_location *nosl = NULL;
 	cals_struct_period_allday_location *aosl = NULL;
 	cals_struct_period_normal_alarm *nosa = NULL;
+	int id;
 
 	retv_if(NULL == event, CAL_ERR_ARG_NULL);
 	retv_if(NULL == field, CAL_ERR_ARG_NULL);
 
+	id = _cals_field_find(event, field, CALS_FIELD_TYPE_INT);
+	if (0 <= id)
+		return calendar_svc_struct_set_int_by_id(event, id, intval);
+
 	switch(event->event_type)
 	{
 	case CAL_STRUCT_TYPE_SCHEDULE:
@@ -1805,9 +2071,14 @@ API int calendar_svc_struct_set_str (cal_struct *event, const char *field, const
 	cals_struct_period_allday_osp *aosp = NULL;
 	cals_struct_period_normal_location *nosl = NULL;
 	cals_struct_period_allday_location *aosl = NULL;
+	int id;
 
 	retvm_if(strval == NULL, CAL_ERR_FAIL, "Invalid argument: value is NULL");
 
+	id = _cals_field_find(event, field, CALS_FIELD_TYPE_STR);
+	if (0 <= id)
+		return calendar_svc_struct_set_str_by_id(event, id, strval);
+
 	switch(event->event_type)
 	{
 	case CAL_STRUCT_TYPE_SCHEDULE:
@@ -1815,127 +2086,127 @@ API int calendar_svc_struct_set_str (cal_struct *event, const char *field, const
 		sch_rec = (cal_sch_full_t*)event->user_data;
 		if(0 == strcmp(field,CAL_VALUE_TXT_SUMMARY))
 		{
-			CAL_FREE(sch_rec->summary);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->summary);
 			sch_rec->summary = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_DESCRIPTION))
 		{
-			CAL_FREE(sch_rec->description);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->description);
 			sch_rec->description = strdup(strval);
 		}
 		else if(0 == strcmp(field, CAL_VALUE_TXT_LOCATION))
 		{
-			CAL_FREE(sch_rec->location);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->location);
 			sch_rec->location = strdup(strval);
 		}
 		else if(0 == strcmp(field, CAL_VALUE_TXT_CATEGORIES))
 		{
-			CAL_FREE(sch_rec->categories);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->categories);
 			sch_rec->categories = strdup(strval);
 		}
 		else if(0 == strcmp(field, CAL_VALUE_TXT_EXDATE))
 		{
-			CAL_FREE(sch_rec->exdate);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->exdate);
 			sch_rec->exdate = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_UID))
 		{
-			CAL_FREE(sch_rec->uid);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->uid);
 			sch_rec->uid = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_ORGANIZER_NAME))
 		{
-			CAL_FREE(sch_rec->organizer_name);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->organizer_name);
 			sch_rec->organizer_name = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_ORGANIZER_EMAIL  ))
 		{
-			CAL_FREE(sch_rec->organizer_email);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->organizer_email);
 			sch_rec->organizer_email = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_GCAL_ID ))
 		{
-			CAL_FREE(sch_rec->gcal_id);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->gcal_id);
 			sch_rec->gcal_id = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_UPDATED))
 		{
-			CAL_FREE(sch_rec->updated);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->updated);
 			sch_rec->updated = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_LOCATION_SUMMARY))
 		{
-			CAL_FREE(sch_rec->location_summary);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->location_summary);
 			sch_rec->location_summary = strdup(strval);
 		}
 		else if(0 == strcmp(field, CAL_VALUE_TXT_ETAG))
 		{
-			CAL_FREE(sch_rec->etag);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->etag);
 			sch_rec->etag = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_EDIT_URL))
 		{
-			CAL_FREE(sch_rec->edit_uri);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->edit_uri);
 			sch_rec->edit_uri = strdup(strval);
 		}
 		else if(0 == strcmp(field,CAL_VALUE_TXT_GEDERID))
 		{
-			CAL_FREE(sch_rec->gevent_id);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->gevent_id);
 			sch_rec->gevent_id = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_DTSTART_TZID))
 		{
-			CAL_FREE(sch_rec->dtstart_tzid);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->dtstart_tzid);
 			sch_rec->dtstart_tzid = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_DTEND_TZID))
 		{
-			CAL_FREE(sch_rec->dtend_tzid);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->dtend_tzid);
 			sch_rec->dtend_tzid = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYSECOND))
 		{
-			CAL_FREE(sch_rec->bysecond);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->bysecond);
 			sch_rec->bysecond = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYMINUTE))
 		{
-			CAL_FREE(sch_rec->byminute);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->byminute);
 			sch_rec->byminute = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYHOUR))
 		{
-			CAL_FREE(sch_rec->byhour);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->byhour);
 			sch_rec->byhour = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYDAY))
 		{
-			CAL_FREE(sch_rec->byday);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->byday);
 			sch_rec->byday = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYMONTHDAY))
 		{
-			CAL_FREE(sch_rec->bymonthday);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->bymonthday);
 			sch_rec->bymonthday = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYYEARDAY))
 		{
-			CAL_FREE(sch_rec->byyearday);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->byyearday);
 			sch_rec->byyearday = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYWEEKNO))
 		{
-			CAL_FREE(sch_rec->byweekno);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->byweekno);
 			sch_rec->byweekno = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYMONTH))
 		{
-			CAL_FREE(sch_rec->bymonth);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->bymonth);
 			sch_rec->bymonth = strdup(strval);
 		}
 		else if(0 == strcmp(field, CALS_VALUE_TXT_RRULE_BYSETPOS))
 		{
-			CAL_FREE(sch_rec->bysetpos);
+			CALS_ARENA_FREE(sch_rec->arena, sch_rec->bysetpos);
 			sch_rec->bysetpos = strdup(strval);
 		}
 		else
@@ -2875,9 +3146,15 @@ API long long int calendar_svc_struct_get_lli(cal_struct *event, const char *fie
 	cals_struct_period_normal_location *nosl = NULL;
 	cals_struct_period_normal_alarm *nosa = NULL;
 
+	int id;
+
 	retv_if(NULL == event || NULL == event->user_data, 0);
 	retv_if(NULL == field, 0);
 
+	id = _cals_field_find(event, field, CALS_FIELD_TYPE_LLI);
+	if (0 <= id)
+		return calendar_svc_struct_get_lli_by_id(event, id);
+
 	switch(event->event_type)
 	{
 	case CAL_STRUCT_TYPE_SCHEDULE:
@@ -2968,7 +3245,14 @@ API int calendar_svc_struct_set_lli(cal_struct *event, const char *field, long l
 	cals_struct_period_normal_location *nosl = NULL;
 	cals_struct_period_normal_alarm *nosa = NULL;
 
+	int id;
+
 	retv_if(NULL == event || NULL == event->user_data, CAL_ERR_ARG_NULL);
+	retv_if(NULL == field, CAL_ERR_ARG_NULL);
+
+	id = _cals_field_find(event, field, CALS_FIELD_TYPE_LLI);
+	if (0 <= id)
+		return calendar_svc_struct_set_lli_by_id(event, id, value);
 
 	switch(event->event_type)
 	{
@@ -6,35 +6,26 @@
 #include "cals-time.h"
 #include "calendar-svc-provider.h"
 #include "cals-internal.h"
+#include "cals-recur.h"
+#include "cals-tz.h"
 
 #define ms2sec(ms) (long long int)(ms / 1000.0)
 #define sec2ms(s) (s * 1000.0)
 
-static UCalendar *_ucal_get_cal(const char *tzid)
+static inline UCalendar *_ucal_get_cal(const char *tzid)
 {
-	UCalendar *cal;
-	UErrorCode status = U_ZERO_ERROR;
-	UChar *_tzid;
-
-	_tzid = NULL;
-
-	if (tzid) {
-		_tzid = (UChar*)malloc(sizeof(UChar) * (strlen(tzid) +1));
-		if (_tzid)
-			u_uastrcpy(_tzid, tzid);
-		else
-			ERR("malloc failed");
-	}
+	return cals_tz_open_cal(tzid);
+}
 
-	cal = ucal_open(_tzid, u_strlen(_tzid), "en_US", UCAL_TRADITIONAL, &status);
-	if (_tzid)
-		free(_tzid);
+/* local date time to utime by the tz cache, -1 if not covered */
+static int _tz_local_to_utime(const char *tzid, int year, int month, int mday,
+		long long int sec, long long int *utime)
+{
+	if (year < CALS_RECUR_MIN_YEAR || month < 1 || 12 < month)
+		return -1;
 
-	if (U_FAILURE(status)) {
-		ERR("ucal_open failed (%s)", u_errorName(status));
-		return NULL;
-	}
-	return cal;
+	return cals_tz_to_utime(tzid,
+			cals_recur_days_from_civil(year, month, mday) * 24 * 60 * 60 + sec, utime);
 }
 
 static void _ucal_set_time(UCalendar *cal, struct cals_time *t)
@@ -66,6 +57,11 @@ long long int cals_time_diff(struct cals_time *st, struct cals_time *et)
 	if (st->type == CALS_TIME_UTIME)
 		return et->utime - st->utime;
 
+	if (et->type == CALS_TIME_LOCALTIME && CALS_RECUR_MIN_YEAR <= st->year
+			&& CALS_RECUR_MIN_YEAR <= et->year)
+		return cals_recur_days_from_civil(et->year, et->month, et->mday)
+			- cals_recur_days_from_civil(st->year, st->month, st->mday);
+
 	cal = _ucal_get_cal(et->tzid);
 
 	_ucal_set_time(cal, et);
@@ -88,6 +84,7 @@ long long int cals_time_diff(struct cals_time *st, struct cals_time *et)
 long long int cals_time_diff_with_now(struct cals_time *t)
 {
 	long long int now;
+	long long int lli;
 	UErrorCode status = U_ZERO_ERROR;
 	UCalendar *cal;
 	UDate ud;
@@ -97,6 +94,9 @@ long long int cals_time_diff_with_now(struct cals_time *t)
 		return t->utime - ms2sec(ucal_getNow());
 	}
 
+	if (!_tz_local_to_utime(t->tzid, t->year, t->month, t->mday, 0, &lli))
+		return lli - ms2sec(ucal_getNow());
+
 	cal = _ucal_get_cal(t->tzid);
 	_ucal_set_time(cal, t);
 	ud = ucal_getMillis(cal, &status);
@@ -111,20 +111,37 @@ char *cals_time_get_str_datetime(char *tzid, long long int t)
 	UErrorCode status = U_ZERO_ERROR;
 	UCalendar *cal;
 	int y, mon, d, h, m, s;
+	int offset;
+	long long int lt;
+	long long int days;
 	char buf[17] = {0};
 
 	if (tzid == NULL) {
 		tzid = CALS_TZID_0;
 	}
-	cal = _ucal_get_cal(tzid);
-	ucal_setMillis(cal, sec2ms(t), &status);
 
-	y = ucal_get(cal, UCAL_YEAR, &status);
-	mon = ucal_get(cal, UCAL_MONTH, &status) + 1;
-	d = ucal_get(cal, UCAL_DATE, &status);
-	h = ucal_get(cal, UCAL_HOUR_OF_DAY, &status);
-	m = ucal_get(cal, UCAL_MINUTE, &status);
-	s = ucal_get(cal, UCAL_SECOND, &status);
+	if (!cals_tz_get_offset(tzid, t, &offset)) {
+		lt = t + offset;
+		days = lt / (24 * 60 * 60);
+		if (lt % (24 * 60 * 60) < 0)
+			days--;
+		lt -= days * 24 * 60 * 60;
+		cals_recur_civil_from_days(days, &y, &mon, &d);
+		h = lt / (60 * 60);
+		m = lt / 60 % 60;
+		s = lt % 60;
+	} else {
+		cal = _ucal_get_cal(tzid);
+		ucal_setMillis(cal, sec2ms(t), &status);
+
+		y = ucal_get(cal, UCAL_YEAR, &status);
+		mon = ucal_get(cal, UCAL_MONTH, &status) + 1;
+		d = ucal_get(cal, UCAL_DATE, &status);
+		h = ucal_get(cal, UCAL_HOUR_OF_DAY, &status);
+		m = ucal_get(cal, UCAL_MINUTE, &status);
+		s = ucal_get(cal, UCAL_SECOND, &status);
+		ucal_close(cal);
+	}
 
 	snprintf(buf, sizeof(buf),
 			"%04d%02d%02dT%02d%02d%02dZ",
@@ -160,6 +177,9 @@ long long int cals_time_convert_to_lli(struct cals_time *ct)
 	UErrorCode status = U_ZERO_ERROR;
 	UChar *_tzid;
 
+	if (!_tz_local_to_utime(ct->tzid, ct->year, ct->month, ct->mday, 0, &lli))
+		return lli;
+
 	_tzid = NULL;
 
 	if (ct->tzid) {
@@ -182,7 +202,7 @@ DBG("tzid(%s)", ct->tzid);
 	ucal_set(cal, UCAL_YEAR, ct->year);
 	ucal_set(cal, UCAL_MONTH, ct->month - 1);
 	ucal_set(cal, UCAL_DATE, ct->mday);
-	ucal_set(cal, UCAL_HOUR, 0);
+	ucal_set(cal, UCAL_HOUR_OF_DAY, 0);
 	ucal_set(cal, UCAL_MINUTE, 0);
 	ucal_set(cal, UCAL_SECOND, 0);
 
@@ -203,12 +223,16 @@ long long int cals_time_date_to_utime(const char *tzid,
 	//UChar *_tzid;
 	long long int lli;
 
+	if (!_tz_local_to_utime(tzid, year, month, mday,
+				(hour * 60 + minute) * 60 + second, &lli))
+		return lli;
+
 	cal = _ucal_get_cal(tzid);
 
 	ucal_set(cal, UCAL_YEAR, year);
 	ucal_set(cal, UCAL_MONTH, month - 1);
 	ucal_set(cal, UCAL_DATE, mday);
-	ucal_set(cal, UCAL_HOUR, hour);
+	ucal_set(cal, UCAL_HOUR_OF_DAY, hour);
 	ucal_set(cal, UCAL_MINUTE, minute);
 	ucal_set(cal, UCAL_SECOND, second);
 
@@ -7,7 +7,7 @@ struct cals_time {
 	int year;
 	int month;
 	int mday;
-	char tzid[15];
+	char tzid[64];
 };
 
 long long int cals_time_diff(struct cals_time *st, struct cals_time *et);
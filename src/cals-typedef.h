@@ -117,11 +117,20 @@ struct _cal_value {
 	void* user_data;
 };
 
+struct cals_sch_prefetch;
+
 struct _cal_iter {
 	int i_type;
 	sqlite3_stmt *stmt;
 	int is_patched;
 	cals_updated_info *info;
+	struct cals_sch_prefetch *prefetch;
+	int reuse_row;
+	int page_limit; /* rows of a page, 0 if the list is not paged */
+	int page_cnt;
+	int page_col; /* column of the sort key, -1 if the key is the id */
+	long long int page_key;
+	int page_id;
 };
 
 typedef struct
@@ -250,6 +259,8 @@ typedef enum
 	CAL_STARTING_DAY_MONDAY		/**< starting day is monday */
 } cal_starting_day_type_t;
 
+struct cals_arena;
+
 /**
  * This structure defines schedule information.
  */
@@ -333,6 +344,7 @@ typedef struct
 	char *bymonth;
 	char *bysetpos;
 	int wkst;
+	struct cals_arena *arena; /**< strings read from DB, NULL if each one is malloc'd */
 }cal_sch_full_t;
 
 
@@ -0,0 +1,326 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <glib.h>
+#include <unicode/ustring.h>
+#include <unicode/uversion.h>
+#include "cals-tz.h"
+#include "cals-internal.h"
+#include "calendar-svc-errors.h"
+
+#define CALS_TZ_START -2208988800LL /* 1900/01/01 00:00:00 UTC */
+#define CALS_TZ_END 4102444800LL /* 2100/01/01 00:00:00 UTC */
+#define CALS_TZ_MAX 64 /* tzids kept in the cache */
+
+struct cals_tz {
+	UCalendar *cal;
+	int cnt;
+	int size;
+	long long int *at; /* off[i] is used from at[i] */
+	int *off;
+};
+
+static GHashTable *tz_cache;
+G_LOCK_DEFINE_STATIC(tz_cache);
+
+static UCalendar *_tz_open(const char *tzid)
+{
+	UCalendar *cal;
+	UErrorCode status = U_ZERO_ERROR;
+	UChar *_tzid;
+
+	_tzid = NULL;
+
+	if (tzid) {
+		_tzid = (UChar*)malloc(sizeof(UChar) * (strlen(tzid) +1));
+		if (_tzid)
+			u_uastrcpy(_tzid, tzid);
+		else
+			ERR("malloc failed");
+	}
+
+	cal = ucal_open(_tzid, u_strlen(_tzid), "en_US", UCAL_TRADITIONAL, &status);
+	if (_tzid)
+		free(_tzid);
+
+	if (U_FAILURE(status)) {
+		ERR("ucal_open failed (%s)", u_errorName(status));
+		return NULL;
+	}
+	return cal;
+}
+
+static int _tz_get_icu_offset(UCalendar *cal, long long int t)
+{
+	UErrorCode status = U_ZERO_ERROR;
+
+	ucal_setMillis(cal, t * 1000.0, &status);
+	return (ucal_get(cal, UCAL_ZONE_OFFSET, &status)
+			+ ucal_get(cal, UCAL_DST_OFFSET, &status)) / 1000;
+}
+
+static int _tz_push(struct cals_tz *tz, long long int at, int off)
+{
+	long long int *t_at;
+	int *t_off;
+
+	if (tz->cnt == tz->size) {
+		tz->size = tz->size ? tz->size * 2 : 64;
+		t_at = realloc(tz->at, tz->size * sizeof(long long int));
+		retvm_if(NULL == t_at, CAL_ERR_OUT_OF_MEMORY, "realloc failed");
+		tz->at = t_at;
+		t_off = realloc(tz->off, tz->size * sizeof(int));
+		retvm_if(NULL == t_off, CAL_ERR_OUT_OF_MEMORY, "realloc failed");
+		tz->off = t_off;
+	}
+	tz->at[tz->cnt] = at;
+	tz->off[tz->cnt] = off;
+	tz->cnt++;
+
+	return CAL_SUCCESS;
+}
+
+static int _tz_compile(struct cals_tz *tz)
+{
+	int r;
+	int off;
+	long long int t;
+#if U_ICU_VERSION_MAJOR_NUM >= 50
+	UDate d;
+	UErrorCode status = U_ZERO_ERROR;
+#else
+	long long int lo, hi, mid;
+#endif
+
+	r = _tz_push(tz, CALS_TZ_START, _tz_get_icu_offset(tz->cal, CALS_TZ_START));
+	retv_if(CAL_SUCCESS != r, r);
+
+#if U_ICU_VERSION_MAJOR_NUM >= 50
+	t = CALS_TZ_START;
+	while (t < CALS_TZ_END) {
+		ucal_setMillis(tz->cal, t * 1000.0, &status);
+		if (!ucal_getTimeZoneTransitionDate(tz->cal, UCAL_TZ_TRANSITION_NEXT, &d, &status)
+				|| U_FAILURE(status))
+			break;
+
+		t = (long long int)(d / 1000.0);
+		if (CALS_TZ_END <= t)
+			break;
+
+		off = _tz_get_icu_offset(tz->cal, t);
+		if (off == tz->off[tz->cnt - 1])
+			continue;
+		r = _tz_push(tz, t, off);
+		retv_if(CAL_SUCCESS != r, r);
+	}
+#else
+	/* transitions are found by weekly samples and bisection */
+	for (t = CALS_TZ_START + 7 * 24 * 60 * 60; t < CALS_TZ_END; t += 7 * 24 * 60 * 60) {
+		off = _tz_get_icu_offset(tz->cal, t);
+		if (off == tz->off[tz->cnt - 1])
+			continue;
+
+		lo = t - 7 * 24 * 60 * 60;
+		hi = t;
+		while (lo + 1 < hi) {
+			mid = lo + (hi - lo) / 2;
+			if (_tz_get_icu_offset(tz->cal, mid) == tz->off[tz->cnt - 1])
+				lo = mid;
+			else
+				hi = mid;
+		}
+		r = _tz_push(tz, hi, off);
+		retv_if(CAL_SUCCESS != r, r);
+	}
+#endif
+	return CAL_SUCCESS;
+}
+
+static void _tz_free(struct cals_tz *tz)
+{
+	if (tz->cal)
+		ucal_close(tz->cal);
+	free(tz->at);
+	free(tz->off);
+	free(tz);
+}
+
+/* should be called with tz_cache locked */
+static struct cals_tz *_tz_get(const char *tzid)
+{
+	int r;
+	struct cals_tz *tz;
+
+	if (NULL == tzid)
+		return NULL;
+
+	if (NULL == tz_cache) {
+		tz_cache = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL);
+		retvm_if(NULL == tz_cache, NULL, "g_hash_table_new_full() Failed");
+	}
+
+	tz = g_hash_table_lookup(tz_cache, tzid);
+	if (tz)
+		return tz;
+
+	if (CALS_TZ_MAX <= g_hash_table_size(tz_cache)) {
+		DBG("tz cache is full, tzid(%s) is not cached", tzid);
+		return NULL;
+	}
+
+	tz = calloc(1, sizeof(struct cals_tz));
+	retvm_if(NULL == tz, NULL, "calloc failed");
+
+	tz->cal = _tz_open(tzid);
+	if (NULL == tz->cal) {
+		_tz_free(tz);
+		return NULL;
+	}
+
+	r = _tz_compile(tz);
+	if (CAL_SUCCESS != r) {
+		ERR("_tz_compile(%s) Failed(%d)", tzid, r);
+		_tz_free(tz);
+		return NULL;
+	}
+	DBG("tzid(%s) has %d transitions", tzid, tz->cnt - 1);
+
+	g_hash_table_insert(tz_cache, strdup(tzid), tz);
+	return tz;
+}
+
+/* index of the last transition at or before t */
+static int _tz_find(struct cals_tz *tz, long long int t)
+{
+	int lo, hi, mid;
+
+	if (t < tz->at[0] || CALS_TZ_END <= t)
+		return -1;
+
+	lo = 0;
+	hi = tz->cnt - 1;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (tz->at[mid] <= t)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+int cals_tz_get_offset(const char *tzid, long long int utime, int *offset)
+{
+	int i;
+	int r;
+	struct cals_tz *tz;
+
+	r = -1;
+
+	G_LOCK(tz_cache);
+	tz = _tz_get(tzid);
+	if (tz && 0 <= (i = _tz_find(tz, utime))) {
+		*offset = tz->off[i];
+		r = 0;
+	}
+	G_UNLOCK(tz_cache);
+
+	return r;
+}
+
+/*
+ * Same as lenient ICU:
+ * repeated wall time is taken as the later one,
+ * skipped wall time is taken with the offset before the transition.
+ */
+int cals_tz_to_utime(const char *tzid, long long int local, long long int *utime)
+{
+	int i;
+	int j;
+	int k;
+	int r;
+	long long int u;
+	long long int best;
+	struct cals_tz *tz;
+
+	r = -1;
+
+	G_LOCK(tz_cache);
+	tz = _tz_get(tzid);
+	if (NULL == tz || (i = _tz_find(tz, local)) < 0) {
+		G_UNLOCK(tz_cache);
+		return -1;
+	}
+
+	best = LLONG_MIN;
+	for (j = i - 1; j <= i + 1; j++) {
+		if (j < 0 || tz->cnt <= j)
+			continue;
+		u = local - tz->off[j];
+		k = _tz_find(tz, u);
+		if (0 <= k && tz->off[k] == tz->off[j] && best < u)
+			best = u;
+	}
+
+	if (LLONG_MIN == best) {
+		for (j = i; j <= i + 1 && j < tz->cnt; j++) {
+			if (j < 1)
+				continue;
+			if (tz->at[j] <= local - tz->off[j - 1] && local - tz->off[j] < tz->at[j]) {
+				best = local - tz->off[j - 1];
+				break;
+			}
+		}
+	}
+	G_UNLOCK(tz_cache);
+
+	if (LLONG_MIN != best) {
+		*utime = best;
+		r = 0;
+	}
+	return r;
+}
+
+UCalendar *cals_tz_open_cal(const char *tzid)
+{
+	UCalendar *cal;
+	struct cals_tz *tz;
+	UErrorCode status = U_ZERO_ERROR;
+
+	G_LOCK(tz_cache);
+	tz = _tz_get(tzid);
+	if (NULL == tz) {
+		G_UNLOCK(tz_cache);
+		return _tz_open(tzid);
+	}
+	cal = ucal_clone(tz->cal, &status);
+	G_UNLOCK(tz_cache);
+
+	if (U_FAILURE(status)) {
+		ERR("ucal_clone failed (%s)", u_errorName(status));
+		return NULL;
+	}
+
+	/* opened calendar has the current time */
+	ucal_setMillis(cal, ucal_getNow(), &status);
+
+	return cal;
+}
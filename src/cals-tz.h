@@ -0,0 +1,36 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __CALENDAR_SVC_TZ_H__
+#define __CALENDAR_SVC_TZ_H__
+
+#include <unicode/ucal.h>
+
+/*
+ * Process-wide cache of timezone offsets.
+ * UTC offsets and their transition instants are compiled once per tzid
+ * for 1900 ~ 2100, and looked up by binary search.
+ * Functions return -1 when the time is not covered, then ICU should be used.
+ */
+int cals_tz_get_offset(const char *tzid, long long int utime, int *offset);
+int cals_tz_to_utime(const char *tzid, long long int local, long long int *utime);
+
+/* clone of the cached UCalendar of the tzid, should be closed by ucal_close() */
+UCalendar *cals_tz_open_cal(const char *tzid);
+
+#endif /* __CALENDAR_SVC_TZ_H__ */
@@ -154,20 +154,14 @@ int cals_notify(cals_noti_type type)
 	return CAL_SUCCESS;
 }
 
-#define CAL_COMMIT_TRY_MAX 500000
+/* lock waits are done by the busy handler of the connection, see cals-sqlite.c */
 int cals_begin_trans(void)
 {
 	if(transaction_cnt <= 0)
 	{
-		int ret, progress;
+		int ret;
 
-		progress = 100000;
 		ret = cals_query_exec("BEGIN IMMEDIATE TRANSACTION");
-		while(CAL_ERR_DB_LOCK == ret && progress < CAL_COMMIT_TRY_MAX) {
-			usleep(progress);
-			ret = cals_query_exec("BEGIN IMMEDIATE TRANSACTION");
-			progress *= 2;
-		}
 		retvm_if(CAL_SUCCESS != ret, ret, "cals_query_exec() Failed(%d)", ret);
 
 		transaction_cnt = 0;
@@ -193,7 +187,6 @@ static inline void _cals_cancel_changes(void)
 int cals_end_trans(bool is_success)
 {
 	int ret;
-	int progress = 0;
 	char query[CALS_SQL_MIN_LEN];
 
 	transaction_cnt--;
@@ -217,13 +210,7 @@ int cals_end_trans(bool is_success)
 		warn_if(CAL_SUCCESS != ret, "cals_query_exec(version up) Failed(%d).", ret);
 	}
 
-	progress = 400000;
 	ret = cals_query_exec("COMMIT TRANSACTION");
-	while (CAL_ERR_DB_LOCK == ret && progress < CAL_COMMIT_TRY_MAX) {
-		usleep(progress);
-		ret = cals_query_exec("COMMIT TRANSACTION");
-		progress *= 2;
-	}
 	if (CAL_SUCCESS != ret) {
 		int tmp_ret;
 		ERR("cals_query_exec() Failed(%d)", ret);
@@ -429,3 +416,22 @@ long long int _datetime_to_utime(char *datetime)
 	return _date_to_utime(y, mon, d, h, min, s);
 }
 
+int cals_page_token_parse(const char *token, long long int *key, int *id)
+{
+	char c;
+
+	retv_if(NULL == token, CAL_ERR_ARG_NULL);
+
+	if (2 != sscanf(token, "%lld:%d%c", key, id, &c) || *id < 0)
+		return CAL_ERR_ARG_INVALID;
+
+	return CAL_SUCCESS;
+}
+
+char *cals_page_token_new(long long int key, int id)
+{
+	char buf[48];
+
+	snprintf(buf, sizeof(buf), "%lld:%d", key, id);
+	return strdup(buf);
+}
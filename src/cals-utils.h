@@ -96,4 +96,8 @@ inline int cals_updated_schedule_free_mempool(cals_updated *mempool);
 long long int _date_to_utime(int y, int mon, int d, int h, int min, int s);
 long long int _datetime_to_utime(char *datetime);
 
+/* continuation token of a paged list, the sort key and the id of the last row */
+int cals_page_token_parse(const char *token, long long int *key, int *id);
+char *cals_page_token_new(long long int key, int id);
+
 #endif /* __CALENDAR_SVC_UTILS_H__ */
@@ -0,0 +1,165 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include "test-db.h"
+
+/* sweep of the candidate instances with the stored ones */
+
+#define D20240102T000000 1704153600LL
+#define HOUR 3600
+#define DAY (24 * HOUR)
+
+static int add(long long int start, long long int end, int busy_status)
+{
+	cal_struct *cs;
+
+	cs = test_event_new("stored", "Etc/UTC", start, end);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_BUSY_STATUS, busy_status);
+	return test_event_insert(cs);
+}
+
+static cal_struct *new_allday(int y, int m, int d)
+{
+	cal_struct *cs;
+
+	cs = test_event_new("all day", "Etc/UTC", 0, 0);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_TYPE, CALS_TIME_LOCALTIME);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_YEAR, y);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_MONTH, m);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_MDAY, d);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_TYPE, CALS_TIME_LOCALTIME);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_YEAR, y);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_MONTH, m);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_MDAY, d);
+
+	return cs;
+}
+
+/* 09:30 ~ 10:00 for 5 days from 2024-01-02 but 2024-01-04 */
+static cal_struct *new_daily(void)
+{
+	const long long int s = D20240102T000000;
+	cal_struct *cs;
+
+	cs = test_event_new("candidate", "Etc/UTC", s + 9 * HOUR + 1800, s + 10 * HOUR);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_FREQ, CALS_FREQ_DAILY);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_INTERVAL, 1);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_RANGE_TYPE, CALS_RANGE_COUNT);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_COUNT, 5);
+	calendar_svc_struct_set_str(cs, CAL_VALUE_TXT_EXDATE, "20240104T093000Z");
+
+	return cs;
+}
+
+static int is(const struct cals_conflict *c, int event_id, long long int start, long long int end)
+{
+	if (c->event_id == event_id && c->start == start && c->end == end)
+		return 1;
+
+	printf("FAIL (%d, %lld ~ %lld) is not (%d, %lld ~ %lld)\n",
+			c->event_id, c->start, c->end, event_id, start, end);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	int cnt = 0;
+	int id;
+	int before, after, not_busy, excluded, covering, allday;
+	const long long int s = D20240102T000000;
+	const long long int e = D20240102T000000 + 7 * DAY;
+	cal_struct *cs;
+	cal_struct *stored = NULL;
+	struct cals_conflict *c = NULL;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	/* the first day, the candidate ends where the second one starts */
+	before = add(s + 9 * HOUR, s + 10 * HOUR, 2);
+	after = add(s + 10 * HOUR, s + 11 * HOUR, 2);
+	/* the third day is an exdate of the candidate */
+	excluded = add(s + 2 * DAY + 9 * HOUR + 2400, s + 2 * DAY + 9 * HOUR + 3000, 2);
+	not_busy = add(s + 3 * DAY + 9 * HOUR + 2400, s + 3 * DAY + 9 * HOUR + 3000, 0);
+	covering = add(s + 3 * DAY + 9 * HOUR, s + 3 * DAY + 12 * HOUR, 2);
+	allday = test_event_insert(new_allday(2024, 1, 3));
+
+	/* timed ones only, in the order of the start */
+	cs = new_daily();
+	ret = calendar_svc_event_find_conflicts(cs, s, e, &c, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(2 == cnt);
+	if (2 == cnt) {
+		CHECK(is(&c[0], before, s + 9 * HOUR, s + 10 * HOUR));
+		CHECK(is(&c[1], covering, s + 3 * DAY + 9 * HOUR, s + 3 * DAY + 12 * HOUR));
+	}
+	free(c);
+
+	/* instances of the candidate in the period only */
+	c = NULL;
+	ret = calendar_svc_event_find_conflicts(cs, s + DAY, e, &c, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(1 == cnt && covering == c[0].event_id);
+	free(c);
+
+	c = NULL;
+	ret = calendar_svc_event_find_conflicts(cs, s + 5 * DAY, e, &c, &cnt);
+	CHECK(CAL_SUCCESS == ret && 0 == cnt && NULL == c);
+
+	/* the stored candidate does not conflict with itself */
+	id = test_event_insert(cs);
+	ret = calendar_svc_get(CAL_STRUCT_SCHEDULE, id, NULL, &stored);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret) {
+		c = NULL;
+		ret = calendar_svc_event_find_conflicts(stored, s, e, &c, &cnt);
+		CHECK(CAL_SUCCESS == ret);
+		CHECK(2 == cnt && before == c[0].event_id && covering == c[1].event_id);
+		free(c);
+		calendar_svc_struct_free(&stored);
+	}
+
+	/* all-day ones with the all-day instances of the dates */
+	cs = new_allday(2024, 1, 3);
+	c = NULL;
+	ret = calendar_svc_event_find_conflicts(cs, s, e, &c, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(1 == cnt);
+	if (1 == cnt)
+		CHECK(is(&c[0], allday, 20240103, 20240103));
+	free(c);
+	calendar_svc_struct_free(&cs);
+
+	cs = new_allday(2024, 1, 4);
+	c = NULL;
+	ret = calendar_svc_event_find_conflicts(cs, s, e, &c, &cnt);
+	CHECK(CAL_SUCCESS == ret && 0 == cnt);
+	free(c);
+
+	ret = calendar_svc_event_find_conflicts(cs, e, s, &c, &cnt);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+	calendar_svc_struct_free(&cs);
+
+	CHECK(0 < after && 0 < excluded && 0 < not_busy);
+
+	return test_report();
+}
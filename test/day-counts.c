@@ -0,0 +1,224 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "test-db.h"
+
+/* instances on the days of a month, DST of New York begins on 2024-03-10 */
+
+#define NY "America/New_York"
+
+/* local times of New York */
+#define L20240229T220000 1709262000LL
+#define L20240301T020000 1709276400LL
+#define L20240309T230000 1710043200LL
+#define L20240309T233000 1710045000LL
+#define L20240310T003000 1710048600LL
+#define L20240310T233000 1710127800LL
+#define L20240312T120000 1710259200LL
+#define L20240314T120000 1710432000LL
+#define L20240316T120000 1710604800LL
+#define L20240320T230000 1710990000LL
+#define L20240321T000000 1710993600LL
+#define L20240331T230000 1711940400LL
+#define L20240401T010000 1711947600LL
+#define L20010306T230000 983937600LL
+
+static int add(int calendar_id, const char *tzid, long long int start, long long int end)
+{
+	cal_struct *cs;
+
+	cs = test_event_new("event", tzid, start, end);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_CALENDAR_ID, calendar_id);
+	return test_event_insert(cs);
+}
+
+/* dates are inclusive */
+static int add_allday(int sy, int sm, int sd, int ey, int em, int ed)
+{
+	cal_struct *cs;
+
+	cs = test_event_new("all day", NY, 0, 0);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_TYPE, CALS_TIME_LOCALTIME);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_YEAR, sy);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_MONTH, sm);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_MDAY, sd);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_TYPE, CALS_TIME_LOCALTIME);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_YEAR, ey);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_MONTH, em);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_MDAY, ed);
+	return test_event_insert(cs);
+}
+
+static void check_counts(const char *tzid, int calendar_id, int year, int month, const int *expected)
+{
+	int i;
+	int ret;
+	int counts[31];
+
+	ret = calendar_svc_event_get_day_counts(calendar_id, year, month, tzid, counts);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS != ret)
+		return;
+
+	for (i = 0; i < 31; i++) {
+		if (counts[i] != expected[i]) {
+			printf("FAIL %s %d-%02d-%02d of calendar(%d) has %d, not %d\n",
+					tzid, year, month, i + 1, calendar_id, counts[i], expected[i]);
+			fail = 1;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	int counts[31];
+	cal_struct *cs;
+	int ny_mar[31] = {0};
+	int ny_mar_1[31] = {0};
+	int utc_mar[31] = {0};
+	int ny_feb[31] = {0};
+	int ny_apr[31] = {0};
+	int expected[31];
+	sqlite3 *writer;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	/* across the start and the end of the month */
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240229T220000, L20240301T020000);
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240331T230000, L20240401T010000);
+	add_allday(2024, 2, 28, 2024, 3, 2);
+	add_allday(2024, 3, 31, 2024, 4, 2);
+
+	/* around the day DST begins */
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240309T233000, L20240310T003000);
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240310T003000, L20240310T003000);
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240310T233000, L20240310T233000 + 1800);
+
+	/* 23:00 of New York every day, an hour earlier in UTC after DST begins */
+	cs = test_event_new("daily", NY, L20240309T230000, L20240309T230000 + 1800);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_FREQ, CALS_FREQ_DAILY);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_INTERVAL, 1);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_RANGE_TYPE, CALS_RANGE_COUNT);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_COUNT, 3);
+	test_event_insert(cs);
+
+	/* several days, the end is not on the next day */
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240314T120000, L20240316T120000);
+	add(DEFAULT_EVENT_CALENDAR_ID, "Etc/UTC", L20240320T230000, L20240321T000000);
+	add_allday(2024, 3, 5, 2024, 3, 6);
+
+	add(DEFAULT_TODO_CALENDAR_ID, "Etc/UTC", L20240312T120000, L20240312T120000 + 3600);
+
+	/* 23:00 of New York on tuesdays for decades, walked from the month queried */
+	cs = test_event_new("weekly", NY, L20010306T230000, L20010306T230000 + 1800);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_CALENDAR_ID, DEFAULT_TODO_CALENDAR_ID);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_FREQ, CALS_FREQ_WEEKLY);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_INTERVAL, 1);
+	calendar_svc_struct_set_str(cs, CALS_VALUE_TXT_RRULE_BYDAY, "TU");
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_RANGE_TYPE, CALS_RANGE_NONE);
+	test_event_insert(cs);
+
+	ny_mar[0] = 2;
+	ny_mar[1] = 1;
+	ny_mar[4] = 1;
+	ny_mar[5] = 1;
+	ny_mar[8] = 2;
+	ny_mar[9] = 4;
+	ny_mar[10] = 1;
+	ny_mar[11] = 1;
+	ny_mar[13] = 1;
+	ny_mar[14] = 1;
+	ny_mar[15] = 1;
+	ny_mar[19] = 1;
+	ny_mar[30] = 2;
+
+	memcpy(ny_mar_1, ny_mar, sizeof(ny_mar));
+	ny_mar_1[11] = 0;
+
+	ny_mar[4]++;
+	ny_mar[11]++;
+	ny_mar[18] = 1;
+	ny_mar[25] = 1;
+	check_counts(NY, 0, 2024, 3, ny_mar);
+	check_counts(NY, DEFAULT_EVENT_CALENDAR_ID, 2024, 3, ny_mar_1);
+
+	/* the same instances on the days of UTC, all-day ones stay on their dates */
+	utc_mar[0] = 2;
+	utc_mar[1] = 1;
+	utc_mar[4] = 1;
+	utc_mar[5] = 1;
+	utc_mar[9] = 3;
+	utc_mar[10] = 2;
+	utc_mar[11] = 2;
+	utc_mar[13] = 1;
+	utc_mar[14] = 1;
+	utc_mar[15] = 1;
+	utc_mar[20] = 1;
+	utc_mar[30] = 1;
+	utc_mar[5]++;
+	utc_mar[12] = 1;
+	utc_mar[19] = 1;
+	utc_mar[26] = 1;
+	check_counts("Etc/UTC", 0, 2024, 3, utc_mar);
+
+	/* 29 days of the leap year, the rest are 0 */
+	ny_feb[27] = 1;
+	ny_feb[28] = 2;
+	ny_feb[5] = 1;
+	ny_feb[12] = 1;
+	ny_feb[19] = 1;
+	ny_feb[26] = 1;
+	check_counts(NY, 0, 2024, 2, ny_feb);
+
+	ny_apr[0] = 2;
+	ny_apr[1] = 2;
+	ny_apr[8] = 1;
+	ny_apr[15] = 1;
+	ny_apr[22] = 1;
+	ny_apr[29] = 1;
+	check_counts(NY, 0, 2024, 4, ny_apr);
+
+	/* a writer holding the lock leaves the read to the stored instances */
+	calendar_svc_set_lock_wait(1000, 1000, 10);
+	if (SQLITE_OK == sqlite3_open(CALS_DB_PATH, &writer)) {
+		memset(expected, 0, sizeof(expected));
+		CHECK(SQLITE_OK == sqlite3_exec(writer, "BEGIN IMMEDIATE", NULL, NULL, NULL));
+		check_counts(NY, DEFAULT_TODO_CALENDAR_ID, 2030, 3, expected);
+		sqlite3_exec(writer, "COMMIT", NULL, NULL, NULL);
+		sqlite3_close(writer);
+
+		expected[4] = 1;
+		expected[11] = 1;
+		expected[18] = 1;
+		expected[25] = 1;
+		check_counts(NY, DEFAULT_TODO_CALENDAR_ID, 2030, 3, expected);
+	}
+
+	ret = calendar_svc_event_get_day_counts(0, 2024, 13, NY, counts);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+	ret = calendar_svc_event_get_day_counts(0, 2024, 3, NY, NULL);
+	CHECK(CAL_ERR_ARG_NULL == ret);
+
+	return test_report();
+}
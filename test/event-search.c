@@ -0,0 +1,218 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include "test-db.h"
+
+/* event search and smartsearch through the full text index, or LIKE for non ASCII */
+
+#define D20240102T090000 1704186000LL
+
+static int add(const char *summary, const char *desc, const char **attendees)
+{
+	cal_struct *cs;
+	cal_value *att;
+	GList *l = NULL;
+
+	cs = test_event_new(summary, "Etc/UTC", D20240102T090000, D20240102T090000 + 3600);
+	calendar_svc_struct_set_str(cs, CAL_VALUE_TXT_DESCRIPTION, desc);
+
+	for (; attendees && *attendees; attendees++) {
+		att = calendar_svc_value_new(CAL_VALUE_LST_ATTENDEE_LIST);
+		calendar_svc_value_set_str(att, CAL_VALUE_TXT_ATTENDEE_DETAIL_NAME, *attendees);
+		l = g_list_append(l, att);
+	}
+	if (l)
+		calendar_svc_struct_store_list(cs, CAL_VALUE_LST_ATTENDEE_LIST, l);
+
+	return test_event_insert(cs);
+}
+
+/* ids of the iter in order, returns the count */
+static int collect(cal_iter *it, int *ids, int size)
+{
+	int n = 0;
+	cal_struct *cs;
+
+	while (CAL_SUCCESS == calendar_svc_iter_next(it)) {
+		cs = NULL;
+		if (CAL_SUCCESS != calendar_svc_iter_get_info(it, &cs))
+			break;
+		if (n < size)
+			ids[n] = calendar_svc_struct_get_int(cs, CAL_VALUE_INT_INDEX);
+		n++;
+		calendar_svc_struct_free(&cs);
+	}
+	calendar_svc_iter_remove(&it);
+
+	return n;
+}
+
+static int has(const int *ids, int n, int id)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (ids[i] == id)
+			return 1;
+	}
+	return 0;
+}
+
+static int search(int fields, const char *keyword, int *ids, int size)
+{
+	int ret;
+	cal_iter *it = NULL;
+
+	ret = calendar_svc_event_search(fields, keyword, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS != ret)
+		return -1;
+
+	return collect(it, ids, size);
+}
+
+int main(int argc, char **argv)
+{
+	int n;
+	int ret;
+	int ids[16];
+	int meeting, meetup, notes, guests, dentist, immediate, weekly, sale, long_text;
+	const char *two_mees[] = {"Mee Kim", "Mee Park", NULL};
+	const char *kims[] = {"김민수", NULL};
+	char *snippet = NULL;
+	cal_iter *it = NULL;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	meeting = add("team meeting", "weekly sync", NULL);
+	meetup = add("meetup", NULL, NULL);
+	notes = add("lunch", "meeting notes of the team", NULL);
+	guests = add("dinner", "restaurant", two_mees);
+	dentist = add("dentist", "clinic", NULL);
+	immediate = add("immediate", "call", NULL);
+
+	/* prefix of a word, once per event in spite of two matched attendees */
+	n = search(CALS_SEARCH_FIELD_SUMMARY | CALS_SEARCH_FIELD_DESCRIPTION
+			| CALS_SEARCH_FIELD_LOCATION | CALS_SEARCH_FIELD_ATTENDEE, "mee", ids, 16);
+	CHECK(4 == n);
+	CHECK(has(ids, n, meeting) && has(ids, n, meetup) && has(ids, n, notes) && has(ids, n, guests));
+	CHECK(!has(ids, n, dentist) && !has(ids, n, immediate));
+
+	/* summary matches are ranked over description and attendee ones */
+	CHECK(has(ids, 2, meeting) && has(ids, 2, meetup));
+
+	n = search(CALS_SEARCH_FIELD_ATTENDEE, "mee", ids, 16);
+	CHECK(1 == n && guests == ids[0]);
+
+	n = search(CALS_SEARCH_FIELD_SUMMARY, "mee", ids, 16);
+	CHECK(2 == n && has(ids, n, meeting) && has(ids, n, meetup));
+
+	n = search(CALS_SEARCH_FIELD_DESCRIPTION | CALS_SEARCH_FIELD_ATTENDEE, "MEE", ids, 16);
+	CHECK(2 == n && has(ids, n, notes) && has(ids, n, guests));
+
+	/* words are matched as a phrase */
+	n = search(CALS_SEARCH_FIELD_SUMMARY | CALS_SEARCH_FIELD_DESCRIPTION, "team mee", ids, 16);
+	CHECK(1 == n && meeting == ids[0]);
+
+	n = search(CALS_SEARCH_FIELD_SUMMARY, "eeting", ids, 16);
+	CHECK(0 == n);
+
+	ret = calendar_svc_event_search(CALS_SEARCH_FIELD_SUMMARY, " \"* ", &it);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+
+	/* smartsearch matches the summary only, paged by offset */
+	ret = calendar_svc_smartsearch_excl("mee", 0, 10, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret) {
+		n = collect(it, ids, 16);
+		CHECK(2 == n && has(ids, n, meeting) && has(ids, n, meetup));
+	}
+
+	ret = calendar_svc_smartsearch_excl("mee", 1, 10, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret)
+		CHECK(1 == collect(it, ids, 16));
+
+	ret = calendar_svc_search_get_snippet(notes, "mee", &snippet);
+	CHECK(CAL_SUCCESS == ret && snippet && strstr(snippet, "<b>meeting</b>"));
+	free(snippet);
+
+	ret = calendar_svc_search_get_snippet(dentist, "mee", &snippet);
+	CHECK(CAL_ERR_NO_DATA == ret);
+
+	/* non ASCII keywords are substrings, not the words of the index */
+	weekly = add("주간 회의록", "팀 회의", NULL);
+	sale = add("세일 50% 할인", "百货商店打折", kims);
+
+	n = search(CALS_SEARCH_FIELD_SUMMARY, "회의", ids, 16);
+	CHECK(1 == n && weekly == ids[0]);
+
+	n = search(CALS_SEARCH_FIELD_DESCRIPTION | CALS_SEARCH_FIELD_ATTENDEE, "민수", ids, 16);
+	CHECK(1 == n && sale == ids[0]);
+
+	n = search(CALS_SEARCH_FIELD_DESCRIPTION, "商店", ids, 16);
+	CHECK(1 == n && sale == ids[0]);
+
+	/* summary matches first */
+	n = search(CALS_SEARCH_FIELD_SUMMARY | CALS_SEARCH_FIELD_DESCRIPTION, "회", ids, 16);
+	CHECK(1 == n && weekly == ids[0]);
+
+	/* wildcards of LIKE are matched as they are */
+	n = search(CALS_SEARCH_FIELD_SUMMARY, "0% 할", ids, 16);
+	CHECK(1 == n && sale == ids[0]);
+	n = search(CALS_SEARCH_FIELD_SUMMARY, "_할", ids, 16);
+	CHECK(0 == n);
+
+	ret = calendar_svc_smartsearch_excl("할인", 0, 10, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret) {
+		n = collect(it, ids, 16);
+		CHECK(1 == n && sale == ids[0]);
+	}
+
+	ret = calendar_svc_search_get_snippet(weekly, "회의", &snippet);
+	CHECK(CAL_SUCCESS == ret && snippet && !strcmp(snippet, "주간 <b>회의</b>록"));
+	free(snippet);
+
+	ret = calendar_svc_search_get_snippet(sale, "商店", &snippet);
+	CHECK(CAL_SUCCESS == ret && snippet && !strcmp(snippet, "百货<b>商店</b>打折"));
+	free(snippet);
+
+	/* cut on character boundaries */
+	long_text = add("긴 설명", "가나다라마바사아자차카타파하 목표 가나다라마바사아자차카타파하", NULL);
+	ret = calendar_svc_search_get_snippet(long_text, "목표", &snippet);
+	CHECK(CAL_SUCCESS == ret && snippet
+			&& !strcmp(snippet, "...마바사아자차카타파하 <b>목표</b> 가나다라마바사아자차..."));
+	free(snippet);
+
+	ret = calendar_svc_search_get_snippet(dentist, "회의", &snippet);
+	CHECK(CAL_ERR_NO_DATA == ret);
+
+	/* the index follows updates and deletes */
+	calendar_svc_delete(CAL_STRUCT_SCHEDULE, meetup);
+	n = search(CALS_SEARCH_FIELD_SUMMARY, "mee", ids, 16);
+	CHECK(1 == n && meeting == ids[0]);
+
+	return test_report();
+}
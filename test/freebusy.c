@@ -0,0 +1,154 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include "test-db.h"
+
+/* busy time merged from the instances of the calendars */
+
+#define D20240102T000000 1704153600LL
+#define HOUR 3600
+#define DAY (24 * HOUR)
+
+static void add(int calendar_id, long long int start, long long int end,
+		int availability, int busy_status)
+{
+	cal_struct *cs;
+
+	cs = test_event_new("busy", "Etc/UTC", start, end);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_CALENDAR_ID, calendar_id);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_AVAILABILITY, availability);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_BUSY_STATUS, busy_status);
+	test_event_insert(cs);
+}
+
+/* all day of the date in the timezone */
+static void add_allday(const char *tzid, int y, int m, int d)
+{
+	cal_struct *cs;
+
+	cs = test_event_new("all day", tzid, 0, 0);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_TYPE, CALS_TIME_LOCALTIME);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_YEAR, y);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_MONTH, m);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_MDAY, d);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_TYPE, CALS_TIME_LOCALTIME);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_YEAR, y);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_MONTH, m);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_MDAY, d);
+	test_event_insert(cs);
+}
+
+static int is(const struct cals_freebusy *fb, long long int start, long long int end, int type)
+{
+	if (fb->start == start && fb->end == end && fb->type == type)
+		return 1;
+
+	printf("FAIL (%lld ~ %lld, %d) is not (%lld ~ %lld, %d)\n",
+			fb->start, fb->end, fb->type, start, end, type);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	int cnt = 0;
+	int ids[] = {DEFAULT_EVENT_CALENDAR_ID};
+	const long long int s = D20240102T000000;
+	const long long int e = D20240102T000000 + 2 * DAY;
+	struct cals_freebusy *fb = NULL;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	/* overlapped and adjacent ones are one interval of the strongest type */
+	add(DEFAULT_EVENT_CALENDAR_ID, s + 9 * HOUR, s + 10 * HOUR, EVENT_BUSY_FB, 2);
+	add(DEFAULT_EVENT_CALENDAR_ID, s + 9 * HOUR + 1800, s + 11 * HOUR, EVENT_BUSY_TENTATIVE_FB, 2);
+	add(DEFAULT_EVENT_CALENDAR_ID, s + 11 * HOUR, s + 12 * HOUR, EVENT_BUSY_UNAVAILABLE_FB, 2);
+
+	/* free, not busy and instants do not take time */
+	add(DEFAULT_EVENT_CALENDAR_ID, s + 13 * HOUR, s + 14 * HOUR, EVENT_FREE_FB, 2);
+	add(DEFAULT_EVENT_CALENDAR_ID, s + 13 * HOUR, s + 14 * HOUR, EVENT_BUSY_FB, 0);
+	add(DEFAULT_EVENT_CALENDAR_ID, s + 14 * HOUR, s + 14 * HOUR, EVENT_BUSY_FB, 2);
+
+	/* tentative ones stay tentative, in the other calendar */
+	add(DEFAULT_TODO_CALENDAR_ID, s + 16 * HOUR + 600, s + 16 * HOUR + 1200, EVENT_BUSY_TENTATIVE_FB, 2);
+
+	/* cut at the start of the period */
+	add(DEFAULT_EVENT_CALENDAR_ID, s - HOUR, s + HOUR, EVENT_BUSY_FB, 2);
+
+	/* 2024-01-04 of Seoul is from 2024-01-03T15:00Z, cut at the end of the period */
+	add_allday("Asia/Seoul", 2024, 1, 4);
+
+	ret = calendar_svc_get_freebusy(NULL, 0, s, e, 0, &fb, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(4 == cnt);
+	if (4 == cnt) {
+		CHECK(is(&fb[0], s, s + HOUR, EVENT_BUSY_FB));
+		CHECK(is(&fb[1], s + 9 * HOUR, s + 12 * HOUR, EVENT_BUSY_UNAVAILABLE_FB));
+		CHECK(is(&fb[2], s + 16 * HOUR + 600, s + 16 * HOUR + 1200, EVENT_BUSY_TENTATIVE_FB));
+		CHECK(is(&fb[3], s + DAY + 15 * HOUR, e, EVENT_BUSY_FB));
+	}
+	free(fb);
+
+	/* rounded out to the slots from the start of the period */
+	fb = NULL;
+	ret = calendar_svc_get_freebusy(NULL, 0, s, e, 900, &fb, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(4 == cnt);
+	if (4 == cnt) {
+		CHECK(is(&fb[1], s + 9 * HOUR, s + 12 * HOUR, EVENT_BUSY_UNAVAILABLE_FB));
+		CHECK(is(&fb[2], s + 16 * HOUR, s + 16 * HOUR + 1800, EVENT_BUSY_TENTATIVE_FB));
+	}
+	free(fb);
+
+	/* slots of rounded intervals may touch, so they are merged again */
+	fb = NULL;
+	ret = calendar_svc_get_freebusy(NULL, 0, s + 600, e, 7 * HOUR, &fb, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(2 == cnt);
+	if (2 == cnt) {
+		CHECK(is(&fb[0], s + 600, s + 600 + 21 * HOUR, EVENT_BUSY_UNAVAILABLE_FB));
+		CHECK(is(&fb[1], s + 600 + 35 * HOUR, e, EVENT_BUSY_FB));
+	}
+	free(fb);
+
+	/* the given calendars only */
+	fb = NULL;
+	ret = calendar_svc_get_freebusy(ids, 1, s, e, 0, &fb, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(3 == cnt);
+	if (3 == cnt)
+		CHECK(is(&fb[2], s + DAY + 15 * HOUR, e, EVENT_BUSY_FB));
+	free(fb);
+
+	fb = NULL;
+	ret = calendar_svc_get_freebusy(NULL, 0, s + 13 * HOUR, s + 16 * HOUR, 0, &fb, &cnt);
+	CHECK(CAL_SUCCESS == ret && 0 == cnt);
+	free(fb);
+
+	fb = NULL;
+	ret = calendar_svc_get_freebusy(NULL, 0, e, s, 0, &fb, &cnt);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+	ret = calendar_svc_get_freebusy(NULL, 0, s, e, -1, &fb, &cnt);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+
+	return test_report();
+}
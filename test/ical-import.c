@@ -1,38 +1,364 @@
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <calendar-svc-provider.h>
-
 /*
- * argv[1]: path
- * argv[2]: calendar_id
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
  */
-int main(int argc, char **argv)
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "test-db.h"
+#include "cals-typedef.h"
+#include "cals-ical.h"
+
+/* order and failures of the import parsed on worker threads */
+
+#define ICS_PATH "./test-import.ics"
+#define EXPORT_PATH "./test-export.ics"
+#define EXPORT_DIR "./test-export.d"
+#define EVENTS 600
+#define CHUNK 50
+
+static void write_ics(int events, int closed)
 {
-	int ret, calendar_id;
-	char *path;
+	int i;
+	FILE *fp;
 
-	if (argc < 3) {
-		printf("argument needs 3\n");
-		return -1;
+	fp = fopen(ICS_PATH, "w");
+	if (NULL == fp)
+		return;
+
+	fputs("BEGIN:VCALENDAR\r\nVERSION:2.0\r\n"
+			"BEGIN:VTIMEZONE\r\nTZID:Asia/Seoul\r\n"
+			"BEGIN:STANDARD\r\nTZOFFSETTO:+0900\r\nEND:STANDARD\r\n"
+			"END:VTIMEZONE\r\n", fp);
+	for (i = 0; i < events; i++) {
+		fprintf(fp, "BEGIN:VEVENT\r\n"
+				"DTSTART:20240102T%02d0000Z\r\nDTEND:20240102T%02d3000Z\r\n"
+				"SUMMARY:event %d\r\n", i % 24, i % 24, i);
+		/* uneven work for the workers */
+		if (0 == i % 7)
+			fputs("BEGIN:VALARM\r\nACTION:DISPLAY\r\nTRIGGER:-PT15M\r\nEND:VALARM\r\n", fp);
+		fputs("END:VEVENT\r\n", fp);
 	}
+	if (closed)
+		fputs("END:VCALENDAR\r\n", fp);
+	else
+		fputs("BEGIN:VEVENT\r\nSUMMARY:not closed\r\n", fp);
+	fclose(fp);
+}
 
-	if (argv[1] == NULL || argv[2] == NULL) {
-		printf("Invalid argument\n");
-		return -1;
+struct order {
+	int cnt;
+	int stop_at;
+};
+
+static int order_cb(cal_struct *cs, void *data)
+{
+	char buf[32];
+	char *summary;
+	struct order *o = data;
+
+	snprintf(buf, sizeof(buf), "event %d", o->cnt);
+	summary = calendar_svc_struct_get_str(cs, CAL_VALUE_TXT_SUMMARY);
+	CHECK(summary && !strcmp(summary, buf));
+	calendar_svc_struct_free(&cs);
+	o->cnt++;
+
+	if (o->stop_at && o->stop_at == o->cnt)
+		return CAL_ERR_FAIL;
+	return CAL_SUCCESS;
+}
+
+static void progress_cb(int imported, void *user_data)
+{
+	int *last = user_data;
+
+	CHECK(*last < imported);
+	*last = imported;
+}
+
+/* events are stored with the index in the order of the file */
+static int count_stored(void)
+{
+	int i;
+	int ret;
+	char buf[32];
+	char *summary;
+	cal_struct *cs;
+
+	for (i = 0; i < EVENTS; i++) {
+		cs = NULL;
+		ret = calendar_svc_get(CAL_STRUCT_SCHEDULE, i + 1, NULL, &cs);
+		if (CAL_SUCCESS != ret)
+			break;
+
+		snprintf(buf, sizeof(buf), "event %d", i);
+		summary = calendar_svc_struct_get_str(cs, CAL_VALUE_TXT_SUMMARY);
+		CHECK(summary && !strcmp(summary, buf));
+		calendar_svc_struct_free(&cs);
+	}
+	return i;
+}
+
+static void test_import(int workers)
+{
+	int ret;
+	int last = 0;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		fail = 1;
+		return;
 	}
 
-	path = argv[1];
-	calendar_id = atoi(argv[2]);
+	ret = calendar_svc_set_import_workers(workers);
+	CHECK(CAL_SUCCESS == ret);
 
-	calendar_svc_connect();
+	write_ics(EVENTS, 1);
+	ret = calendar_svc_calendar_import_with_progress(ICS_PATH, DEFAULT_EVENT_CALENDAR_ID,
+			CHUNK, progress_cb, &last);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(EVENTS == last);
+	CHECK(EVENTS == count_stored());
 
-	ret = calendar_svc_calendar_import(path, calendar_id);
-	if (ret != CAL_SUCCESS) {
-		printf("Failed to import path(%s) to calendar id(%d)\n", path, calendar_id);
+	/* the chunks before the broken component are kept */
+	test_db_close();
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		fail = 1;
+		return;
+	}
+	last = 0;
+	write_ics(EVENTS - 10, 0);
+	ret = calendar_svc_calendar_import_with_progress(ICS_PATH, DEFAULT_EVENT_CALENDAR_ID,
+			CHUNK, progress_cb, &last);
+	CHECK(CAL_ERR_VOBJECT_FAILED == ret);
+	CHECK((EVENTS - 10) / CHUNK * CHUNK == last);
+	CHECK(last == count_stored());
+
+	test_db_close();
+}
+
+/* files of the directory named name or name.XXXXXX */
+static int count_files(const char *name)
+{
+	int n = 0;
+	DIR *dir;
+	struct dirent *ent;
+
+	dir = opendir(".");
+	if (NULL == dir)
 		return -1;
+	while ((ent = readdir(dir))) {
+		if (!strncmp(ent->d_name, name + 2, strlen(name + 2)))
+			n++;
 	}
+	closedir(dir);
+
+	return n;
+}
+
+/* the file is replaced only when all schedules are written */
+static void test_export(void)
+{
+	int ret;
+	long size = 0;
+	FILE *fp;
+	char line[32];
+	struct rlimit limit;
+	struct rlimit small;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		fail = 1;
+		return;
+	}
+
+	write_ics(CHUNK, 1);
+	ret = calendar_svc_calendar_import(ICS_PATH, DEFAULT_EVENT_CALENDAR_ID);
+	CHECK(CAL_SUCCESS == ret);
+
+	ret = calendar_svc_calendar_export(DEFAULT_EVENT_CALENDAR_ID, EXPORT_PATH);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(1 == count_files(EXPORT_PATH));
+
+	fp = fopen(EXPORT_PATH, "r");
+	CHECK(NULL != fp);
+	if (fp) {
+		CHECK(fgets(line, sizeof(line), fp) && !strcmp(line, "BEGIN:VCALENDAR\r\n"));
+		fseek(fp, -(long)strlen("END:VCALENDAR\r\n"), SEEK_END);
+		CHECK(fgets(line, sizeof(line), fp) && !strcmp(line, "END:VCALENDAR\r\n"));
+		fseek(fp, 0, SEEK_END);
+		size = ftell(fp);
+		fclose(fp);
+
+		/* nothing to write, the last export is kept */
+		ret = calendar_svc_calendar_export(DEFAULT_TODO_CALENDAR_ID, EXPORT_PATH);
+		CHECK(CAL_ERR_FAIL == ret);
+		fp = fopen(EXPORT_PATH, "r");
+		CHECK(NULL != fp);
+		if (fp) {
+			fseek(fp, 0, SEEK_END);
+			CHECK(size == ftell(fp));
+			fclose(fp);
+		}
+	}
+
+	/* a failed write keeps the last export, the temporary file is removed */
+	if (0 == getrlimit(RLIMIT_FSIZE, &limit)) {
+		signal(SIGXFSZ, SIG_IGN);
+		small = limit;
+		small.rlim_cur = size / 2;
+		setrlimit(RLIMIT_FSIZE, &small);
+		ret = calendar_svc_calendar_export(DEFAULT_EVENT_CALENDAR_ID, EXPORT_PATH);
+		setrlimit(RLIMIT_FSIZE, &limit);
+		signal(SIGXFSZ, SIG_DFL);
+
+		CHECK(CAL_SUCCESS != ret);
+		CHECK(1 == count_files(EXPORT_PATH));
+		fp = fopen(EXPORT_PATH, "r");
+		CHECK(NULL != fp);
+		if (fp) {
+			fseek(fp, 0, SEEK_END);
+			CHECK(size == ftell(fp));
+			fclose(fp);
+		}
+	}
+
+	/* path can not be replaced, the temporary file is removed */
+	mkdir(EXPORT_DIR, 0700);
+	ret = calendar_svc_calendar_export(DEFAULT_EVENT_CALENDAR_ID, EXPORT_DIR);
+	CHECK(CAL_ERR_IO_ERR == ret);
+	CHECK(1 == count_files(EXPORT_DIR));
+	rmdir(EXPORT_DIR);
+
+	unlink(EXPORT_PATH);
+	test_db_close();
+}
+
+/* a component ends after the lines continued by folding or soft line breaks */
+static const char *folded_ics =
+	"BEGIN:VCALENDAR\r\n"
+	"VERSION:1.0\r\n"
+	"BEGIN:VEVENT\r\n"
+	"DTSTART:20240102T090000Z\r\n"
+	"DTEND:20240102T100000Z\r\n"
+	"SUMMARY:event 0\r\n"
+	"DESCRIPTION;ENCODING=QUOTED-PRINTABLE:soft=\r\n"
+	"BEGIN:VALARM=0D=0Abreak\r\n"
+	"END:VEVENT\r\n"
+	"BEGIN:VEVENT\r\n"
+	"DTSTART:20240103T090000Z\r\n"
+	"DTEND:20240103T100000Z\r\n"
+	"SUMMARY:event 1\r\n"
+	"DESCRIPTION;ENCODING=QUOTED-PRINTABLE:=\r\n"
+	"END:VEVENT\r\n"
+	"END:VEVENT\r\n"
+	"BEG\r\n"
+	" IN:VEVENT\r\n"
+	"DTSTART:20240104T090000Z\r\n"
+	"DTEND:20240104T100000Z\r\n"
+	"SUMMARY:event 2\r\n"
+	"BEGIN:VALARM\r\n"
+	"TRIGGER:-PT15M\r\n"
+	"END:VAL\r\n"
+	" ARM\r\n"
+	"END:VEV\r\n"
+	" ENT\r\n"
+	"END:VCALENDAR\r\n";
+
+static int unfold_cb(cal_struct *cs, void *data)
+{
+	char *description;
+	struct order *o = data;
+
+	description = calendar_svc_struct_get_str(cs, CAL_VALUE_TXT_DESCRIPTION);
+	if (0 == o->cnt)
+		CHECK(description && !strcmp(description, "softBEGIN:VALARM\nbreak"));
+	else if (1 == o->cnt)
+		CHECK(description && !strcmp(description, "END:VEVENT"));
+
+	return order_cb(cs, data);
+}
+
+static void test_unfold(void)
+{
+	int ret;
+	FILE *fp;
+	struct order o = {0};
+
+	fp = fopen(ICS_PATH, "w");
+	if (NULL == fp)
+		return;
+	fputs(folded_ics, fp);
+	fclose(fp);
+
+	ret = cals_ical_parse_file_parallel(ICS_PATH, 2, unfold_cb, &o);
+	CHECK(CAL_SUCCESS == ret && 3 == o.cnt);
+
+	memset(&o, 0, sizeof(o));
+	ret = cals_ical_parse_file(ICS_PATH, unfold_cb, &o);
+	CHECK(CAL_SUCCESS == ret && 3 == o.cnt);
+
+	unlink(ICS_PATH);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	struct order o = {0};
+
+	CHECK(CAL_ERR_ARG_INVALID == calendar_svc_set_import_workers(-1));
+
+	test_import(1);
+	test_import(4);
+	test_export();
+	test_unfold();
+
+	/* records come in the order of the file from any number of workers */
+	write_ics(EVENTS, 1);
+	ret = cals_ical_parse_file_parallel(ICS_PATH, 3, order_cb, &o);
+	CHECK(CAL_SUCCESS == ret && EVENTS == o.cnt);
+
+	memset(&o, 0, sizeof(o));
+	ret = cals_ical_parse_file_parallel(ICS_PATH, 16, order_cb, &o);
+	CHECK(CAL_SUCCESS == ret && EVENTS == o.cnt);
+
+	/* an error of cb stops the import, the parsed rest are dropped */
+	memset(&o, 0, sizeof(o));
+	o.stop_at = 100;
+	ret = cals_ical_parse_file_parallel(ICS_PATH, 4, order_cb, &o);
+	CHECK(CAL_ERR_FAIL == ret && 100 == o.cnt);
+
+	/* same records as the sequential reader before a broken component */
+	write_ics(EVENTS - 10, 0);
+	memset(&o, 0, sizeof(o));
+	ret = cals_ical_parse_file_parallel(ICS_PATH, 4, order_cb, &o);
+	CHECK(CAL_ERR_VOBJECT_FAILED == ret && EVENTS - 10 == o.cnt);
+
+	memset(&o, 0, sizeof(o));
+	ret = cals_ical_parse_file(ICS_PATH, order_cb, &o);
+	CHECK(CAL_ERR_VOBJECT_FAILED == ret && EVENTS - 10 == o.cnt);
+
+	unlink(ICS_PATH);
 
-	calendar_svc_close();
-	return 0;
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
 }
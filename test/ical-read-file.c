@@ -0,0 +1,210 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include "test-db.h"
+#include "cals-typedef.h"
+#include "cals-ical.h"
+
+/* the streaming reader of cals_ical_parse_file() */
+
+#define ICS_PATH "./test-read.ics"
+#define MANY 2000
+
+static const char *ics =
+	"BEGIN:VCALENDAR\r\n"
+	"VERSION:2.0\r\n"
+	"BEGIN:VTIMEZONE\r\n"
+	"TZID:Asia/Seoul\r\n"
+	"BEGIN:STANDARD\r\n"
+	"SUMMARY:not an event\r\n"
+	"END:STANDARD\r\n"
+	"END:VTIMEZONE\r\n"
+	"\r\n"
+	"BEGIN:VEVENT\r\n"
+	"DTSTART:20240102T090000Z\r\n"
+	"DTEND:20240102T100000Z\r\n"
+	"SUMMARY:a folded\r\n"
+	"  long\r\n"
+	"\t summary\r\n"
+	"LOCATION:room 3\r\n"
+	"END:VEVENT\r\n"
+	"BEGIN:VEVENT\n"
+	"DTSTART:20240103T090000Z\n"
+	"DTEND:20240103T100000Z\n"
+	"SUMMARY:with alarm\n"
+	"BEGIN:VALARM\n"
+	"ACTION:DISPLAY\n"
+	"TRIGGER:-PT15M\n"
+	"END:VALARM\n"
+	"END:VEVENT\n"
+	"BEGIN:VTODO\r\n"
+	"SUMMARY:a todo\r\n"
+	"DUE:20240104T090000Z\r\n"
+	"END:VTODO\r\n"
+	"END:VCALENDAR";
+
+struct records {
+	int cnt;
+	int stop_at;
+	cal_struct *cs[8];
+};
+
+static int keep_cb(cal_struct *cs, void *data)
+{
+	struct records *r = data;
+
+	if (r->cnt < 8)
+		r->cs[r->cnt] = cs;
+	else
+		calendar_svc_struct_free(&cs);
+	r->cnt++;
+
+	if (r->stop_at && r->stop_at == r->cnt)
+		return CAL_ERR_FAIL;
+	return CAL_SUCCESS;
+}
+
+static void records_free(struct records *r)
+{
+	int i;
+
+	for (i = 0; i < r->cnt && i < 8; i++)
+		calendar_svc_struct_free(&r->cs[i]);
+	memset(r, 0, sizeof(struct records));
+}
+
+static int summary_is(cal_struct *cs, const char *summary)
+{
+	char *s;
+
+	s = calendar_svc_struct_get_str(cs, CAL_VALUE_TXT_SUMMARY);
+	return s && !strcmp(s, summary);
+}
+
+static void write_file(const char *text)
+{
+	FILE *fp;
+
+	fp = fopen(ICS_PATH, "w");
+	if (NULL == fp)
+		return;
+	fputs(text, fp);
+	fclose(fp);
+}
+
+static int many_cb(cal_struct *cs, void *data)
+{
+	int *cnt = data;
+	char buf[32];
+
+	snprintf(buf, sizeof(buf), "event %d", *cnt);
+	CHECK(summary_is(cs, buf));
+	calendar_svc_struct_free(&cs);
+	(*cnt)++;
+
+	return CAL_SUCCESS;
+}
+
+static void test_many(void)
+{
+	int i;
+	int ret;
+	int cnt = 0;
+	FILE *fp;
+
+	/* spans many pages, which are released while reading */
+	fp = fopen(ICS_PATH, "w");
+	if (NULL == fp)
+		return;
+	fputs("BEGIN:VCALENDAR\r\nVERSION:2.0\r\n", fp);
+	for (i = 0; i < MANY; i++) {
+		fprintf(fp, "BEGIN:VEVENT\r\nDTSTART:20240102T090000Z\r\n"
+				"DTEND:20240102T100000Z\r\nDESCRIPTION:%0*d\r\n"
+				"SUMMARY:event %d\r\nEND:VEVENT\r\n", i % 300 + 1, 0, i);
+	}
+	fputs("END:VCALENDAR\r\n", fp);
+	fclose(fp);
+
+	ret = cals_ical_parse_file(ICS_PATH, many_cb, &cnt);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(MANY == cnt);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	GList *alarms = NULL;
+	struct records r = {0};
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	write_file(ics);
+	ret = cals_ical_parse_file(ICS_PATH, keep_cb, &r);
+	CHECK(CAL_SUCCESS == ret);
+	CHECK(3 == r.cnt);
+	if (3 == r.cnt) {
+		/* folded lines are joined without the leading white space */
+		CHECK(summary_is(r.cs[0], "a folded long summary"));
+		CHECK(!strcmp("room 3", calendar_svc_struct_get_str(r.cs[0], CAL_VALUE_TXT_LOCATION)));
+		CHECK(CALS_SCH_TYPE_EVENT == ((cal_sch_full_t *)r.cs[0]->user_data)->cal_type);
+
+		CHECK(summary_is(r.cs[1], "with alarm"));
+		calendar_svc_struct_get_list(r.cs[1], CAL_VALUE_LST_ALARM, &alarms);
+		CHECK(1 == g_list_length(alarms));
+
+		CHECK(summary_is(r.cs[2], "a todo"));
+		CHECK(CALS_SCH_TYPE_TODO == ((cal_sch_full_t *)r.cs[2]->user_data)->cal_type);
+	}
+
+	records_free(&r);
+
+	/* cb stops the parsing */
+	r.stop_at = 2;
+	ret = cals_ical_parse_file(ICS_PATH, keep_cb, &r);
+	CHECK(CAL_ERR_FAIL == ret);
+	CHECK(2 == r.cnt);
+	records_free(&r);
+
+	/* the records before a component which is not closed are given */
+	write_file("BEGIN:VCALENDAR\r\nVERSION:2.0\r\n"
+			"BEGIN:VEVENT\r\nSUMMARY:closed\r\nEND:VEVENT\r\n"
+			"BEGIN:VEVENT\r\nSUMMARY:open\r\n");
+	ret = cals_ical_parse_file(ICS_PATH, keep_cb, &r);
+	CHECK(CAL_ERR_VOBJECT_FAILED == ret);
+	CHECK(1 == r.cnt && summary_is(r.cs[0], "closed"));
+	records_free(&r);
+
+	write_file("");
+	ret = cals_ical_parse_file(ICS_PATH, keep_cb, &r);
+	CHECK(CAL_SUCCESS == ret && 0 == r.cnt);
+
+	ret = cals_ical_parse_file("./no-such.ics", keep_cb, &r);
+	CHECK(CAL_ERR_IO_ERR == ret);
+
+	test_many();
+
+	unlink(ICS_PATH);
+
+	return test_report();
+}
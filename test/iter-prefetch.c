@@ -0,0 +1,148 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include "test-db.h"
+
+/* rows of schedule iterators read by pages and copied to the row record */
+
+/* exported with the API but not declared in the headers */
+int calendar_svc_iter_get_main_info(cal_iter *iter, cal_struct **row_event);
+
+#define D20240102T090000 1704186000LL
+#define EVENTS 150
+
+static int add(int i)
+{
+	char buf[32];
+	cal_struct *cs;
+	cal_value *v;
+	GList *l = NULL;
+
+	snprintf(buf, sizeof(buf), "event %d", i);
+	cs = test_event_new(buf, "Etc/UTC", D20240102T090000 + i * 60, D20240102T090000 + i * 60 + 30);
+
+	v = calendar_svc_value_new(CAL_VALUE_LST_ATTENDEE_LIST);
+	snprintf(buf, sizeof(buf), "attendee %d", i);
+	calendar_svc_value_set_str(v, CAL_VALUE_TXT_ATTENDEE_DETAIL_NAME, buf);
+	calendar_svc_value_set_str(v, CAL_VALUE_TXT_ATTENDEE_UID, "uid");
+	l = g_list_append(l, v);
+	calendar_svc_struct_store_list(cs, CAL_VALUE_LST_ATTENDEE_LIST, l);
+
+	if (0 == i % 2) {
+		l = NULL;
+		v = calendar_svc_value_new(CAL_VALUE_LST_ALARM);
+		calendar_svc_value_set_int(v, CAL_VALUE_INT_ALARMS_TICK, 10);
+		calendar_svc_value_set_int(v, CAL_VALUE_INT_ALARMS_TICK_UNIT, CAL_SCH_TIME_UNIT_MIN);
+		calendar_svc_value_set_str(v, CAL_VALUE_TXT_ALARMS_DESCRIPTION, "alarm");
+		l = g_list_append(l, v);
+		calendar_svc_struct_store_list(cs, CAL_VALUE_LST_ALARM, l);
+	}
+
+	return test_event_insert(cs);
+}
+
+/* the row record has the fields of the i-th event only */
+static int is_event(cal_struct *cs, int i)
+{
+	char buf[32];
+	char *s;
+	GList *l = NULL;
+
+	snprintf(buf, sizeof(buf), "event %d", i);
+	s = calendar_svc_struct_get_str(cs, CAL_VALUE_TXT_SUMMARY);
+	if (NULL == s || strcmp(s, buf))
+		return 0;
+
+	calendar_svc_struct_get_list(cs, CAL_VALUE_LST_ATTENDEE_LIST, &l);
+	if (1 != g_list_length(l))
+		return 0;
+	snprintf(buf, sizeof(buf), "attendee %d", i);
+	s = calendar_svc_value_get_str(l->data, CAL_VALUE_TXT_ATTENDEE_DETAIL_NAME);
+	if (NULL == s || strcmp(s, buf))
+		return 0;
+
+	l = NULL;
+	calendar_svc_struct_get_list(cs, CAL_VALUE_LST_ALARM, &l);
+	if ((0 == i % 2) != (1 == g_list_length(l)))
+		return 0;
+
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+	int n;
+	int ret;
+	cal_iter *it = NULL;
+	cal_struct *row = NULL;
+	cal_struct *other = NULL;
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	for (i = 0; i < EVENTS; i++)
+		add(i);
+
+	/* the same row can be got again, into the same or another record */
+	ret = calendar_svc_get_all(0, 0, CAL_STRUCT_SCHEDULE, &it);
+	CHECK(CAL_SUCCESS == ret);
+	n = 0;
+	while (CAL_SUCCESS == ret && CAL_SUCCESS == calendar_svc_iter_next(it)) {
+		ret = calendar_svc_iter_get_info(it, &row);
+		CHECK(CAL_SUCCESS == ret && is_event(row, n));
+		ret = calendar_svc_iter_get_info(it, &row);
+		CHECK(CAL_SUCCESS == ret && is_event(row, n));
+		ret = calendar_svc_iter_get_main_info(it, &other);
+		CHECK(CAL_SUCCESS == ret && is_event(other, n));
+		calendar_svc_struct_free(&other);
+		n++;
+	}
+	CHECK(EVENTS == n);
+	calendar_svc_iter_remove(&it);
+
+	/* the fields the record had are replaced, not appended to */
+	calendar_svc_struct_set_str(row, CAL_VALUE_TXT_DESCRIPTION, "not of the row");
+	ret = calendar_svc_get_all(0, 0, CAL_STRUCT_SCHEDULE, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret) {
+		CHECK(CAL_SUCCESS == calendar_svc_iter_next(it));
+		CHECK(CAL_SUCCESS == calendar_svc_iter_get_info(it, &row));
+		CHECK(is_event(row, 0));
+		CHECK(NULL == calendar_svc_struct_get_str(row, CAL_VALUE_TXT_DESCRIPTION));
+		calendar_svc_iter_remove(&it);
+	}
+	calendar_svc_struct_free(&row);
+
+	/* the struct of a row got is kept after the iterator is removed */
+	ret = calendar_svc_get_all(0, 0, CAL_STRUCT_SCHEDULE, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret) {
+		CHECK(CAL_SUCCESS == calendar_svc_iter_get_info(it, &row));
+		calendar_svc_iter_remove(&it);
+		CHECK(is_event(row, 0));
+		calendar_svc_struct_free(&row);
+	}
+
+	return test_report();
+}
@@ -0,0 +1,185 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "test-db.h"
+#include "cals-typedef.h"
+#include "cals-utils.h"
+
+/* keyset pages of get_all and the normal period list */
+
+#define D20240102T090000 1704186000LL
+#define HOUR 3600
+#define EVENTS 23
+#define ROWS 64
+
+static void test_token(void)
+{
+	int i;
+	int id;
+	long long int key;
+	char *token;
+	const long long int keys[] = {0, 1704186000LL, -86400LL, LLONG_MIN, LLONG_MAX};
+	const char *bad[] = {"", "12", "12:", ":3", "abc", "12:x", "12:3x",
+		"12:3 ", "12;3", "12:-1", "0x1:2"};
+
+	for (i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+		token = cals_page_token_new(keys[i], i * 1000);
+		CHECK(NULL != token);
+		if (NULL == token)
+			continue;
+		CHECK(CAL_SUCCESS == cals_page_token_parse(token, &key, &id));
+		CHECK(keys[i] == key && i * 1000 == id);
+		free(token);
+	}
+
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+		if (CAL_ERR_ARG_INVALID != cals_page_token_parse(bad[i], &key, &id)) {
+			printf("FAIL token(%s) is taken\n", bad[i]);
+			fail = 1;
+		}
+	}
+	CHECK(CAL_ERR_ARG_NULL == cals_page_token_parse(NULL, &key, &id));
+}
+
+/* walks the pages, returns the number of rows or -1 */
+static int walk(int period, int limit, int *ids, long long int *starts)
+{
+	int n = 0;
+	int ret;
+	int pages = 0;
+	char *token = NULL;
+	char *next;
+	cal_iter *it;
+	cal_struct *cs;
+
+	do {
+		it = NULL;
+		if (period)
+			ret = calendar_svc_event_get_normal_list_by_period_page(-1, CALS_LIST_PERIOD_NORMAL_BASIC,
+					D20240102T090000, D20240102T090000 + 100 * HOUR, token, limit, &it);
+		else
+			ret = calendar_svc_get_all_page(0, 0, CAL_STRUCT_SCHEDULE, token, limit, &it);
+		free(token);
+		CHECK(CAL_SUCCESS == ret);
+		if (CAL_SUCCESS != ret)
+			return -1;
+
+		while (CAL_SUCCESS == calendar_svc_iter_next(it)) {
+			cs = NULL;
+			if (CAL_SUCCESS != calendar_svc_iter_get_info(it, &cs))
+				break;
+			if (n < ROWS) {
+				ids[n] = calendar_svc_struct_get_int(cs, CAL_VALUE_INT_INDEX);
+				if (period)
+					starts[n] = calendar_svc_struct_get_lli(cs, CALS_VALUE_LLI_DTSTART_UTIME);
+			}
+			n++;
+			calendar_svc_struct_free(&cs);
+		}
+
+		next = NULL;
+		ret = calendar_svc_iter_get_page_token(it, &next);
+		CHECK(CAL_SUCCESS == ret);
+		calendar_svc_iter_remove(&it);
+		token = next;
+		pages++;
+	} while (token && pages <= ROWS);
+
+	CHECK(NULL == token);
+	return n;
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+	int n;
+	int ret;
+	int ids[ROWS];
+	long long int starts[ROWS];
+	cal_struct *cs;
+	cal_iter *it = NULL;
+
+	test_token();
+
+	if (test_db_open()) {
+		printf("FAIL test_db_open()\n");
+		return 1;
+	}
+
+	/* three events a start, so a page may end in the middle of a start */
+	for (i = 0; i < EVENTS - 1; i++) {
+		cs = test_event_new("event", "Etc/UTC", D20240102T090000 + i / 3 * HOUR,
+				D20240102T090000 + i / 3 * HOUR + 1800);
+		test_event_insert(cs);
+	}
+	/* instances of a recurring event are keyed by their start */
+	cs = test_event_new("daily", "Etc/UTC", D20240102T090000 + HOUR, D20240102T090000 + 2 * HOUR);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_FREQ, CALS_FREQ_DAILY);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_INTERVAL, 1);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_RANGE_TYPE, CALS_RANGE_COUNT);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_RRULE_COUNT, 3);
+	test_event_insert(cs);
+
+	for (i = 1; i <= 7; i++) {
+		n = walk(0, i, ids, starts);
+		CHECK(EVENTS == n);
+		for (n = 0; n < EVENTS; n++) {
+			if (ids[n] != n + 1) {
+				printf("FAIL get_all limit(%d) row(%d) is id(%d)\n", i, n, ids[n]);
+				fail = 1;
+				break;
+			}
+		}
+	}
+
+	/* ordered by start and id, 22 events and 2 more instances in the period */
+	for (i = 1; i <= 7; i++) {
+		n = walk(1, i, ids, starts);
+		CHECK(EVENTS + 2 == n);
+		for (n = 1; n < EVENTS + 2; n++) {
+			if (starts[n] < starts[n - 1] || (starts[n] == starts[n - 1] && ids[n] <= ids[n - 1])) {
+				printf("FAIL period limit(%d) row(%d) is not after row(%d)\n", i, n, n - 1);
+				fail = 1;
+				break;
+			}
+		}
+	}
+
+	/* malformed tokens are refused */
+	ret = calendar_svc_get_all_page(0, 0, CAL_STRUCT_SCHEDULE, "12:3x", 5, &it);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+	ret = calendar_svc_event_get_normal_list_by_period_page(-1, CALS_LIST_PERIOD_NORMAL_BASIC,
+			D20240102T090000, D20240102T090000 + HOUR, "abc", 5, &it);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+	ret = calendar_svc_get_all_page(0, 0, CAL_STRUCT_SCHEDULE, NULL, 0, &it);
+	CHECK(CAL_ERR_ARG_INVALID == ret);
+
+	/* a list which is not paged has no token */
+	ret = calendar_svc_get_all(0, 0, CAL_STRUCT_SCHEDULE, &it);
+	CHECK(CAL_SUCCESS == ret);
+	if (CAL_SUCCESS == ret) {
+		char *token = NULL;
+		CHECK(CAL_ERR_ARG_INVALID == calendar_svc_iter_get_page_token(it, &token));
+		calendar_svc_iter_remove(&it);
+	}
+
+	return test_report();
+}
@@ -0,0 +1,222 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <stdio.h>
+#include <unicode/ucal.h>
+#include <unicode/ustring.h>
+#include <calendar-svc-provider.h>
+#include "../src/cals-recur.h"
+
+/*
+ * The civil date kernel against ICU: the k-th occurrence is dtstart added
+ * k * interval by one ucal_add(), which keeps the wall clock time over DST.
+ * Monthly and yearly rules on mday 29 ~ 31 skip the months missing the day,
+ * those are checked against the dates listed below.
+ */
+
+#define STEPS 500
+
+static UCalendarDateFields fields[] = {
+	[CALS_FREQ_YEARLY] = UCAL_YEAR,
+	[CALS_FREQ_MONTHLY] = UCAL_MONTH,
+	[CALS_FREQ_WEEKLY] = UCAL_WEEK_OF_YEAR,
+	[CALS_FREQ_DAILY] = UCAL_DATE,
+};
+
+static UCalendar *open_cal(const char *tzid)
+{
+	UChar utzid[64];
+	UErrorCode status = U_ZERO_ERROR;
+
+	u_uastrcpy(utzid, tzid);
+	return ucal_open(utzid, -1, "en_US", UCAL_TRADITIONAL, &status);
+}
+
+/* seconds of the local time of the kernel in the tzid */
+static long long int get_utime(UCalendar *cal, struct cals_recur *rc)
+{
+	UErrorCode status = U_ZERO_ERROR;
+
+	ucal_setDateTime(cal, rc->year, rc->month - 1, rc->day,
+			rc->sec / 3600, rc->sec / 60 % 60, rc->sec % 60, &status);
+	return ucal_getMillis(cal, &status) / 1000;
+}
+
+static int check(const char *tzid, int freq, int interval,
+		int year, int month, int mday, int sec)
+{
+	int i;
+	int y, m, d;
+	UDate start;
+	UCalendar *cal;
+	UCalendar *tcal;
+	UErrorCode status = U_ZERO_ERROR;
+	struct cals_recur rc;
+	long long int ut;
+	long long int rt;
+
+	cal = open_cal(tzid);
+	tcal = open_cal(tzid);
+	ucal_setDateTime(cal, year, month - 1, mday,
+			sec / 3600, sec / 60 % 60, sec % 60, &status);
+	start = ucal_getMillis(cal, &status);
+
+	cals_recur_init(&rc, freq, interval, year, month, mday, sec);
+
+	for (i = 0; i < STEPS; i++) {
+		ucal_setMillis(cal, start, &status);
+		ucal_add(cal, fields[freq], i * interval, &status);
+		y = ucal_get(cal, UCAL_YEAR, &status);
+		m = ucal_get(cal, UCAL_MONTH, &status) + 1;
+		d = ucal_get(cal, UCAL_DATE, &status);
+		ut = ucal_getMillis(cal, &status) / 1000;
+		rt = get_utime(tcal, &rc);
+
+		if (U_FAILURE(status) || y != rc.year || m != rc.month || d != rc.day || ut != rt) {
+			printf("FAIL %s freq(%d) interval(%d) from %04d/%02d/%02d step(%d): "
+					"icu %04d/%02d/%02d(%lld) kernel %04d/%02d/%02d(%lld)\n",
+					tzid, freq, interval, year, month, mday, i,
+					y, m, d, ut, rc.year, rc.month, rc.day, rt);
+			ucal_close(cal);
+			ucal_close(tcal);
+			return -1;
+		}
+		cals_recur_next(&rc);
+	}
+	ucal_close(cal);
+	ucal_close(tcal);
+
+	return 0;
+}
+
+/* occurrences of rules on days some months do not have */
+static const struct {
+	int freq;
+	int interval;
+	int dates[9][3];
+} skips[] = {
+	{CALS_FREQ_MONTHLY, 1, {{2012, 1, 31}, {2012, 3, 31}, {2012, 5, 31}, {2012, 7, 31}, {2012, 8, 31},
+		{2012, 10, 31}, {2012, 12, 31}, {2013, 1, 31}, {2013, 3, 31}}},
+	{CALS_FREQ_MONTHLY, 3, {{2012, 1, 31}, {2012, 5, 31}, {2012, 8, 31}, {2012, 12, 31}, {2013, 3, 31},
+		{2013, 7, 31}, {2013, 10, 31}, {2014, 1, 31}, {2014, 5, 31}}},
+	{CALS_FREQ_MONTHLY, 1, {{2011, 1, 29}, {2011, 3, 29}, {2011, 4, 29}, {2011, 5, 29}, {2011, 6, 29},
+		{2011, 7, 29}, {2011, 8, 29}, {2011, 9, 29}, {2011, 10, 29}}},
+	{CALS_FREQ_MONTHLY, 12, {{2012, 2, 29}, {2013, 3, 29}, {2014, 3, 29}, {2015, 3, 29}, {2016, 3, 29},
+		{2017, 3, 29}, {2018, 3, 29}, {2019, 3, 29}, {2020, 3, 29}}},
+	{CALS_FREQ_YEARLY, 1, {{1896, 2, 29}, {1904, 2, 29}, {1908, 2, 29}, {1912, 2, 29}, {1916, 2, 29},
+		{1920, 2, 29}, {1924, 2, 29}, {1928, 2, 29}, {1932, 2, 29}}},
+	{CALS_FREQ_YEARLY, 3, {{2012, 2, 29}, {2024, 2, 29}, {2036, 2, 29}, {2048, 2, 29}, {2060, 2, 29},
+		{2072, 2, 29}, {2084, 2, 29}, {2096, 2, 29}, {2108, 2, 29}}},
+	{CALS_FREQ_YEARLY, 2, {{2000, 2, 29}, {2004, 2, 29}, {2008, 2, 29}, {2012, 2, 29}, {2016, 2, 29},
+		{2020, 2, 29}, {2024, 2, 29}, {2028, 2, 29}, {2032, 2, 29}}},
+	{CALS_FREQ_YEARLY, 5, {{2000, 2, 29}, {2020, 2, 29}, {2040, 2, 29}, {2060, 2, 29}, {2080, 2, 29},
+		{2120, 2, 29}, {2140, 2, 29}, {2160, 2, 29}, {2180, 2, 29}}},
+	{CALS_FREQ_YEARLY, 1, {{2011, 12, 31}, {2012, 12, 31}, {2013, 12, 31}, {2014, 12, 31}, {2015, 12, 31},
+		{2016, 12, 31}, {2017, 12, 31}, {2018, 12, 31}, {2019, 12, 31}}},
+};
+
+static int check_skips(void)
+{
+	int i, j;
+	int fail = 0;
+	struct cals_recur rc;
+
+	for (i = 0; i < sizeof(skips) / sizeof(skips[0]); i++) {
+		cals_recur_init(&rc, skips[i].freq, skips[i].interval,
+				skips[i].dates[0][0], skips[i].dates[0][1], skips[i].dates[0][2], 0);
+		for (j = 0; j < 9; j++) {
+			if (rc.year != skips[i].dates[j][0] || rc.month != skips[i].dates[j][1]
+					|| rc.day != skips[i].dates[j][2]) {
+				printf("FAIL freq(%d) interval(%d) from %04d/%02d/%02d step(%d): "
+						"%04d/%02d/%02d is not %04d/%02d/%02d\n",
+						skips[i].freq, skips[i].interval,
+						skips[i].dates[0][0], skips[i].dates[0][1], skips[i].dates[0][2], j,
+						rc.year, rc.month, rc.day,
+						skips[i].dates[j][0], skips[i].dates[j][1], skips[i].dates[j][2]);
+				fail = -1;
+				break;
+			}
+			cals_recur_next(&rc);
+		}
+	}
+	return fail;
+}
+
+/* skipping lands where stepping reaches first on or after the day */
+static int check_skip(int freq, int interval, int year, int month, int mday, int days)
+{
+	struct cals_recur rc;
+	struct cals_recur skipped;
+
+	cals_recur_init(&rc, freq, interval, year, month, mday, 0);
+	skipped = rc;
+
+	while (cals_recur_days_from_civil(rc.year, rc.month, rc.day) < days)
+		cals_recur_next(&rc);
+	cals_recur_skip(&skipped, days);
+
+	if (rc.year != skipped.year || rc.month != skipped.month || rc.day != skipped.day) {
+		printf("FAIL skip freq(%d) interval(%d) from %04d/%02d/%02d to day(%d): "
+				"step %04d/%02d/%02d skip %04d/%02d/%02d\n",
+				freq, interval, year, month, mday, days,
+				rc.year, rc.month, rc.day, skipped.year, skipped.month, skipped.day);
+		return -1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int i, j, k;
+	int days;
+	int fail = 0;
+	int freqs[] = {CALS_FREQ_YEARLY, CALS_FREQ_MONTHLY, CALS_FREQ_WEEKLY, CALS_FREQ_DAILY};
+	int dates[][3] = {
+		{2012, 1, 31}, {2012, 2, 29}, {2011, 3, 30}, {2012, 12, 31},
+		{1999, 10, 31}, {2000, 2, 29}, {2037, 6, 15}, {1970, 1, 1},
+		{2011, 3, 27}, {2024, 3, 10}, {2012, 10, 28}, {1600, 2, 28},
+	};
+	const char *tzids[] = {"Etc/Unknown", "Asia/Seoul", "America/New_York", "Europe/London"};
+
+	for (i = 0; i < sizeof(freqs) / sizeof(int); i++) {
+		for (j = 0; j < sizeof(dates) / sizeof(dates[0]); j++) {
+			/* those are in skips[] */
+			if (28 < dates[j][2] && (CALS_FREQ_YEARLY == freqs[i] || CALS_FREQ_MONTHLY == freqs[i]))
+				continue;
+			fail |= check(tzids[j % 4], freqs[i], 1, dates[j][0], dates[j][1], dates[j][2], 9 * 3600);
+			fail |= check(tzids[j % 4], freqs[i], 3, dates[j][0], dates[j][1], dates[j][2], 0);
+			fail |= check(tzids[(j + 1) % 4], freqs[i], 2, dates[j][0], dates[j][1], dates[j][2], 12 * 3600 + 1800);
+		}
+	}
+	fail |= check_skips();
+
+	for (i = 0; i < sizeof(freqs) / sizeof(int); i++) {
+		for (j = 0; j < sizeof(dates) / sizeof(dates[0]); j++) {
+			for (k = 0; k < 40; k++) {
+				days = cals_recur_days_from_civil(dates[j][0], dates[j][1], dates[j][2])
+					+ k * k * 97 - 300;
+				fail |= check_skip(freqs[i], 1, dates[j][0], dates[j][1], dates[j][2], days);
+				fail |= check_skip(freqs[i], 3, dates[j][0], dates[j][1], dates[j][2], days);
+				fail |= check_skip(freqs[i], 7, dates[j][0], dates[j][1], dates[j][2], days);
+			}
+		}
+	}
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
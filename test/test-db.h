@@ -0,0 +1,117 @@
+/*
+ * Calendar Service
+ *
+ * Copyright (c) 2000 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __TEST_DB_H__
+#define __TEST_DB_H__
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include <calendar-svc-provider.h>
+#include "cals-db-info.h"
+#include "schema.h"
+
+/*
+ * Helpers of the tests built with the library sources,
+ * CALS_DB_PATH is a scratch DB made from schema.sql for each run.
+ */
+
+static int fail;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			fail = 1; \
+		} \
+	} while (0)
+
+static inline int test_db_open(void)
+{
+	int ret;
+	sqlite3 *db;
+	char *errmsg = NULL;
+
+	unlink(CALS_DB_PATH);
+
+	ret = sqlite3_open(CALS_DB_PATH, &db);
+	if (SQLITE_OK != ret) {
+		printf("FAIL sqlite3_open(%s) %d\n", CALS_DB_PATH, ret);
+		return -1;
+	}
+	ret = sqlite3_exec(db, schema_query, NULL, NULL, &errmsg);
+	if (SQLITE_OK != ret) {
+		printf("FAIL schema %s\n", errmsg);
+		sqlite3_free(errmsg);
+		sqlite3_close(db);
+		return -1;
+	}
+	sqlite3_close(db);
+
+	return calendar_svc_connect();
+}
+
+static inline void test_db_close(void)
+{
+	calendar_svc_close();
+	unlink(CALS_DB_PATH);
+}
+
+static inline int test_report(void)
+{
+	test_db_close();
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
+
+static inline cal_struct *test_event_new(const char *summary, const char *tzid,
+		long long int start, long long int end)
+{
+	cal_struct *cs;
+
+	cs = calendar_svc_struct_new(CAL_STRUCT_SCHEDULE);
+	if (NULL == cs)
+		return NULL;
+
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_ACCOUNT_ID, -1);
+	calendar_svc_struct_set_int(cs, CAL_VALUE_INT_CALENDAR_ID, DEFAULT_EVENT_CALENDAR_ID);
+	calendar_svc_struct_set_str(cs, CAL_VALUE_TXT_SUMMARY, summary);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTSTART_TYPE, CALS_TIME_UTIME);
+	calendar_svc_struct_set_lli(cs, CALS_VALUE_LLI_DTSTART_UTIME, start);
+	calendar_svc_struct_set_str(cs, CALS_VALUE_TXT_DTSTART_TZID, tzid);
+	calendar_svc_struct_set_int(cs, CALS_VALUE_INT_DTEND_TYPE, CALS_TIME_UTIME);
+	calendar_svc_struct_set_lli(cs, CALS_VALUE_LLI_DTEND_UTIME, end);
+	calendar_svc_struct_set_str(cs, CALS_VALUE_TXT_DTEND_TZID, tzid);
+
+	return cs;
+}
+
+/* returns the index of the inserted event */
+static inline int test_event_insert(cal_struct *cs)
+{
+	int ret;
+
+	ret = calendar_svc_insert(cs);
+	calendar_svc_struct_free(&cs);
+	if (ret < 0)
+		printf("FAIL calendar_svc_insert() %d\n", ret);
+
+	return ret;
+}
+
+#endif /* __TEST_DB_H__ */